@@ -0,0 +1,415 @@
+/*
+* Bench
+*
+* A small benchmark harness in the style of Google Benchmark, so that the suite
+* builds with nothing but a C++11 compiler and CMake.
+*
+* Each benchmark is a function of a Bench_state registered under a name whose
+* parts are separated by slashes: container, operation, then its parameters,
+* e.g. "hash_table/quadratic/member_hit/zipf/65536". The function does its
+* setup, then times its loop with keep_running():
+*
+*   bench_register("stack/linked/push_pop/1024", [](Bench_state &state) {
+*       Linked_stack<int> stack;
+*       while (state.keep_running()) {
+*           ...
+*       }
+*       state.set_items_processed(state.iterations() * 1024);
+*   });
+*
+* The runner calls the function with a growing iteration count until the
+* timed loop lasts at least the minimum time, as Google Benchmark does, and
+* reports the time per iteration and the items processed per second.
+*
+* ---------------------------------------------------------
+*                   Bench_state:
+*
+* bool keep_running()
+*   Starts the timer on the first call and returns true until the requested
+*   number of iterations have run, then stops the timer.
+*
+* void pause_timing()
+* void resume_timing()
+*   Exclude work inside the loop (such as refilling a container) from the time.
+*
+* long long iterations() const
+*   The number of iterations the runner asked for.
+*
+* void set_items_processed(long long)
+*   The number of elements handled by all of the iterations together.
+*
+* void set_counter(std::string const &, double)
+*   Reports a further measurement, such as a rank error or a latency percentile,
+*   like Google Benchmark's state.counters. It is printed after the benchmark's
+*   line and written as a field of its JSON entry.
+*
+* ---------------------------------------------------------
+*                   Functions:
+*
+* void bench_register(std::string const &, std::function<void(Bench_state &)>)
+*   Adds a benchmark to the suite.
+*
+* template <typename T> void bench_do_not_optimize(T const &)
+*   Keeps the compiler from discarding the computation of a value.
+*
+* bool bench_parse_options(int, char **)
+*   Parses the options, printing the usage and returning false if one is not
+*   recognized. It is called before the benchmarks are registered, since the
+*   concurrent ones register one benchmark per thread count:
+*     --filter=<text>     Only run benchmarks whose name contains the text
+*     --min_time=<secs>   The shortest timed loop to accept (default 0.1)
+*     --json=<path>       Also write the results, in Google Benchmark's JSON format
+*     --list              Print the names of the benchmarks and exit
+*     --threads=<n,...>   The thread counts of the concurrent benchmarks
+*     --max_threads=<n>   Use the powers of two up to n, and n itself, as the thread
+*                         counts (default: the number of hardware threads, at least
+*                         2 and at most 64)
+*
+* std::vector<int> const &bench_thread_counts()
+*   The thread counts selected by the options.
+*
+* int bench_run_selected()
+*   Runs the benchmarks selected by the options and returns the exit status.
+*/
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class Bench_state {
+private:
+	typedef std::chrono::steady_clock clock;
+
+	long long requested;
+	long long completed;
+	long long items;
+	bool running;
+	clock::time_point started;
+	double elapsed;
+	std::vector<std::pair<std::string, double> > user_counters;
+
+public:
+	explicit Bench_state(long long n) :
+	requested(n),
+	completed(0),
+	items(0),
+	running(false),
+	elapsed(0.0) {
+		// Empty constructor
+	}
+
+	bool keep_running() {
+		if (completed == 0 && !running) {
+			resume_timing();
+		}
+
+		if (completed == requested) {
+			pause_timing();
+			return false;
+		}
+
+		++completed;
+		return true;
+	}
+
+	void pause_timing() {
+		if (running) {
+			elapsed += std::chrono::duration<double>(clock::now() - started).count();
+			running = false;
+		}
+	}
+
+	void resume_timing() {
+		if (!running) {
+			started = clock::now();
+			running = true;
+		}
+	}
+
+	long long iterations() const {
+		return requested;
+	}
+
+	void set_items_processed(long long n) {
+		items = n;
+	}
+
+	long long items_processed() const {
+		return items;
+	}
+
+	void set_counter(std::string const &name, double value) {
+		for (std::size_t i = 0; i < user_counters.size(); ++i) {
+			if (user_counters[i].first == name) {
+				user_counters[i].second = value;
+				return;
+			}
+		}
+		user_counters.push_back(std::make_pair(name, value));
+	}
+
+	std::vector<std::pair<std::string, double> > const &counters() const {
+		return user_counters;
+	}
+
+	double seconds() const {
+		return elapsed;
+	}
+};
+
+struct Bench_entry {
+	std::string name;
+	std::function<void(Bench_state &)> function;
+};
+
+struct Bench_result {
+	std::string name;
+	long long iterations;
+	double seconds_per_iteration;
+	double items_per_second;
+	std::vector<std::pair<std::string, double> > counters;
+};
+
+inline std::vector<Bench_entry> &bench_registry() {
+	static std::vector<Bench_entry> entries;
+	return entries;
+}
+
+inline void bench_register(std::string const &name, std::function<void(Bench_state &)> function) {
+	Bench_entry entry = { name, function };
+	bench_registry().push_back(entry);
+}
+
+inline char const *volatile &bench_sink() {
+	static char const *volatile sink = nullptr;
+	return sink;
+}
+
+template <typename T>
+inline void bench_do_not_optimize(T const &value) {
+	// Publishing the value's address through a volatile pointer forces it to be computed
+	bench_sink() = reinterpret_cast<char const *>(&value);
+}
+
+struct Bench_options {
+	std::string filter;
+	std::string json;
+	double min_time;
+	bool list;
+	std::vector<int> thread_counts;
+};
+
+inline Bench_options &bench_options() {
+	static Bench_options options = { "", "", 0.1, false, std::vector<int>() };
+	return options;
+}
+
+inline std::vector<int> const &bench_thread_counts() {
+	return bench_options().thread_counts;
+}
+
+// Returns 1, 2, 4, ... up to n, followed by n itself if it is not a power of two
+inline std::vector<int> bench_powers_of_two(int n) {
+	std::vector<int> counts;
+	for (int t = 1; t <= n; t *= 2) counts.push_back(t);
+	if (counts.back() != n) counts.push_back(n);
+	return counts;
+}
+
+// Parses a comma separated list of positive counts; returns false if it is malformed
+inline bool bench_parse_counts(std::string const &text, std::vector<int> &counts) {
+	counts.clear();
+	std::size_t start = 0;
+
+	while (start <= text.size()) {
+		std::size_t end = text.find(',', start);
+		if (end == std::string::npos) end = text.size();
+
+		int n = std::atoi(text.substr(start, end - start).c_str());
+		if (n < 1) return false;
+		counts.push_back(n);
+
+		start = end + 1;
+	}
+
+	return !counts.empty();
+}
+
+inline bool bench_parse_options(int argc, char **argv) {
+	Bench_options &options = bench_options();
+	int max_threads = std::min(std::max(static_cast<int>(std::thread::hardware_concurrency()), 2), 64);
+	bool valid = true;
+
+	options.thread_counts.clear();
+
+	for (int i = 1; i < argc && valid; ++i) {
+		std::string arg(argv[i]);
+
+		if (arg.compare(0, 9, "--filter=") == 0) {
+			options.filter = arg.substr(9);
+		}
+		else if (arg.compare(0, 11, "--min_time=") == 0) {
+			options.min_time = std::atof(arg.c_str() + 11);
+		}
+		else if (arg.compare(0, 7, "--json=") == 0) {
+			options.json = arg.substr(7);
+		}
+		else if (arg == "--list") {
+			options.list = true;
+		}
+		else if (arg.compare(0, 10, "--threads=") == 0) {
+			valid = bench_parse_counts(arg.substr(10), options.thread_counts);
+		}
+		else if (arg.compare(0, 14, "--max_threads=") == 0) {
+			max_threads = std::atoi(arg.c_str() + 14);
+			valid = max_threads >= 1;
+		}
+		else {
+			valid = false;
+		}
+	}
+
+	if (!valid) {
+		std::cerr << "usage: " << argv[0] << " [--filter=<text>] [--min_time=<secs>] [--json=<path>] [--list]"
+			<< " [--threads=<n,...> | --max_threads=<n>]" << std::endl;
+		return false;
+	}
+
+	if (options.thread_counts.empty())
+		options.thread_counts = bench_powers_of_two(max_threads);
+
+	return true;
+}
+
+// Runs a benchmark with more and more iterations until the timed loop lasts min_time
+inline Bench_result bench_run(Bench_entry const &entry, double min_time) {
+	long long n = 1;
+
+	while (true) {
+		Bench_state state(n);
+		entry.function(state);
+
+		double t = state.seconds();
+		bool last = t >= min_time || n >= 1000000000LL;
+
+		if (last) {
+			Bench_result result;
+			result.name = entry.name;
+			result.iterations = n;
+			result.seconds_per_iteration = t / n;
+			result.items_per_second = (t > 0.0) ? state.items_processed() / t : 0.0;
+			result.counters = state.counters();
+			return result;
+		}
+
+		// Aim for 1.4 times the minimum, growing by at most a factor of 10 per attempt
+		double scale = (t > 0.0) ? std::min(1.4 * min_time / t, 10.0) : 10.0;
+		n = std::max(n + 1, static_cast<long long>(n * scale));
+	}
+}
+
+// Writes the results in the same layout as Google Benchmark's --benchmark_format=json
+inline void bench_write_json(std::ostream &out, std::vector<Bench_result> const &results) {
+	char date[64];
+	std::time_t now = std::time(nullptr);
+	std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+	out << "{\n  \"context\": {\n";
+	out << "    \"date\": \"" << date << "\",\n";
+	out << "    \"num_cpus\": " << std::thread::hardware_concurrency() << ",\n";
+#ifdef NDEBUG
+	out << "    \"library_build_type\": \"release\"\n";
+#else
+	out << "    \"library_build_type\": \"debug\"\n";
+#endif
+	out << "  },\n  \"benchmarks\": [\n";
+
+	for (std::size_t i = 0; i < results.size(); ++i) {
+		char line[512];
+		std::snprintf(line, sizeof(line),
+			"    {\"name\": \"%s\", \"run_type\": \"iteration\", \"iterations\": %lld, "
+			"\"real_time\": %.3f, \"cpu_time\": %.3f, \"time_unit\": \"ns\", \"items_per_second\": %.1f",
+			results[i].name.c_str(), results[i].iterations,
+			results[i].seconds_per_iteration * 1e9, results[i].seconds_per_iteration * 1e9,
+			results[i].items_per_second);
+		out << line;
+
+		// User counters are further fields of the entry, as in Google Benchmark
+		for (std::size_t j = 0; j < results[i].counters.size(); ++j) {
+			std::snprintf(line, sizeof(line), ", \"%s\": %.6g", results[i].counters[j].first.c_str(), results[i].counters[j].second);
+			out << line;
+		}
+
+		out << "}" << ((i + 1 < results.size()) ? "," : "") << "\n";
+	}
+
+	out << "  ]\n}\n";
+}
+
+inline int bench_run_selected() {
+	std::string const &filter = bench_options().filter;
+	std::string const &json = bench_options().json;
+	double min_time = bench_options().min_time;
+	bool list = bench_options().list;
+
+	std::vector<Bench_result> results;
+	char line[256];
+
+	if (!list) {
+		std::snprintf(line, sizeof(line), "%-60s %15s %15s %12s", "Benchmark", "Time (ns)", "Items/s", "Iterations");
+		std::cout << line << std::endl;
+	}
+
+	for (std::size_t i = 0; i < bench_registry().size(); ++i) {
+		Bench_entry const &entry = bench_registry()[i];
+
+		if (!filter.empty() && entry.name.find(filter) == std::string::npos)
+			continue;
+
+		if (list) {
+			std::cout << entry.name << std::endl;
+			continue;
+		}
+
+		Bench_result result = bench_run(entry, min_time);
+		results.push_back(result);
+
+		std::snprintf(line, sizeof(line), "%-60s %15.1f %15.4g %12lld",
+			result.name.c_str(), result.seconds_per_iteration * 1e9, result.items_per_second, result.iterations);
+		std::cout << line;
+
+		for (std::size_t j = 0; j < result.counters.size(); ++j) {
+			std::snprintf(line, sizeof(line), " %s=%.4g", result.counters[j].first.c_str(), result.counters[j].second);
+			std::cout << line;
+		}
+		std::cout << std::endl;
+	}
+
+	if (!json.empty()) {
+		std::ofstream out(json.c_str());
+
+		if (!out) {
+			std::cerr << "cannot write " << json << std::endl;
+			return 1;
+		}
+
+		bench_write_json(out, results);
+	}
+
+	return 0;
+}
+
+#endif
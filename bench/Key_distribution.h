@@ -0,0 +1,126 @@
+/*
+* Key_distribution
+*
+* The key sequences the benchmarks draw from, so that every container is
+* measured on the same inputs:
+*
+*   SEQUENTIAL  0, 1, 2, ...: the best case for caches and branch predictors
+*   UNIFORM     Independent keys drawn uniformly from a range much larger than n
+*   ZIPF        Keys drawn from n distinct values with a Zipf(0.99) frequency:
+*               a few hot keys make up most of the sequence, as in real caches
+*               and symbol tables
+*
+* Every sequence comes from a fixed seed, so runs are comparable.
+*
+* ---------------------------------------------------------
+*                   Functions:
+*
+* char const *key_distribution_name(key_distribution_t)
+*   Returns "sequential", "uniform" or "zipf", as used in benchmark names.
+*
+* std::vector<int> make_keys(key_distribution_t, int n, int count, unsigned seed = 1)
+*   Returns count keys following the distribution. Every key is one of the n
+*   values make_distinct_keys(distribution, n) returns; the seed only changes
+*   the order they are drawn in.
+*
+* std::vector<int> make_distinct_keys(key_distribution_t, int n, unsigned seed = 1)
+*   Returns n distinct keys. Sequential keys are in order; uniform keys are
+*   spread over a large range; Zipf keys are the n values make_keys draws from,
+*   in a scrambled order.
+*/
+
+#ifndef KEY_DISTRIBUTION_H
+#define KEY_DISTRIBUTION_H
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+enum key_distribution_t { SEQUENTIAL, UNIFORM, ZIPF };
+
+inline char const *key_distribution_name(key_distribution_t distribution) {
+	switch (distribution) {
+		case SEQUENTIAL: return "sequential";
+		case UNIFORM:    return "uniform";
+		default:         return "zipf";
+	}
+}
+
+// Maps a rank to a key, so that the hottest Zipf keys are not also the smallest
+inline int key_scramble(int rank) {
+	return static_cast<int>((static_cast<unsigned>(rank) * 2654435761u) >> 1);
+}
+
+inline std::vector<int> make_distinct_keys(key_distribution_t distribution, int n, unsigned seed = 1) {
+	std::vector<int> keys;
+	keys.reserve(n);
+
+	if (distribution == SEQUENTIAL) {
+		for (int i = 0; i < n; ++i) {
+			keys.push_back(i);
+		}
+	}
+	else if (distribution == UNIFORM) {
+		std::mt19937 rng(seed);
+		std::uniform_int_distribution<int> range(0, 0x3fffffff);
+		std::unordered_set<int> seen;
+
+		while (static_cast<int>(keys.size()) < n) {
+			int key = range(rng);
+			if (seen.insert(key).second) {
+				keys.push_back(key);
+			}
+		}
+	}
+	else {
+		for (int i = 0; i < n; ++i) {
+			keys.push_back(key_scramble(i));
+		}
+		std::shuffle(keys.begin(), keys.end(), std::mt19937(seed));
+	}
+
+	return keys;
+}
+
+inline std::vector<int> make_keys(key_distribution_t distribution, int n, int count, unsigned seed = 1) {
+	std::vector<int> keys;
+	keys.reserve(count);
+	std::mt19937 rng(seed);
+
+	if (distribution == SEQUENTIAL) {
+		for (int i = 0; i < count; ++i) {
+			keys.push_back(i % n);
+		}
+	}
+	else if (distribution == UNIFORM) {
+		std::uniform_int_distribution<int> range(0, n - 1);
+		std::vector<int> values = make_distinct_keys(UNIFORM, n);
+
+		for (int i = 0; i < count; ++i) {
+			keys.push_back(values[range(rng)]);
+		}
+	}
+	else {
+		// Sample ranks by inverting the cumulative Zipf distribution
+		std::vector<double> cumulative(n);
+		double total = 0.0;
+
+		for (int i = 0; i < n; ++i) {
+			total += 1.0 / std::pow(i + 1.0, 0.99);
+			cumulative[i] = total;
+		}
+
+		std::uniform_real_distribution<double> unit(0.0, total);
+
+		for (int i = 0; i < count; ++i) {
+			int rank = static_cast<int>(std::lower_bound(cumulative.begin(), cumulative.end(), unit(rng)) - cumulative.begin());
+			keys.push_back(key_scramble(std::min(rank, n - 1)));
+		}
+	}
+
+	return keys;
+}
+
+#endif
@@ -0,0 +1,606 @@
+/*
+* Benchmarks of the concurrent containers.
+*
+*   deque/chase_lev/steal/<threads>      The owner pushes n tasks, popping one back
+*                                        after every fourth push, while threads - 1
+*                                        thieves steal from the front
+*   deque/locked_list/steal/<threads>    The same, on a Double_sentinel_list behind a mutex
+*   queue/spsc/transfer/2                One producer enqueues n timestamps into a ring
+*                                        of 1024 and one consumer dequeues them. Besides
+*                                        the rate, every eighth element's time in the
+*                                        queue is sampled and reported as p50_ns and p99_ns
+*   queue/mpmc/transfer/<threads>        The same with threads / 2 producers and the rest
+*                                        consumers, for two threads or more
+*   queue/locked_dynamic/transfer/<threads>
+*                                        The same, on a Dynamic_queue behind a mutex. It is
+*                                        not bounded, so the producers may run far ahead
+*                                        and the times in the queue grow with n
+*   thread_pool/submit/<threads>         Submit n empty tasks, then wait
+*   thread_pool/parallel_for/<threads>   A parallel loop over n indices
+*   thread_pool/latency/<threads>        The round trip of one submit and get
+*
+*   stack/treiber/push_pop/<threads>     The threads between them n times push an element
+*                                        and pop one
+*   stack/elimination/push_pop/<threads> The same on an Elimination_stack, where a push and
+*                                        a pop may cancel out without touching the top
+*   stack/locked_linked/push_pop/<threads>
+*                                        The same, on a Linked_stack behind a mutex
+*
+*   priority_queue/multi_queue/hold/<threads>
+*                                        With 2^16 keys queued, the threads together
+*                                        n times pop a key and push it back increased
+*                                        by a random amount
+*   priority_queue/locked_leftist/hold/<threads>
+*                                        The same, on one Leftist_heap behind a mutex
+*   priority_queue/multi_queue/rank_error/<threads>
+*                                        The threads drain a Multi_queue of 2^16 distinct
+*                                        keys. Each pop is stamped from a shared counter and
+*                                        the pops are replayed in stamp order, untimed, to
+*                                        report the mean and largest rank of the keys popped
+*                                        among those left (0 is the true minimum). A thread
+*                                        preempted between its pop and its stamp inflates
+*                                        the error, so read it only with threads <= cores
+*
+* Each is registered once for every thread count given by --threads or
+* --max_threads (see Bench.h). The threads are started inside the timed loop,
+* so n is kept large enough that starting them is a small part of the time.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "ece250.h"
+#include "Exception.h"
+#include "Chase_lev_deque.h"
+#include "Double_sentinel_list.h"
+#include "Dynamic_queue.h"
+#include "Elimination_stack.h"
+#include "Leftist_heap.h"
+#include "Linked_stack.h"
+#include "Multi_queue.h"
+#include "Mpmc_queue.h"
+#include "Spsc_queue.h"
+#include "Thread_pool.h"
+#include "Treiber_stack.h"
+#include "Bench.h"
+
+namespace {
+
+int const TASKS = 1 << 16;
+int const QUEUED_KEYS = 1 << 16;
+int const RING_CAPACITY = 1024;
+
+// Returns the part of n that the i-th of the given number of threads takes on
+int share(int n, int parts, int i) {
+	return n / parts + ((i < n % parts) ? 1 : 0);
+}
+
+long long now_ns() {
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()
+	).count();
+}
+
+// The same interface as Chase_lev_deque, with every operation under one lock
+class Locked_list_deque {
+private:
+	std::mutex lock;
+	Double_sentinel_list<int> list;
+
+public:
+	void push_back(int obj) {
+		std::lock_guard<std::mutex> guard(lock);
+		list.push_back(obj);
+	}
+
+	bool pop_back(int &obj) {
+		std::lock_guard<std::mutex> guard(lock);
+
+		if (list.empty()) {
+			return false;
+		}
+
+		obj = list.pop_back();
+		return true;
+	}
+
+	bool pop_front(int &obj) {
+		std::lock_guard<std::mutex> guard(lock);
+
+		if (list.empty()) {
+			return false;
+		}
+
+		obj = list.pop_front();
+		return true;
+	}
+};
+
+// The enqueue and try_dequeue of Mpmc_queue, on one Dynamic_queue under one lock.
+// The queue is not bounded, so enqueue never waits
+class Locked_dynamic_queue {
+private:
+	std::mutex lock;
+	Dynamic_queue<long long> queue;
+
+public:
+	void enqueue(long long obj) {
+		std::lock_guard<std::mutex> guard(lock);
+		queue.enqueue(obj);
+	}
+
+	bool try_dequeue(long long &obj) {
+		std::lock_guard<std::mutex> guard(lock);
+
+		if (queue.empty()) {
+			return false;
+		}
+
+		obj = queue.dequeue();
+		return true;
+	}
+};
+
+// The push and try_pop of Treiber_stack, on one Linked_stack under one lock
+class Locked_linked_stack {
+private:
+	std::mutex lock;
+	Linked_stack<int> stack;
+
+public:
+	void push(int obj) {
+		std::lock_guard<std::mutex> guard(lock);
+		stack.push(obj);
+	}
+
+	bool try_pop(int &obj) {
+		std::lock_guard<std::mutex> guard(lock);
+
+		if (stack.empty()) {
+			return false;
+		}
+
+		obj = stack.pop();
+		return true;
+	}
+};
+
+// The push and try_pop of Multi_queue, on one Leftist_heap under one lock
+class Locked_leftist_heap {
+private:
+	std::mutex lock;
+	Leftist_heap<long long> heap;
+
+public:
+	void push(long long obj) {
+		std::lock_guard<std::mutex> guard(lock);
+		heap.push(obj);
+	}
+
+	bool try_pop(long long &obj) {
+		std::lock_guard<std::mutex> guard(lock);
+
+		if (heap.empty()) {
+			return false;
+		}
+
+		obj = heap.pop();
+		return true;
+	}
+};
+
+// A Fenwick tree over the keys 0 to n - 1 that are still queued
+class Key_ranks {
+private:
+	std::vector<int> tree;
+
+public:
+	explicit Key_ranks(int n) :
+	tree(n + 1, 0) {
+		for (int i = 1; i <= n; ++i) {
+			tree[i]++;
+			if (i + (i & -i) <= n) {
+				tree[i + (i & -i)] += tree[i];
+			}
+		}
+	}
+
+	// Returns the number of queued keys smaller than the key, then removes the key
+	int remove(int key) {
+		int rank = 0;
+
+		for (int i = key; i > 0; i -= i & -i) {
+			rank += tree[i];
+		}
+
+		for (int i = key + 1; i < static_cast<int>(tree.size()); i += i & -i) {
+			tree[i]--;
+		}
+
+		return rank;
+	}
+};
+
+// The threads between them push and pop TASKS times; returns the sum of the elements popped
+template <typename Stack>
+long long run_push_pop(Stack &stack, int threads) {
+	std::atomic<long long> sum(0);
+	std::vector<std::thread> workers;
+
+	for (int t = 0; t < threads; ++t) {
+		int const rounds = share(TASKS, threads, t);
+
+		workers.push_back(std::thread([&stack, &sum, rounds]() {
+			long long mine = 0;
+			int obj;
+
+			for (int i = 0; i < rounds; ++i) {
+				stack.push(i);
+
+				if (stack.try_pop(obj)) {
+					mine += obj;
+				}
+			}
+
+			sum += mine;
+		}));
+	}
+
+	for (std::size_t t = 0; t < workers.size(); ++t) {
+		workers[t].join();
+	}
+
+	return sum;
+}
+
+// The threads between them pop TASKS keys, each pushed back increased by up to 1023
+template <typename Queue>
+void run_hold(Queue &queue, int threads) {
+	std::vector<std::thread> workers;
+
+	for (int t = 0; t < threads; ++t) {
+		int const rounds = share(TASKS, threads, t);
+
+		workers.push_back(std::thread([&queue, rounds, t]() {
+			std::minstd_rand random(t + 1);
+			long long key;
+
+			for (int i = 0; i < rounds; ++i) {
+				if (queue.try_pop(key)) {
+					queue.push(key + static_cast<long long>(random() & 1023));
+				}
+			}
+		}));
+	}
+
+	for (std::size_t t = 0; t < workers.size(); ++t) {
+		workers[t].join();
+	}
+}
+
+// Drains the queue, appending (stamp, key) for every pop to the thread's own vector
+void run_drain(Multi_queue<long long> &queue, int threads, std::vector<std::vector<std::pair<int, int> > > &popped) {
+	std::atomic<int> stamp(0);
+	std::vector<std::thread> workers;
+
+	for (int t = 0; t < threads; ++t) {
+		workers.push_back(std::thread([&queue, &popped, &stamp, t]() {
+			std::vector<std::pair<int, int> > &mine = popped[t];
+			long long key;
+
+			while (queue.try_pop(key)) {
+				mine.push_back(std::make_pair(stamp.fetch_add(1), static_cast<int>(key)));
+			}
+		}));
+	}
+
+	for (std::size_t t = 0; t < workers.size(); ++t) {
+		workers[t].join();
+	}
+}
+
+// The producers enqueue TASKS timestamps between them and the consumers dequeue
+// as many, each appending the time in the queue of every eighth to its own vector
+template <typename Queue>
+void run_transfer(Queue &queue, int producers, int consumers, std::vector<std::vector<long long> > &latencies) {
+	std::vector<std::thread> workers;
+
+	for (int p = 0; p < producers; ++p) {
+		int const rounds = share(TASKS, producers, p);
+
+		workers.push_back(std::thread([&queue, rounds]() {
+			for (int i = 0; i < rounds; ++i) {
+				queue.enqueue(now_ns());
+			}
+		}));
+	}
+
+	for (int c = 0; c < consumers; ++c) {
+		int const quota = share(TASKS, consumers, c);
+
+		workers.push_back(std::thread([&queue, &latencies, quota, c]() {
+			std::vector<long long> &mine = latencies[c];
+			long long stamp;
+
+			for (int taken = 0; taken < quota; ) {
+				if (!queue.try_dequeue(stamp)) {
+					std::this_thread::yield();
+					continue;
+				}
+
+				if ((taken & 7) == 0) {
+					mine.push_back(now_ns() - stamp);
+				}
+
+				++taken;
+			}
+		}));
+	}
+
+	for (std::size_t t = 0; t < workers.size(); ++t) {
+		workers[t].join();
+	}
+}
+
+// Returns the sample below which the given fraction of the samples lie
+long long percentile(std::vector<long long> &samples, double fraction) {
+	if (samples.empty()) {
+		return 0;
+	}
+
+	std::vector<long long>::iterator nth = samples.begin() + static_cast<std::ptrdiff_t>(fraction * (samples.size() - 1));
+	std::nth_element(samples.begin(), nth, samples.end());
+	return *nth;
+}
+
+template <typename Queue>
+void bench_transfer(Bench_state &state, Queue &queue, int producers, int consumers) {
+	std::vector<std::vector<long long> > latencies(consumers);
+	for (int c = 0; c < consumers; ++c) latencies[c].reserve(TASKS / 8 + 1);
+	std::vector<long long> samples;
+
+	while (state.keep_running()) {
+		run_transfer(queue, producers, consumers, latencies);
+
+		state.pause_timing();
+		for (int c = 0; c < consumers; ++c) {
+			samples.insert(samples.end(), latencies[c].begin(), latencies[c].end());
+			latencies[c].clear();
+		}
+		state.resume_timing();
+	}
+
+	state.set_items_processed(state.iterations() * TASKS);
+	state.set_counter("p50_ns", static_cast<double>(percentile(samples, 0.50)));
+	state.set_counter("p99_ns", static_cast<double>(percentile(samples, 0.99)));
+}
+
+// Returns the number of tasks taken, which must be all of them
+template <typename Deque>
+long long run_steal(Deque &deque, int threads) {
+	std::atomic<bool> done(false);
+	std::atomic<long long> taken(0);
+	std::vector<std::thread> thieves;
+
+	for (int t = 1; t < threads; ++t) {
+		thieves.push_back(std::thread([&deque, &done, &taken]() {
+			long long mine = 0;
+			int obj;
+
+			while (!done.load(std::memory_order_acquire)) {
+				if (deque.pop_front(obj)) {
+					++mine;
+				}
+			}
+
+			while (deque.pop_front(obj)) {
+				++mine;
+			}
+
+			taken += mine;
+		}));
+	}
+
+	long long mine = 0;
+	int obj;
+
+	for (int i = 0; i < TASKS; ++i) {
+		deque.push_back(i);
+
+		if ((i & 3) == 3 && deque.pop_back(obj)) {
+			++mine;
+		}
+	}
+
+	while (deque.pop_back(obj)) {
+		++mine;
+	}
+
+	done.store(true, std::memory_order_release);
+
+	for (std::size_t t = 0; t < thieves.size(); ++t) {
+		thieves[t].join();
+	}
+
+	return taken + mine;
+}
+
+void register_threads(int threads) {
+	std::string const suffix = "/" + std::to_string(threads);
+
+	bench_register("deque/chase_lev/steal" + suffix, [threads](Bench_state &state) {
+		while (state.keep_running()) {
+			Chase_lev_deque<int> deque;
+			bench_do_not_optimize(run_steal(deque, threads));
+		}
+		state.set_items_processed(state.iterations() * TASKS);
+	});
+
+	bench_register("deque/locked_list/steal" + suffix, [threads](Bench_state &state) {
+		while (state.keep_running()) {
+			Locked_list_deque deque;
+			bench_do_not_optimize(run_steal(deque, threads));
+		}
+		state.set_items_processed(state.iterations() * TASKS);
+	});
+
+	bench_register("thread_pool/submit" + suffix, [threads](Bench_state &state) {
+		Thread_pool pool(threads);
+		std::atomic<int> calls(0);
+
+		while (state.keep_running()) {
+			for (int i = 0; i < TASKS; ++i) {
+				pool.submit([&calls]() { calls.fetch_add(1, std::memory_order_relaxed); });
+			}
+			pool.wait();
+		}
+		bench_do_not_optimize(calls.load());
+		state.set_items_processed(state.iterations() * TASKS);
+	});
+
+	bench_register("thread_pool/parallel_for" + suffix, [threads](Bench_state &state) {
+		Thread_pool pool(threads);
+		std::vector<int> values(TASKS);
+
+		while (state.keep_running()) {
+			pool.parallel_for(0, TASKS, [&values](int i) { values[i] += i; });
+		}
+		bench_do_not_optimize(values[TASKS - 1]);
+		state.set_items_processed(state.iterations() * TASKS);
+	});
+
+	bench_register("stack/treiber/push_pop" + suffix, [threads](Bench_state &state) {
+		Treiber_stack<int> stack;
+
+		while (state.keep_running()) {
+			bench_do_not_optimize(run_push_pop(stack, threads));
+		}
+		state.set_items_processed(state.iterations() * TASKS);
+	});
+
+	bench_register("stack/elimination/push_pop" + suffix, [threads](Bench_state &state) {
+		Elimination_stack<int> stack(threads);
+
+		while (state.keep_running()) {
+			bench_do_not_optimize(run_push_pop(stack, threads));
+		}
+		state.set_items_processed(state.iterations() * TASKS);
+	});
+
+	bench_register("stack/locked_linked/push_pop" + suffix, [threads](Bench_state &state) {
+		Locked_linked_stack stack;
+
+		while (state.keep_running()) {
+			bench_do_not_optimize(run_push_pop(stack, threads));
+		}
+		state.set_items_processed(state.iterations() * TASKS);
+	});
+
+	// A transfer needs at least one producer and one consumer
+	if (threads >= 2) {
+		int const producers = threads / 2;
+
+		bench_register("queue/mpmc/transfer" + suffix, [threads, producers](Bench_state &state) {
+			Mpmc_queue<long long> queue(RING_CAPACITY);
+			bench_transfer(state, queue, producers, threads - producers);
+		});
+
+		bench_register("queue/locked_dynamic/transfer" + suffix, [threads, producers](Bench_state &state) {
+			Locked_dynamic_queue queue;
+			bench_transfer(state, queue, producers, threads - producers);
+		});
+	}
+
+	bench_register("priority_queue/multi_queue/hold" + suffix, [threads](Bench_state &state) {
+		Multi_queue<long long> queue(threads);
+		for (int i = 0; i < QUEUED_KEYS; ++i) queue.push(i);
+
+		while (state.keep_running()) {
+			run_hold(queue, threads);
+		}
+		bench_do_not_optimize(queue.size());
+		state.set_items_processed(state.iterations() * TASKS);
+	});
+
+	bench_register("priority_queue/locked_leftist/hold" + suffix, [threads](Bench_state &state) {
+		Locked_leftist_heap queue;
+		for (int i = 0; i < QUEUED_KEYS; ++i) queue.push(i);
+
+		while (state.keep_running()) {
+			run_hold(queue, threads);
+		}
+		state.set_items_processed(state.iterations() * TASKS);
+	});
+
+	// The queue is filled and the pops are ranked outside the timed region
+	bench_register("priority_queue/multi_queue/rank_error" + suffix, [threads](Bench_state &state) {
+		std::vector<int> keys(QUEUED_KEYS);
+		for (int i = 0; i < QUEUED_KEYS; ++i) keys[i] = i;
+		std::shuffle(keys.begin(), keys.end(), std::minstd_rand(1));
+
+		double rank_sum = 0.0;
+		long long ranked = 0;
+		int rank_max = 0;
+
+		while (state.keep_running()) {
+			state.pause_timing();
+			Multi_queue<long long> queue(threads);
+			for (int i = 0; i < QUEUED_KEYS; ++i) queue.push(keys[i]);
+
+			std::vector<std::vector<std::pair<int, int> > > popped(threads);
+			for (int t = 0; t < threads; ++t) popped[t].reserve(QUEUED_KEYS);
+			state.resume_timing();
+
+			run_drain(queue, threads, popped);
+
+			state.pause_timing();
+			std::vector<std::pair<int, int> > order;
+			for (int t = 0; t < threads; ++t) order.insert(order.end(), popped[t].begin(), popped[t].end());
+			std::sort(order.begin(), order.end());
+
+			Key_ranks ranks(QUEUED_KEYS);
+			for (std::size_t i = 0; i < order.size(); ++i) {
+				int const rank = ranks.remove(order[i].second);
+				rank_sum += rank;
+				rank_max = std::max(rank_max, rank);
+			}
+			ranked += static_cast<long long>(order.size());
+			state.resume_timing();
+		}
+
+		state.set_items_processed(state.iterations() * QUEUED_KEYS);
+		state.set_counter("mean_rank_error", (ranked == 0) ? 0.0 : rank_sum / ranked);
+		state.set_counter("max_rank_error", rank_max);
+	});
+
+	bench_register("thread_pool/latency" + suffix, [threads](Bench_state &state) {
+		Thread_pool pool(threads);
+		int sum = 0;
+
+		while (state.keep_running()) {
+			sum += pool.submit([]() { return 1; }).get();
+		}
+		bench_do_not_optimize(sum);
+		state.set_items_processed(state.iterations());
+	});
+}
+
+}
+
+void register_concurrent_benchmarks() {
+	// Spsc_queue allows exactly one thread on each end
+	bench_register("queue/spsc/transfer/2", [](Bench_state &state) {
+		Spsc_queue<long long> queue(RING_CAPACITY);
+		bench_transfer(state, queue, 1, 1);
+	});
+
+	for (int threads : bench_thread_counts()) {
+		register_threads(threads);
+	}
+}
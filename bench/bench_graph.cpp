@@ -0,0 +1,71 @@
+/*
+* Benchmarks of Weighted_graph.
+*
+*   weighted_graph/mst/<n>   Kruskal's minimum spanning tree of a connected graph
+*                            of n vertices and about 4n edges of random weights
+*
+* Weighted_graph needs Disjoint_sets.h, Binary_search_tree.h and
+* Binary_search_node.h, which are not part of this tree; CMake defines
+* BENCH_WEIGHTED_GRAPH only when ECE250_INCLUDE_DIR provides them.
+*/
+
+#ifdef BENCH_WEIGHTED_GRAPH
+
+#include <random>
+#include <string>
+#include "ece250.h"
+#include "Exception.h"
+#include "Weighted_graph.h"
+#include "Bench.h"
+
+namespace {
+
+// A random spanning path makes the graph connected; the other edges are random pairs
+void build_graph(Weighted_graph &graph, int n) {
+	std::mt19937 generator(1);
+	std::uniform_real_distribution<double> weight(1.0, 100.0);
+	std::uniform_int_distribution<int> vertex(0, n - 1);
+
+	for (int v = 1; v < n; ++v) {
+		graph.insert_edge(v - 1, v, weight(generator));
+	}
+
+	for (int e = 0; e < 3 * n; ++e) {
+		int v1 = vertex(generator);
+		int v2 = vertex(generator);
+
+		if (v1 != v2) {
+			graph.insert_edge(v1, v2, weight(generator));
+		}
+	}
+}
+
+void register_size(int n) {
+	bench_register("weighted_graph/mst/" + std::to_string(n), [n](Bench_state &state) {
+		Weighted_graph graph(n);
+		build_graph(graph, n);
+
+		while (state.keep_running()) {
+			bench_do_not_optimize(graph.minimum_spanning_tree());
+		}
+		state.set_items_processed(state.iterations() * graph.edge_count());
+	});
+}
+
+}
+
+void register_graph_benchmarks() {
+	int const sizes[] = { 1 << 8, 1 << 12 };
+
+	for (int n : sizes) {
+		register_size(n);
+	}
+}
+
+#else
+
+void register_graph_benchmarks() {
+	// Weighted_graph is not available in this build
+}
+
+#endif
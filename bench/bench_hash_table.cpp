@@ -0,0 +1,158 @@
+/*
+* Benchmarks of Quadratic_hash_table, against std::unordered_set.
+*
+*   insert       Build a table of n distinct keys, at a load factor of at most one half
+*   member_hit   n lookups of keys in the table, drawn from the key distribution
+*   member_miss  n lookups of keys that are not in the table
+*   churn        n steps of erasing the oldest key and inserting a new one, with
+*                n / 2 keys in the table; tombstones build up in the quadratic table
+*/
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "ece250.h"
+#include "Exception.h"
+#include "Quadratic_hash_table.h"
+#include "Bench.h"
+#include "Key_distribution.h"
+
+namespace {
+
+// The smallest power m such that 2^m bins hold n keys at a load factor of at most one half
+int table_power(int n) {
+	int m = 1;
+	while ((1 << m) < 2 * n) ++m;
+	return m;
+}
+
+std::string hash_name(char const *container, char const *operation, key_distribution_t distribution, int n) {
+	return std::string("hash_table/") + container + "/" + operation + "/" + key_distribution_name(distribution) + "/" + std::to_string(n);
+}
+
+void register_distribution(key_distribution_t d, int n) {
+	bench_register(hash_name("quadratic", "insert", d, n), [d, n](Bench_state &state) {
+		std::vector<int> keys = make_distinct_keys(d, n);
+
+		while (state.keep_running()) {
+			Quadratic_hash_table<int> table(table_power(n));
+			for (int i = 0; i < n; ++i) table.insert(keys[i]);
+			bench_do_not_optimize(table.size());
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	bench_register(hash_name("std_unordered_set", "insert", d, n), [d, n](Bench_state &state) {
+		std::vector<int> keys = make_distinct_keys(d, n);
+
+		while (state.keep_running()) {
+			std::unordered_set<int> table;
+			table.reserve(n);
+			for (int i = 0; i < n; ++i) table.insert(keys[i]);
+			bench_do_not_optimize(table.size());
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	bench_register(hash_name("quadratic", "member_hit", d, n), [d, n](Bench_state &state) {
+		std::vector<int> keys = make_distinct_keys(d, n);
+		std::vector<int> lookups = make_keys(d, n, n, 2);
+		Quadratic_hash_table<int> table(table_power(n));
+		for (int i = 0; i < n; ++i) table.insert(keys[i]);
+
+		while (state.keep_running()) {
+			int found = 0;
+			for (int i = 0; i < n; ++i) found += table.member(lookups[i]);
+			bench_do_not_optimize(found);
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	bench_register(hash_name("std_unordered_set", "member_hit", d, n), [d, n](Bench_state &state) {
+		std::vector<int> keys = make_distinct_keys(d, n);
+		std::vector<int> lookups = make_keys(d, n, n, 2);
+		std::unordered_set<int> table(keys.begin(), keys.end());
+
+		while (state.keep_running()) {
+			int found = 0;
+			for (int i = 0; i < n; ++i) found += static_cast<int>(table.count(lookups[i]));
+			bench_do_not_optimize(found);
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	// The keys are all non-negative, so their negations are never in the table
+	bench_register(hash_name("quadratic", "member_miss", d, n), [d, n](Bench_state &state) {
+		std::vector<int> keys = make_distinct_keys(d, n);
+		Quadratic_hash_table<int> table(table_power(n));
+		for (int i = 0; i < n; ++i) table.insert(keys[i]);
+
+		while (state.keep_running()) {
+			int found = 0;
+			for (int i = 0; i < n; ++i) found += table.member(-keys[i] - 1);
+			bench_do_not_optimize(found);
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	bench_register(hash_name("std_unordered_set", "member_miss", d, n), [d, n](Bench_state &state) {
+		std::vector<int> keys = make_distinct_keys(d, n);
+		std::unordered_set<int> table(keys.begin(), keys.end());
+
+		while (state.keep_running()) {
+			int found = 0;
+			for (int i = 0; i < n; ++i) found += static_cast<int>(table.count(-keys[i] - 1));
+			bench_do_not_optimize(found);
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	// A window of n / 2 keys slides around the n distinct keys, so no insert is a duplicate
+	bench_register(hash_name("quadratic", "churn", d, n), [d, n](Bench_state &state) {
+		std::vector<int> keys = make_distinct_keys(d, n);
+		Quadratic_hash_table<int> table(table_power(n));
+		int oldest = 0;
+		for (int i = 0; i < n / 2; ++i) table.insert(keys[i]);
+
+		while (state.keep_running()) {
+			for (int i = 0; i < n; ++i) {
+				table.erase(keys[oldest]);
+				table.insert(keys[(oldest + n / 2) % n]);
+				oldest = (oldest + 1) % n;
+			}
+		}
+		bench_do_not_optimize(table.size());
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	bench_register(hash_name("std_unordered_set", "churn", d, n), [d, n](Bench_state &state) {
+		std::vector<int> keys = make_distinct_keys(d, n);
+		std::unordered_set<int> table;
+		table.reserve(n);
+		int oldest = 0;
+		for (int i = 0; i < n / 2; ++i) table.insert(keys[i]);
+
+		while (state.keep_running()) {
+			for (int i = 0; i < n; ++i) {
+				table.erase(keys[oldest]);
+				table.insert(keys[(oldest + n / 2) % n]);
+				oldest = (oldest + 1) % n;
+			}
+		}
+		bench_do_not_optimize(table.size());
+		state.set_items_processed(state.iterations() * n);
+	});
+}
+
+}
+
+void register_hash_table_benchmarks() {
+	key_distribution_t const distributions[] = { SEQUENTIAL, UNIFORM, ZIPF };
+	int const sizes[] = { 1 << 10, 1 << 16 };
+
+	for (key_distribution_t d : distributions) {
+		for (int n : sizes) {
+			register_distribution(d, n);
+		}
+	}
+}
@@ -0,0 +1,226 @@
+/*
+* Benchmarks of Leftist_heap and Dary_heap, against std::priority_queue, and of
+* the monotone Radix_heap and Calendar_queue, against Leftist_heap.
+*
+*   push_pop  Push n keys, then pop them all
+*   hold      The hold model of event simulation: with n keys in the heap, n
+*             times pop the smallest key and push it back increased by a
+*             random amount drawn from the key distribution. The keys are
+*             64-bit, so they cannot overflow within any run the harness makes.
+*   meld      Push n keys spread over 64 heaps, meld them all into the first,
+*             then pop n / 64 keys. Leftist_heap::meld merges two trees along
+*             their right paths; a Dary_heap can only be melded by popping every
+*             element of one heap and pushing it onto the other.
+*   timer     A timer wheel: with n timers pending, the clock advances in ticks of
+*             64 and every timer due is popped and rescheduled at now + 1 plus
+*             a delay below 2^16 drawn from the key distribution, until n have
+*             fired. The calendar has n days, each wide enough for one year to
+*             span the longest delay.
+*/
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <string>
+#include <vector>
+#include "ece250.h"
+#include "Exception.h"
+#include "Calendar_queue.h"
+#include "Dary_heap.h"
+#include "Leftist_heap.h"
+#include "Radix_heap.h"
+#include "Bench.h"
+#include "Key_distribution.h"
+
+namespace {
+
+typedef std::priority_queue<int, std::vector<int>, std::greater<int> > std_min_heap;
+typedef std::priority_queue<long long, std::vector<long long>, std::greater<long long> > std_time_heap;
+
+int const MELD_PARTS = 64;
+int const TIMER_TICK = 64;
+int const TIMER_DELAYS = 1 << 16;
+
+std::string heap_name(char const *container, char const *operation, key_distribution_t distribution, int n) {
+	return std::string("heap/") + container + "/" + operation + "/" + key_distribution_name(distribution) + "/" + std::to_string(n);
+}
+
+// Fires n timers, rescheduling each, and returns the time at which the last one fired
+template <typename Heap>
+long long run_timers(Heap &heap, std::vector<int> const &delays, long long now, int n) {
+	for (int fired = 0; fired < n; ) {
+		now += TIMER_TICK;
+
+		while (fired < n && heap.top() <= now) {
+			heap.pop();
+			heap.push(now + 1 + (delays[fired] & (TIMER_DELAYS - 1)));
+			++fired;
+		}
+	}
+
+	return now;
+}
+
+template <typename Heap>
+void bench_timers(Bench_state &state, Heap &heap, key_distribution_t d, int n) {
+	std::vector<int> keys = make_keys(d, n, n);
+	std::vector<int> delays = make_keys(d, n, n, 2);
+	for (int i = 0; i < n; ++i) heap.push(1 + (keys[i] & (TIMER_DELAYS - 1)));
+
+	long long now = 0;
+
+	while (state.keep_running()) {
+		now = run_timers(heap, delays, now, n);
+	}
+	bench_do_not_optimize(now);
+	state.set_items_processed(state.iterations() * n);
+}
+
+void register_distribution(key_distribution_t d, int n) {
+	bench_register(heap_name("leftist", "push_pop", d, n), [d, n](Bench_state &state) {
+		std::vector<int> keys = make_keys(d, n, n);
+
+		while (state.keep_running()) {
+			Leftist_heap<int> heap;
+			for (int i = 0; i < n; ++i) heap.push(keys[i]);
+			long long sum = 0;
+			while (!heap.empty()) sum += heap.pop();
+			bench_do_not_optimize(sum);
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	bench_register(heap_name("dary", "push_pop", d, n), [d, n](Bench_state &state) {
+		std::vector<int> keys = make_keys(d, n, n);
+
+		while (state.keep_running()) {
+			Dary_heap<int> heap;
+			for (int i = 0; i < n; ++i) heap.push(keys[i]);
+			long long sum = 0;
+			while (!heap.empty()) sum += heap.pop();
+			bench_do_not_optimize(sum);
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	bench_register(heap_name("std_priority_queue", "push_pop", d, n), [d, n](Bench_state &state) {
+		std::vector<int> keys = make_keys(d, n, n);
+
+		while (state.keep_running()) {
+			std_min_heap heap;
+			for (int i = 0; i < n; ++i) heap.push(keys[i]);
+			long long sum = 0;
+			while (!heap.empty()) { sum += heap.top(); heap.pop(); }
+			bench_do_not_optimize(sum);
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	// Each key grows by less than 2^16 per pop, and no run pops a key 2^40 times
+	bench_register(heap_name("leftist", "hold", d, n), [d, n](Bench_state &state) {
+		std::vector<int> keys = make_keys(d, n, n);
+		std::vector<int> increments = make_keys(d, n, n, 2);
+		Leftist_heap<long long> heap;
+		for (int i = 0; i < n; ++i) heap.push(keys[i] & 0xffff);
+
+		while (state.keep_running()) {
+			for (int i = 0; i < n; ++i) {
+				long long key = heap.pop();
+				heap.push(key + (increments[i] & 0xffff));
+			}
+		}
+		bench_do_not_optimize(heap.size());
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	bench_register(heap_name("dary", "hold", d, n), [d, n](Bench_state &state) {
+		std::vector<int> keys = make_keys(d, n, n);
+		std::vector<int> increments = make_keys(d, n, n, 2);
+		Dary_heap<long long> heap;
+		for (int i = 0; i < n; ++i) heap.push(keys[i] & 0xffff);
+
+		while (state.keep_running()) {
+			for (int i = 0; i < n; ++i) {
+				long long key = heap.pop();
+				heap.push(key + (increments[i] & 0xffff));
+			}
+		}
+		bench_do_not_optimize(heap.size());
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	bench_register(heap_name("std_priority_queue", "hold", d, n), [d, n](Bench_state &state) {
+		std::vector<int> keys = make_keys(d, n, n);
+		std::vector<int> increments = make_keys(d, n, n, 2);
+		std_time_heap heap;
+		for (int i = 0; i < n; ++i) heap.push(keys[i] & 0xffff);
+
+		while (state.keep_running()) {
+			for (int i = 0; i < n; ++i) {
+				long long key = heap.top();
+				heap.pop();
+				heap.push(key + (increments[i] & 0xffff));
+			}
+		}
+		bench_do_not_optimize(heap.size());
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	bench_register(heap_name("leftist", "timer", d, n), [d, n](Bench_state &state) {
+		Leftist_heap<long long> heap;
+		bench_timers(state, heap, d, n);
+	});
+
+	bench_register(heap_name("radix", "timer", d, n), [d, n](Bench_state &state) {
+		Radix_heap<long long> heap;
+		bench_timers(state, heap, d, n);
+	});
+
+	bench_register(heap_name("calendar", "timer", d, n), [d, n](Bench_state &state) {
+		Calendar_queue<long long> heap(n, std::max(TIMER_DELAYS / n, 1));
+		bench_timers(state, heap, d, n);
+	});
+
+	bench_register(heap_name("leftist", "meld", d, n), [d, n](Bench_state &state) {
+		std::vector<int> keys = make_keys(d, n, n);
+
+		while (state.keep_running()) {
+			std::vector<Leftist_heap<int> > parts(MELD_PARTS);
+			for (int i = 0; i < n; ++i) parts[i % MELD_PARTS].push(keys[i]);
+			for (int p = 1; p < MELD_PARTS; ++p) parts[0].meld(parts[p]);
+			long long sum = 0;
+			for (int i = 0; i < n / MELD_PARTS; ++i) sum += parts[0].pop();
+			bench_do_not_optimize(sum);
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	bench_register(heap_name("dary", "meld", d, n), [d, n](Bench_state &state) {
+		std::vector<int> keys = make_keys(d, n, n);
+
+		while (state.keep_running()) {
+			std::vector<Dary_heap<int> > parts(MELD_PARTS);
+			for (int i = 0; i < n; ++i) parts[i % MELD_PARTS].push(keys[i]);
+			for (int p = 1; p < MELD_PARTS; ++p) {
+				while (!parts[p].empty()) parts[0].push(parts[p].pop());
+			}
+			long long sum = 0;
+			for (int i = 0; i < n / MELD_PARTS; ++i) sum += parts[0].pop();
+			bench_do_not_optimize(sum);
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+}
+
+}
+
+void register_heap_benchmarks() {
+	key_distribution_t const distributions[] = { SEQUENTIAL, UNIFORM, ZIPF };
+	int const sizes[] = { 1 << 10, 1 << 16 };
+
+	for (key_distribution_t d : distributions) {
+		for (int n : sizes) {
+			register_distribution(d, n);
+		}
+	}
+}
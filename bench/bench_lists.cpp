@@ -0,0 +1,156 @@
+/*
+* Benchmarks of Double_sentinel_list, against std::list.
+*
+*   push_pop      push_back n elements, then pop_front them all
+*   count         Count the matches of a key in a list of n elements (a full scan)
+*   lru/<dist>    An LRU cache of n entries: n accesses, with keys drawn from the
+*                 distribution, each moving its entry to the front
+*   string_move   push_pop with 64-character strings pushed by move
+*/
+
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "ece250.h"
+#include "Exception.h"
+#include "Double_sentinel_list.h"
+#include "Bench.h"
+#include "Key_distribution.h"
+
+namespace {
+
+std::string list_name(char const *container, char const *operation, int n) {
+	return std::string("list/") + container + "/" + operation + "/" + std::to_string(n);
+}
+
+std::vector<std::string> make_strings(int n) {
+	std::vector<std::string> strings;
+	strings.reserve(n);
+	for (int i = 0; i < n; ++i) strings.push_back(std::string(64, static_cast<char>('a' + i % 26)));
+	return strings;
+}
+
+// Each access looks the key up in a map of iterators and moves its entry to the front
+template <typename List>
+void run_lru(Bench_state &state, List &list, std::vector<int> const &keys, std::vector<int> const &accesses) {
+	std::unordered_map<int, typename List::iterator> index;
+	for (std::size_t i = 0; i < keys.size(); ++i) {
+		list.push_back(keys[i]);
+		typename List::iterator last = list.end();
+		index[keys[i]] = --last;
+	}
+
+	while (state.keep_running()) {
+		for (std::size_t i = 0; i < accesses.size(); ++i) {
+			list.splice(list.begin(), list, index[accesses[i]]);
+		}
+	}
+	bench_do_not_optimize(list.size());
+	state.set_items_processed(state.iterations() * static_cast<long long>(accesses.size()));
+}
+
+void register_size(int n) {
+	bench_register(list_name("double_sentinel", "push_pop", n), [n](Bench_state &state) {
+		while (state.keep_running()) {
+			Double_sentinel_list<int> list;
+			for (int i = 0; i < n; ++i) list.push_back(i);
+			long long sum = 0;
+			while (!list.empty()) sum += list.pop_front();
+			bench_do_not_optimize(sum);
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	bench_register(list_name("std_list", "push_pop", n), [n](Bench_state &state) {
+		while (state.keep_running()) {
+			std::list<int> list;
+			for (int i = 0; i < n; ++i) list.push_back(i);
+			long long sum = 0;
+			while (!list.empty()) { sum += list.front(); list.pop_front(); }
+			bench_do_not_optimize(sum);
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	bench_register(list_name("double_sentinel", "count", n), [n](Bench_state &state) {
+		Double_sentinel_list<int> list;
+		for (int i = 0; i < n; ++i) list.push_back(i % 100);
+
+		while (state.keep_running()) {
+			bench_do_not_optimize(list.count(42));
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	bench_register(list_name("std_list", "count", n), [n](Bench_state &state) {
+		std::list<int> list;
+		for (int i = 0; i < n; ++i) list.push_back(i % 100);
+
+		while (state.keep_running()) {
+			long long found = 0;
+			for (std::list<int>::const_iterator it = list.begin(); it != list.end(); ++it) found += (*it == 42);
+			bench_do_not_optimize(found);
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	key_distribution_t const distributions[] = { UNIFORM, ZIPF };
+
+	for (key_distribution_t d : distributions) {
+		bench_register(list_name("double_sentinel", (std::string("lru/") + key_distribution_name(d)).c_str(), n), [d, n](Bench_state &state) {
+			Double_sentinel_list<int> list;
+			run_lru(state, list, make_distinct_keys(d, n), make_keys(d, n, n, 2));
+		});
+
+		bench_register(list_name("std_list", (std::string("lru/") + key_distribution_name(d)).c_str(), n), [d, n](Bench_state &state) {
+			std::list<int> list;
+			run_lru(state, list, make_distinct_keys(d, n), make_keys(d, n, n, 2));
+		});
+	}
+
+	bench_register(list_name("double_sentinel", "string_move", n), [n](Bench_state &state) {
+		std::vector<std::string> strings;
+
+		while (state.keep_running()) {
+			state.pause_timing();
+			strings = make_strings(n);
+			state.resume_timing();
+
+			Double_sentinel_list<std::string> list;
+			for (int i = 0; i < n; ++i) list.push_back(std::move(strings[i]));
+			std::size_t total = 0;
+			while (!list.empty()) total += list.pop_front().size();
+			bench_do_not_optimize(total);
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	bench_register(list_name("std_list", "string_move", n), [n](Bench_state &state) {
+		std::vector<std::string> strings;
+
+		while (state.keep_running()) {
+			state.pause_timing();
+			strings = make_strings(n);
+			state.resume_timing();
+
+			std::list<std::string> list;
+			for (int i = 0; i < n; ++i) list.push_back(std::move(strings[i]));
+			std::size_t total = 0;
+			while (!list.empty()) { total += list.front().size(); list.pop_front(); }
+			bench_do_not_optimize(total);
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+}
+
+}
+
+void register_list_benchmarks() {
+	int const sizes[] = { 1 << 10, 1 << 16 };
+
+	for (int n : sizes) {
+		register_size(n);
+	}
+}
@@ -0,0 +1,30 @@
+/*
+* The benchmark suite: the options are parsed first, since the thread counts
+* they select decide which concurrent benchmarks exist, then each bench_*.cpp
+* registers its benchmarks and the ones selected on the command line are run.
+*/
+
+#include "Bench.h"
+
+void register_hash_table_benchmarks();
+void register_heap_benchmarks();
+void register_queue_benchmarks();
+void register_stack_benchmarks();
+void register_list_benchmarks();
+void register_concurrent_benchmarks();
+void register_graph_benchmarks();
+
+int main(int argc, char **argv) {
+	if (!bench_parse_options(argc, argv))
+		return 2;
+
+	register_hash_table_benchmarks();
+	register_heap_benchmarks();
+	register_queue_benchmarks();
+	register_stack_benchmarks();
+	register_list_benchmarks();
+	register_concurrent_benchmarks();
+	register_graph_benchmarks();
+
+	return bench_run_selected();
+}
@@ -0,0 +1,181 @@
+/*
+* Benchmarks of Dynamic_queue and Segmented_queue, against std::deque.
+*
+*   fill_drain     Enqueue n elements, then dequeue them all; the array grows and shrinks
+*   steady         With n elements queued, n times dequeue one and enqueue one
+*   burst          With n / 16 elements queued, enqueue a burst of n, then dequeue back
+*                  down to n / 16. The queue lives across bursts, so this shows what the
+*                  array growing and shrinking costs against chunks being recycled
+*   string_copy    fill_drain with 64-character strings enqueued by copy
+*   string_move    The same strings enqueued by move; dequeue moves them out either way
+*/
+
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ece250.h"
+#include "Exception.h"
+#include "Dynamic_queue.h"
+#include "Segmented_queue.h"
+#include "Bench.h"
+
+namespace {
+
+std::string queue_name(char const *container, char const *operation, int n) {
+	return std::string("queue/") + container + "/" + operation + "/" + std::to_string(n);
+}
+
+std::vector<std::string> make_strings(int n) {
+	std::vector<std::string> strings;
+	strings.reserve(n);
+	for (int i = 0; i < n; ++i) strings.push_back(std::string(64, static_cast<char>('a' + i % 26)));
+	return strings;
+}
+
+void register_size(int n) {
+	bench_register(queue_name("dynamic", "fill_drain", n), [n](Bench_state &state) {
+		while (state.keep_running()) {
+			Dynamic_queue<int> queue;
+			for (int i = 0; i < n; ++i) queue.enqueue(i);
+			long long sum = 0;
+			while (!queue.empty()) sum += queue.dequeue();
+			bench_do_not_optimize(sum);
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	bench_register(queue_name("std_deque", "fill_drain", n), [n](Bench_state &state) {
+		while (state.keep_running()) {
+			std::deque<int> queue;
+			for (int i = 0; i < n; ++i) queue.push_back(i);
+			long long sum = 0;
+			while (!queue.empty()) { sum += queue.front(); queue.pop_front(); }
+			bench_do_not_optimize(sum);
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	bench_register(queue_name("dynamic", "steady", n), [n](Bench_state &state) {
+		Dynamic_queue<int> queue;
+		for (int i = 0; i < n; ++i) queue.enqueue(i);
+
+		while (state.keep_running()) {
+			for (int i = 0; i < n; ++i) queue.enqueue(queue.dequeue() + 1);
+		}
+		bench_do_not_optimize(queue.size());
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	bench_register(queue_name("std_deque", "steady", n), [n](Bench_state &state) {
+		std::deque<int> queue;
+		for (int i = 0; i < n; ++i) queue.push_back(i);
+
+		while (state.keep_running()) {
+			for (int i = 0; i < n; ++i) {
+				int front = queue.front();
+				queue.pop_front();
+				queue.push_back(front + 1);
+			}
+		}
+		bench_do_not_optimize(queue.size());
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	bench_register(queue_name("dynamic", "burst", n), [n](Bench_state &state) {
+		Dynamic_queue<int> queue;
+		for (int i = 0; i < n / 16; ++i) queue.enqueue(i);
+
+		while (state.keep_running()) {
+			for (int i = 0; i < n; ++i) queue.enqueue(i);
+			long long sum = 0;
+			for (int i = 0; i < n; ++i) sum += queue.dequeue();
+			bench_do_not_optimize(sum);
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	bench_register(queue_name("segmented", "burst", n), [n](Bench_state &state) {
+		Segmented_queue<int> queue;
+		for (int i = 0; i < n / 16; ++i) queue.enqueue(i);
+
+		while (state.keep_running()) {
+			for (int i = 0; i < n; ++i) queue.enqueue(i);
+			long long sum = 0;
+			for (int i = 0; i < n; ++i) sum += queue.dequeue();
+			bench_do_not_optimize(sum);
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	bench_register(queue_name("std_deque", "burst", n), [n](Bench_state &state) {
+		std::deque<int> queue;
+		for (int i = 0; i < n / 16; ++i) queue.push_back(i);
+
+		while (state.keep_running()) {
+			for (int i = 0; i < n; ++i) queue.push_back(i);
+			long long sum = 0;
+			for (int i = 0; i < n; ++i) { sum += queue.front(); queue.pop_front(); }
+			bench_do_not_optimize(sum);
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	bench_register(queue_name("dynamic", "string_copy", n), [n](Bench_state &state) {
+		std::vector<std::string> strings = make_strings(n);
+
+		while (state.keep_running()) {
+			Dynamic_queue<std::string> queue;
+			for (int i = 0; i < n; ++i) queue.enqueue(strings[i]);
+			std::size_t total = 0;
+			while (!queue.empty()) total += queue.dequeue().size();
+			bench_do_not_optimize(total);
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	// The strings are rebuilt outside the timed region, since each run moves them away
+	bench_register(queue_name("dynamic", "string_move", n), [n](Bench_state &state) {
+		std::vector<std::string> strings;
+
+		while (state.keep_running()) {
+			state.pause_timing();
+			strings = make_strings(n);
+			state.resume_timing();
+
+			Dynamic_queue<std::string> queue;
+			for (int i = 0; i < n; ++i) queue.enqueue(std::move(strings[i]));
+			std::size_t total = 0;
+			while (!queue.empty()) total += queue.dequeue().size();
+			bench_do_not_optimize(total);
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	bench_register(queue_name("std_deque", "string_move", n), [n](Bench_state &state) {
+		std::vector<std::string> strings;
+
+		while (state.keep_running()) {
+			state.pause_timing();
+			strings = make_strings(n);
+			state.resume_timing();
+
+			std::deque<std::string> queue;
+			for (int i = 0; i < n; ++i) queue.push_back(std::move(strings[i]));
+			std::size_t total = 0;
+			while (!queue.empty()) { total += queue.front().size(); queue.pop_front(); }
+			bench_do_not_optimize(total);
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+}
+
+}
+
+void register_queue_benchmarks() {
+	int const sizes[] = { 1 << 10, 1 << 16 };
+
+	for (int n : sizes) {
+		register_size(n);
+	}
+}
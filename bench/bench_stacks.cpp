@@ -0,0 +1,122 @@
+/*
+* Benchmarks of Linked_stack, against std::vector used as a stack.
+*
+*   push_pop      Push n elements, then pop them all
+*   sawtooth      n times push eight elements and pop seven, then pop the rest:
+*                 the top keeps crossing chunk boundaries
+*   string_copy   push_pop with 64-character strings pushed by copy
+*   string_move   The same strings pushed by move
+*/
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "ece250.h"
+#include "Exception.h"
+#include "Linked_stack.h"
+#include "Bench.h"
+
+namespace {
+
+std::string stack_name(char const *container, char const *operation, int n) {
+	return std::string("stack/") + container + "/" + operation + "/" + std::to_string(n);
+}
+
+std::vector<std::string> make_strings(int n) {
+	std::vector<std::string> strings;
+	strings.reserve(n);
+	for (int i = 0; i < n; ++i) strings.push_back(std::string(64, static_cast<char>('a' + i % 26)));
+	return strings;
+}
+
+void register_size(int n) {
+	bench_register(stack_name("linked", "push_pop", n), [n](Bench_state &state) {
+		while (state.keep_running()) {
+			Linked_stack<int> stack;
+			for (int i = 0; i < n; ++i) stack.push(i);
+			long long sum = 0;
+			while (!stack.empty()) sum += stack.pop();
+			bench_do_not_optimize(sum);
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	bench_register(stack_name("std_vector", "push_pop", n), [n](Bench_state &state) {
+		while (state.keep_running()) {
+			std::vector<int> stack;
+			for (int i = 0; i < n; ++i) stack.push_back(i);
+			long long sum = 0;
+			while (!stack.empty()) { sum += stack.back(); stack.pop_back(); }
+			bench_do_not_optimize(sum);
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	bench_register(stack_name("linked", "sawtooth", n), [n](Bench_state &state) {
+		while (state.keep_running()) {
+			Linked_stack<int> stack;
+			long long sum = 0;
+			for (int i = 0; i < n; ++i) {
+				for (int j = 0; j < 8; ++j) stack.push(j);
+				for (int j = 0; j < 7; ++j) sum += stack.pop();
+			}
+			while (!stack.empty()) sum += stack.pop();
+			bench_do_not_optimize(sum);
+		}
+		state.set_items_processed(state.iterations() * n * 16);
+	});
+
+	bench_register(stack_name("std_vector", "sawtooth", n), [n](Bench_state &state) {
+		while (state.keep_running()) {
+			std::vector<int> stack;
+			long long sum = 0;
+			for (int i = 0; i < n; ++i) {
+				for (int j = 0; j < 8; ++j) stack.push_back(j);
+				for (int j = 0; j < 7; ++j) { sum += stack.back(); stack.pop_back(); }
+			}
+			while (!stack.empty()) { sum += stack.back(); stack.pop_back(); }
+			bench_do_not_optimize(sum);
+		}
+		state.set_items_processed(state.iterations() * n * 16);
+	});
+
+	bench_register(stack_name("linked", "string_copy", n), [n](Bench_state &state) {
+		std::vector<std::string> strings = make_strings(n);
+
+		while (state.keep_running()) {
+			Linked_stack<std::string> stack;
+			for (int i = 0; i < n; ++i) stack.push(strings[i]);
+			std::size_t total = 0;
+			while (!stack.empty()) total += stack.pop().size();
+			bench_do_not_optimize(total);
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+
+	bench_register(stack_name("linked", "string_move", n), [n](Bench_state &state) {
+		std::vector<std::string> strings;
+
+		while (state.keep_running()) {
+			state.pause_timing();
+			strings = make_strings(n);
+			state.resume_timing();
+
+			Linked_stack<std::string> stack;
+			for (int i = 0; i < n; ++i) stack.push(std::move(strings[i]));
+			std::size_t total = 0;
+			while (!stack.empty()) total += stack.pop().size();
+			bench_do_not_optimize(total);
+		}
+		state.set_items_processed(state.iterations() * n);
+	});
+}
+
+}
+
+void register_stack_benchmarks() {
+	int const sizes[] = { 1 << 10, 1 << 16 };
+
+	for (int n : sizes) {
+		register_size(n);
+	}
+}
@@ -0,0 +1,72 @@
+#!/usr/bin/env python3
+"""
+Compares two result files written by ds_bench --json=<path> (or by Google
+Benchmark) and prints the change in time per iteration of each benchmark
+they share. Exits with 1 if any benchmark got slower by more than the
+threshold, so that it can gate a change:
+
+    python3 compare.py before.json after.json [--threshold=10] [--filter=<text>]
+"""
+
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        results = json.load(f)
+
+    times = {}
+    for entry in results.get("benchmarks", []):
+        if entry.get("run_type", "iteration") == "iteration":
+            times[entry["name"]] = float(entry["real_time"])
+    return times
+
+
+def main(argv):
+    threshold = 10.0
+    name_filter = ""
+    paths = []
+
+    for arg in argv[1:]:
+        if arg.startswith("--threshold="):
+            threshold = float(arg[len("--threshold="):])
+        elif arg.startswith("--filter="):
+            name_filter = arg[len("--filter="):]
+        else:
+            paths.append(arg)
+
+    if len(paths) != 2:
+        sys.stderr.write(__doc__)
+        return 2
+
+    old = load(paths[0])
+    new = load(paths[1])
+    names = [name for name in old if name in new and name_filter in name]
+
+    width = max([len("Benchmark")] + [len(name) for name in names])
+    print("%-*s %14s %14s %9s" % (width, "Benchmark", "Old (ns)", "New (ns)", "Change"))
+
+    regressions = 0
+    for name in names:
+        change = (new[name] - old[name]) / old[name] * 100.0 if old[name] > 0 else 0.0
+        flag = ""
+        if change > threshold:
+            flag = "  SLOWER"
+            regressions += 1
+        elif change < -threshold:
+            flag = "  faster"
+        print("%-*s %14.1f %14.1f %+8.1f%%%s" % (width, name, old[name], new[name], change, flag))
+
+    for name in sorted(set(old) ^ set(new)):
+        if name_filter in name:
+            print("%-*s only in %s" % (width, name, paths[0] if name in old else paths[1]))
+
+    if regressions:
+        print("%d benchmark(s) slower by more than %g%%" % (regressions, threshold))
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,27 @@
+/*
+* Exception.h (stand-in)
+*
+* The exception classes the containers throw, with the same names as the
+* course header, so that the benchmarks build outside the course environment.
+*/
+
+#ifndef EXCEPTIONS_H
+#define EXCEPTIONS_H
+
+class underflow {
+	// empty class
+};
+
+class overflow {
+	// empty class
+};
+
+class illegal_argument {
+	// empty class
+};
+
+class out_of_bounds {
+	// empty class
+};
+
+#endif
@@ -0,0 +1,15 @@
+/*
+* ece250.h (stand-in)
+*
+* The course header the containers include provides the standard headers they
+* rely on. This stand-in lets the benchmarks build outside the course
+* environment; it provides the same headers and nothing else.
+*/
+
+#ifndef ECE250
+#define ECE250
+
+#include <cstdlib>
+#include <iostream>
+
+#endif
@@ -0,0 +1,75 @@
+/*
+* Cache_aligned
+*
+* Allocation on cache line boundaries for the types declared alignas(64).
+*
+* Before C++17 a new-expression ignores any alignment beyond that of
+* std::max_align_t (GCC warns with -Waligned-new), so an alignas(64) object
+* allocated with new may share its first cache line with whatever precedes
+* it. These functions over-allocate by a cache line and align the result by
+* hand, keeping the pointer returned by malloc just below the aligned block.
+*
+* void *cache_aligned_allocate(std::size_t n)
+*   Returns n bytes starting on a cache line boundary. Throws std::bad_alloc
+*   if the memory cannot be allocated.
+*
+* void cache_aligned_deallocate(void *ptr)
+*   Frees memory returned by cache_aligned_allocate. Does nothing if ptr is nullptr.
+*
+* struct Cache_aligned
+*   A base for alignas(64) types whose class-specific operator new and
+*   operator new[] use the functions above, so that new and new[] of the
+*   derived type are aligned in every language version.
+*/
+
+#ifndef CACHE_ALIGNED_H
+#define CACHE_ALIGNED_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+static std::size_t const CACHE_LINE_SIZE = 64;
+
+inline void *cache_aligned_allocate(std::size_t n) {
+	void *raw = std::malloc(n + CACHE_LINE_SIZE + sizeof(void *));
+
+	if (raw == nullptr) {
+		throw std::bad_alloc();
+	}
+
+	// Leave room for the original pointer, then round up to the next cache line
+	std::uintptr_t address = reinterpret_cast<std::uintptr_t>(raw) + sizeof(void *);
+	address = (address + CACHE_LINE_SIZE - 1) & ~static_cast<std::uintptr_t>(CACHE_LINE_SIZE - 1);
+
+	void **aligned = reinterpret_cast<void **>(address);
+	aligned[-1] = raw;
+	return aligned;
+}
+
+inline void cache_aligned_deallocate(void *ptr) {
+	if (ptr != nullptr) {
+		std::free(static_cast<void **>(ptr)[-1]);
+	}
+}
+
+struct Cache_aligned {
+	static void *operator new(std::size_t n) {
+		return cache_aligned_allocate(n);
+	}
+
+	static void *operator new[](std::size_t n) {
+		return cache_aligned_allocate(n);
+	}
+
+	static void operator delete(void *ptr) {
+		cache_aligned_deallocate(ptr);
+	}
+
+	static void operator delete[](void *ptr) {
+		cache_aligned_deallocate(ptr);
+	}
+};
+
+#endif
@@ -0,0 +1,251 @@
+/*
+* Ds_stats
+*
+* Opt-in instrumentation shared by the containers of this library.
+*
+* Compiling with DS_ENABLE_STATS defined turns on the operation counters and
+* sampled latency histograms of the containers. Each of them then has a
+* stats() member function that returns a snapshot, a plain struct that can be
+* copied out and exported to a metrics pipeline. Without the macro the
+* counters, their updates and stats() itself are compiled out, so the
+* containers are exactly as large and as fast as before.
+*
+* Latencies are sampled rather than measured on every call: one operation in
+* DS_STATS_SAMPLE_PERIOD (64 unless defined otherwise) reads the clock, which
+* keeps the cost of a clock read off the other 63.
+*
+* Counters are updated without synchronization, like the rest of a container's
+* state; stats() must not race with modifications from other threads. The
+* containers meant to be shared between threads (Multi_queue, Chase_lev_deque,
+* Treiber_stack, Elimination_stack, Spsc_queue, Mpmc_queue, Thread_pool) count
+* with Ds_counter instead, and their stats() may be called at any time; the
+* counts are then only approximately consistent with one another. Threads
+* incrementing the same counter contend for its cache line, so throughput
+* under contention should be measured without DS_ENABLE_STATS. These
+* containers have no latency histograms, which would need a lock of their own.
+*
+* ---------------------------------------------------------
+*                   Ds_counter:
+*
+* void add(long long n = 1)
+*   Adds n to the count with a relaxed atomic increment.
+*
+* long long load() const
+* operator long long() const
+*   Returns the count. Copying a counter copies its current count, so a struct
+*   of counters can be returned as a snapshot.
+*
+* ---------------------------------------------------------
+*                   Ds_histogram:
+*
+* void record(int)
+*   Counts one sample. Samples of BUCKETS - 1 or more share the last bucket.
+*
+* long long buckets[BUCKETS]
+*   buckets[i] is the number of samples equal to i.
+*
+* long long samples, long long sum, int max
+*   The number of samples, their total, and the largest.
+*
+* double mean() const
+*   Returns the mean sample, or 0 if there are none.
+*
+* ---------------------------------------------------------
+*                   Ds_latency_histogram:
+*
+* Ds_latency_histogram(int period = DS_STATS_SAMPLE_PERIOD)
+*   A histogram that times one operation in period.
+*
+* bool sample()
+*   Counts one operation; returns true if it is one to time.
+*
+* void record(long long)
+*   Counts one latency, in nanoseconds. buckets[i] is the number of latencies
+*   in [2^i, 2^(i+1)) ns, with 0 ns in buckets[0]; the last bucket holds the rest.
+*
+* long long operations, long long samples, long long sum_ns, long long max_ns
+*   The operations counted, the latencies recorded, their total, and the largest.
+*
+* double mean_ns() const
+*   Returns the mean latency, or 0 if there are none.
+*
+* long long percentile_ns(double p) const
+*   Returns an upper bound on the p-th percentile latency (0 < p <= 100): the end
+*   of the bucket it falls in, or max_ns if that is smaller. Returns 0 if there are none.
+*
+* ---------------------------------------------------------
+*                   Ds_latency_timer:
+*
+* Ds_latency_timer(Ds_latency_histogram &)
+*   Reads the clock if the histogram samples this operation, and records the time
+*   elapsed when the timer goes out of scope. Declared inside DS_STATS(...) at the
+*   top of a member function, it times the whole call:
+*
+*       DS_STATS(Ds_latency_timer timer(statistics.push_latency);)
+*/
+
+#ifndef DS_STATS_H
+#define DS_STATS_H
+
+#include <atomic>
+#include <chrono>
+
+#ifndef DS_STATS_SAMPLE_PERIOD
+#define DS_STATS_SAMPLE_PERIOD 64
+#endif
+
+// Wraps the statements that update a counter; variadic, since a statement may contain commas
+#ifdef DS_ENABLE_STATS
+#define DS_STATS(...) __VA_ARGS__
+#else
+#define DS_STATS(...)
+#endif
+
+struct Ds_counter {
+	std::atomic<long long> count;
+
+	Ds_counter() :
+	count(0) {
+		// Empty constructor
+	}
+
+	Ds_counter(Ds_counter const &counter) :
+	count(counter.load()) {
+		// Empty constructor
+	}
+
+	Ds_counter &operator=(Ds_counter const &counter) {
+		count.store(counter.load(), std::memory_order_relaxed);
+		return *this;
+	}
+
+	void add(long long n = 1) {
+		count.fetch_add(n, std::memory_order_relaxed);
+	}
+
+	long long load() const {
+		return count.load(std::memory_order_relaxed);
+	}
+
+	operator long long() const {
+		return load();
+	}
+};
+
+struct Ds_histogram {
+	static int const BUCKETS = 32;
+
+	long long buckets[BUCKETS];
+	long long samples;
+	long long sum;
+	int max;
+
+	Ds_histogram() :
+	samples(0),
+	sum(0),
+	max(0) {
+		for (int i = 0; i < BUCKETS; ++i) {
+			buckets[i] = 0;
+		}
+	}
+
+	void record(int n) {
+		buckets[(n < BUCKETS - 1) ? n : BUCKETS - 1]++;
+		samples++;
+		sum += n;
+		if (n > max) max = n;
+	}
+
+	double mean() const {
+		return (samples == 0) ? 0.0 : static_cast<double>(sum) / samples;
+	}
+};
+
+struct Ds_latency_histogram {
+	static int const BUCKETS = 40;
+
+	long long buckets[BUCKETS];
+	long long operations;
+	long long samples;
+	long long sum_ns;
+	long long max_ns;
+	int period;
+	int countdown;
+
+	explicit Ds_latency_histogram(int n = DS_STATS_SAMPLE_PERIOD) :
+	operations(0),
+	samples(0),
+	sum_ns(0),
+	max_ns(0),
+	period(n < 1 ? 1 : n),
+	countdown(1) {
+		for (int i = 0; i < BUCKETS; ++i) {
+			buckets[i] = 0;
+		}
+	}
+
+	// The first operation is always timed, then one in every period
+	bool sample() {
+		operations++;
+		if (--countdown > 0) return false;
+		countdown = period;
+		return true;
+	}
+
+	void record(long long ns) {
+		int i = 0;
+		while (i < BUCKETS - 1 && (ns >> (i + 1)) > 0) ++i;
+
+		buckets[i]++;
+		samples++;
+		sum_ns += ns;
+		if (ns > max_ns) max_ns = ns;
+	}
+
+	double mean_ns() const {
+		return (samples == 0) ? 0.0 : static_cast<double>(sum_ns) / samples;
+	}
+
+	long long percentile_ns(double p) const {
+		if (samples == 0) return 0;
+
+		long long rank = static_cast<long long>(p / 100.0 * samples + 0.5);
+		if (rank < 1) rank = 1;
+
+		long long seen = 0;
+		for (int i = 0; i < BUCKETS - 1; ++i) {
+			seen += buckets[i];
+			if (seen >= rank) {
+				long long end = (2LL << i) - 1;
+				return (end < max_ns) ? end : max_ns;
+			}
+		}
+		return max_ns;
+	}
+};
+
+class Ds_latency_timer {
+private:
+	typedef std::chrono::steady_clock clock;
+
+	Ds_latency_histogram *histogram;	// nullptr if this operation is not sampled
+	clock::time_point start;
+
+	// Do not implement these functions!
+	Ds_latency_timer(Ds_latency_timer const &);
+	Ds_latency_timer &operator=(Ds_latency_timer const &);
+
+public:
+	explicit Ds_latency_timer(Ds_latency_histogram &h) :
+	histogram(h.sample() ? &h : nullptr) {
+		if (histogram != nullptr) start = clock::now();
+	}
+
+	~Ds_latency_timer() {
+		if (histogram != nullptr) {
+			histogram->record(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count());
+		}
+	}
+};
+
+#endif
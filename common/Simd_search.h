@@ -0,0 +1,284 @@
+/*
+* Simd_search
+*
+* Vectorized linear search over contiguous arrays, for the containers that
+* keep their elements contiguously (unrolled list nodes, queue and heap
+* arrays, hash table bins).
+*
+* int simd_count(Type const *array, int n, Type const &obj)
+*   Returns the number of the n elements of the array equal to obj.
+*
+* int simd_find(Type const *array, int n, Type const &obj)
+*   Returns the index of the first of the n elements equal to obj, or n if there is none.
+*
+* For arithmetic types of 1, 2, 4 or 8 bytes on x86 with GCC or Clang, the
+* elements are compared 32 bytes at a time with AVX2 if the processor
+* supports it (checked once, with CPUID), and otherwise 16 bytes at a time
+* with SSE2, which every x86-64 processor has. Each block of comparisons
+* reduces to a bit mask with one bit per byte, which is counted with popcount
+* or searched with count-trailing-zeros. Floating point elements are compared
+* as floating point, so the results agree with == (0.0 matches -0.0 and NaN
+* matches nothing). Every other type, compiler or processor falls back to a
+* scalar loop using ==.
+*/
+
+#ifndef SIMD_SEARCH_H
+#define SIMD_SEARCH_H
+
+#include <type_traits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+#define SIMD_SEARCH_X86 1
+#include <immintrin.h>
+#endif
+
+// True for the element types the vector kernels handle
+template <typename Type>
+struct Simd_searchable {
+	static bool const value = std::is_arithmetic<Type>::value &&
+		(sizeof(Type) == 1 || sizeof(Type) == 2 || sizeof(Type) == 4 || sizeof(Type) == 8) &&
+		!std::is_same<typename std::remove_cv<Type>::type, long double>::value;
+};
+
+template <typename Type>
+int simd_count_scalar(Type const *array, int n, Type const &obj) {
+	int count = 0;
+	for (int i = 0; i < n; ++i) {
+		if (array[i] == obj)
+			count++;
+	}
+	return count;
+}
+
+template <typename Type>
+int simd_find_scalar(Type const *array, int n, Type const &obj) {
+	for (int i = 0; i < n; ++i) {
+		if (array[i] == obj)
+			return i;
+	}
+	return n;
+}
+
+#ifdef SIMD_SEARCH_X86
+
+// Each kernel compares one vector of elements with a broadcast key and
+// returns a mask with one bit set for every byte of every equal element
+
+template <typename Type, int Size = sizeof(Type), bool Float = std::is_floating_point<Type>::value>
+struct Simd_sse2;
+
+template <typename Type>
+struct Simd_sse2<Type, 1, false> {
+	static __m128i broadcast(Type obj) { return _mm_set1_epi8(static_cast<char>(obj)); }
+	static unsigned mask(Type const *p, __m128i key) {
+		return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const *>(p)), key)));
+	}
+};
+
+template <typename Type>
+struct Simd_sse2<Type, 2, false> {
+	static __m128i broadcast(Type obj) { return _mm_set1_epi16(static_cast<short>(obj)); }
+	static unsigned mask(Type const *p, __m128i key) {
+		return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<__m128i const *>(p)), key)));
+	}
+};
+
+template <typename Type>
+struct Simd_sse2<Type, 4, false> {
+	static __m128i broadcast(Type obj) { return _mm_set1_epi32(static_cast<int>(obj)); }
+	static unsigned mask(Type const *p, __m128i key) {
+		return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const *>(p)), key)));
+	}
+};
+
+// SSE2 has no 64-bit integer compare: compare the 32-bit halves, then require both halves to match
+template <typename Type>
+struct Simd_sse2<Type, 8, false> {
+	static __m128i broadcast(Type obj) { return _mm_set1_epi64x(static_cast<long long>(obj)); }
+	static unsigned mask(Type const *p, __m128i key) {
+		__m128i halves = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const *>(p)), key);
+		__m128i both = _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+		return static_cast<unsigned>(_mm_movemask_epi8(both));
+	}
+};
+
+template <typename Type>
+struct Simd_sse2<Type, 4, true> {
+	static __m128 broadcast(Type obj) { return _mm_set1_ps(obj); }
+	static unsigned mask(Type const *p, __m128 key) {
+		return static_cast<unsigned>(_mm_movemask_epi8(_mm_castps_si128(_mm_cmpeq_ps(_mm_loadu_ps(p), key))));
+	}
+};
+
+template <typename Type>
+struct Simd_sse2<Type, 8, true> {
+	static __m128d broadcast(Type obj) { return _mm_set1_pd(obj); }
+	static unsigned mask(Type const *p, __m128d key) {
+		return static_cast<unsigned>(_mm_movemask_epi8(_mm_castpd_si128(_mm_cmpeq_pd(_mm_loadu_pd(p), key))));
+	}
+};
+
+template <typename Type, int Size = sizeof(Type), bool Float = std::is_floating_point<Type>::value>
+struct Simd_avx2;
+
+#define SIMD_SEARCH_AVX2 __attribute__((target("avx2")))
+
+template <typename Type>
+struct Simd_avx2<Type, 1, false> {
+	SIMD_SEARCH_AVX2 static __m256i broadcast(Type obj) { return _mm256_set1_epi8(static_cast<char>(obj)); }
+	SIMD_SEARCH_AVX2 static unsigned mask(Type const *p, __m256i key) {
+		return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(p)), key)));
+	}
+};
+
+template <typename Type>
+struct Simd_avx2<Type, 2, false> {
+	SIMD_SEARCH_AVX2 static __m256i broadcast(Type obj) { return _mm256_set1_epi16(static_cast<short>(obj)); }
+	SIMD_SEARCH_AVX2 static unsigned mask(Type const *p, __m256i key) {
+		return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(p)), key)));
+	}
+};
+
+template <typename Type>
+struct Simd_avx2<Type, 4, false> {
+	SIMD_SEARCH_AVX2 static __m256i broadcast(Type obj) { return _mm256_set1_epi32(static_cast<int>(obj)); }
+	SIMD_SEARCH_AVX2 static unsigned mask(Type const *p, __m256i key) {
+		return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(p)), key)));
+	}
+};
+
+template <typename Type>
+struct Simd_avx2<Type, 8, false> {
+	SIMD_SEARCH_AVX2 static __m256i broadcast(Type obj) { return _mm256_set1_epi64x(static_cast<long long>(obj)); }
+	SIMD_SEARCH_AVX2 static unsigned mask(Type const *p, __m256i key) {
+		return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi64(_mm256_loadu_si256(reinterpret_cast<__m256i const *>(p)), key)));
+	}
+};
+
+template <typename Type>
+struct Simd_avx2<Type, 4, true> {
+	SIMD_SEARCH_AVX2 static __m256 broadcast(Type obj) { return _mm256_set1_ps(obj); }
+	SIMD_SEARCH_AVX2 static unsigned mask(Type const *p, __m256 key) {
+		return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_castps_si256(_mm256_cmp_ps(_mm256_loadu_ps(p), key, _CMP_EQ_OQ))));
+	}
+};
+
+template <typename Type>
+struct Simd_avx2<Type, 8, true> {
+	SIMD_SEARCH_AVX2 static __m256d broadcast(Type obj) { return _mm256_set1_pd(obj); }
+	SIMD_SEARCH_AVX2 static unsigned mask(Type const *p, __m256d key) {
+		return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_castpd_si256(_mm256_cmp_pd(_mm256_loadu_pd(p), key, _CMP_EQ_OQ))));
+	}
+};
+
+// Checks CPUID once for AVX2
+inline bool simd_has_avx2() {
+	static bool const has_avx2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2") != 0);
+	return has_avx2;
+}
+
+template <typename Type>
+int simd_count_sse2(Type const *array, int n, Type const &obj) {
+	int const per_vector = 16 / sizeof(Type);
+	auto key = Simd_sse2<Type>::broadcast(obj);
+	int bytes = 0;
+	int i = 0;
+
+	for (; i + per_vector <= n; i += per_vector) {
+		bytes += __builtin_popcount(Simd_sse2<Type>::mask(array + i, key));
+	}
+
+	return bytes / static_cast<int>(sizeof(Type)) + simd_count_scalar(array + i, n - i, obj);
+}
+
+template <typename Type>
+int simd_find_sse2(Type const *array, int n, Type const &obj) {
+	int const per_vector = 16 / sizeof(Type);
+	auto key = Simd_sse2<Type>::broadcast(obj);
+	int i = 0;
+
+	for (; i + per_vector <= n; i += per_vector) {
+		unsigned mask = Simd_sse2<Type>::mask(array + i, key);
+		if (mask != 0)
+			return i + __builtin_ctz(mask) / static_cast<int>(sizeof(Type));
+	}
+
+	return i + simd_find_scalar(array + i, n - i, obj);
+}
+
+template <typename Type>
+SIMD_SEARCH_AVX2 int simd_count_avx2(Type const *array, int n, Type const &obj) {
+	int const per_vector = 32 / sizeof(Type);
+	auto key = Simd_avx2<Type>::broadcast(obj);
+	int bytes = 0;
+	int i = 0;
+
+	for (; i + per_vector <= n; i += per_vector) {
+		bytes += __builtin_popcount(Simd_avx2<Type>::mask(array + i, key));
+	}
+
+	return bytes / static_cast<int>(sizeof(Type)) + simd_count_scalar(array + i, n - i, obj);
+}
+
+template <typename Type>
+SIMD_SEARCH_AVX2 int simd_find_avx2(Type const *array, int n, Type const &obj) {
+	int const per_vector = 32 / sizeof(Type);
+	auto key = Simd_avx2<Type>::broadcast(obj);
+	int i = 0;
+
+	for (; i + per_vector <= n; i += per_vector) {
+		unsigned mask = Simd_avx2<Type>::mask(array + i, key);
+		if (mask != 0)
+			return i + __builtin_ctz(mask) / static_cast<int>(sizeof(Type));
+	}
+
+	return i + simd_find_scalar(array + i, n - i, obj);
+}
+
+#undef SIMD_SEARCH_AVX2
+
+template <typename Type>
+int simd_count_dispatch(Type const *array, int n, Type const &obj, std::true_type) {
+	return simd_has_avx2() ? simd_count_avx2(array, n, obj) : simd_count_sse2(array, n, obj);
+}
+
+template <typename Type>
+int simd_find_dispatch(Type const *array, int n, Type const &obj, std::true_type) {
+	return simd_has_avx2() ? simd_find_avx2(array, n, obj) : simd_find_sse2(array, n, obj);
+}
+
+#else
+
+template <typename Type>
+int simd_count_dispatch(Type const *array, int n, Type const &obj, std::true_type) {
+	return simd_count_scalar(array, n, obj);
+}
+
+template <typename Type>
+int simd_find_dispatch(Type const *array, int n, Type const &obj, std::true_type) {
+	return simd_find_scalar(array, n, obj);
+}
+
+#endif
+
+template <typename Type>
+int simd_count_dispatch(Type const *array, int n, Type const &obj, std::false_type) {
+	return simd_count_scalar(array, n, obj);
+}
+
+template <typename Type>
+int simd_find_dispatch(Type const *array, int n, Type const &obj, std::false_type) {
+	return simd_find_scalar(array, n, obj);
+}
+
+template <typename Type>
+int simd_count(Type const *array, int n, Type const &obj) {
+	return simd_count_dispatch(array, n, obj, std::integral_constant<bool, Simd_searchable<Type>::value>());
+}
+
+template <typename Type>
+int simd_find(Type const *array, int n, Type const &obj) {
+	return simd_find_dispatch(array, n, obj, std::integral_constant<bool, Simd_searchable<Type>::value>());
+}
+
+#endif
@@ -0,0 +1,34 @@
+/*
+* Thread_random
+*
+* A per-thread xorshift generator, for the concurrent containers that pick a
+* random shard, slot or victim so that threads spread out instead of
+* contending on the same one. It is cheap and needs no locking, but it is not
+* a source of good random numbers for anything else.
+*
+* unsigned thread_random()
+*   Returns the next number from the calling thread's generator. Each thread's
+*   generator is seeded from its thread id the first time it is called.
+*/
+
+#ifndef THREAD_RANDOM_H
+#define THREAD_RANDOM_H
+
+#include <functional>
+#include <thread>
+
+inline unsigned thread_random() {
+	static thread_local unsigned state = 0;
+
+	// Seed each thread differently the first time it asks for a number
+	if (state == 0) {
+		state = static_cast<unsigned>(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1u;
+	}
+
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+#endif
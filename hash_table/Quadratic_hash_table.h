@@ -34,7 +34,10 @@
 * bool member(Type const &) const
 *  Iterates through the hash table to determine if an element is in the hash table.
 *  Given that this is a quadratic hash table, it uses the concept of quadratic polling
-*  to find elements.
+*  to find elements. Polling stops at the first unoccupied bin: insert places each
+*  element in the first bin along its polling sequence that is not occupied, and bins
+*  only return to unoccupied when the whole table is cleared, so the element cannot
+*  lie beyond it. Erased bins are polled past.
 *
 * Type bin(int) const
 *  Returns the element at the given index.
@@ -46,12 +49,14 @@
 *   Takes an object passed as a parameter. Inserts the object as an element in the hash table.
 *   Uses the hash function to find an initial bin to place the element in, and subsequently uses
 *   quadratic polling if necessary to find the appropriate index for insertion.
+*   A single pass looks for a duplicate up to the first unoccupied bin, and places the
+*   object in the first erased bin it passed, or otherwise in that unoccupied bin.
 *
 * bool erase(Type const &)
 *   Attempts to erase a matching element in the hash table. If the element is found and removed, 
 *   the function returns true, otherwise it returns false.
 *   Uses the hash function to find an initial bin as a best guess, and then quadratic polling
-*   if necessary to find the element. If the object isn't in the hash table, this will run in order n time.
+*   if necessary to find the element, stopping at the first unoccupied bin as member does.
 *
 * Type clear()
 *    Pops the top node of the heap
@@ -61,6 +66,16 @@
 *    Clears the hash table by resetting all counter member variables, and setting the state of
 *    each index to unoccupied.
 *
+* ---------------------------------------------------------
+*                   Instrumentation (DS_ENABLE_STATS, see Ds_stats.h):
+*
+* Quadratic_hash_table_stats stats() const
+*   Returns a snapshot of the occupancy of the table (erased bins are the tombstones),
+*   the number of lookups, inserts and erases, and histograms of the bins polled by
+*   each lookup and each insert. Long polling sequences mean clustering, or erased
+*   bins building up: both member and insert poll past erased bins. Sampled latency
+*   histograms of member, insert and erase give the time those sequences cost.
+*
 *
 * References: Douglas Wilhelm Harder for the formatting of this comment block
 */
@@ -68,15 +83,39 @@
 #ifndef DOUBLE_HASH_TABLE_H
 #define DOUBLE_HASH_TABLE_H
 
-#ifndef nullptr
-#define nullptr 0
-#endif
-
 #include "Exception.h"
 #include "ece250.h"
+#include "Ds_stats.h"
 
 enum bin_state_t { UNOCCUPIED, OCCUPIED, ERASED };
 
+#ifdef DS_ENABLE_STATS
+struct Quadratic_hash_table_stats {
+	int size;
+	int capacity;
+	int tombstones;					// Bins marked ERASED
+	double tombstone_ratio;			// Tombstones as a fraction of the capacity
+	double load_factor;
+
+	long long lookups;				// Calls of member and erase
+	long long inserts;
+	long long erases;				// Erases that removed an element
+
+	Ds_histogram lookup_probes;
+	Ds_histogram insert_probes;
+
+	Ds_latency_histogram member_latency;
+	Ds_latency_histogram insert_latency;
+	Ds_latency_histogram erase_latency;
+
+	Quadratic_hash_table_stats() :
+	size(0), capacity(0), tombstones(0), tombstone_ratio(0.0), load_factor(0.0),
+	lookups(0), inserts(0), erases(0) {
+		// Empty constructor
+	}
+};
+#endif
+
 template <typename Type>
 class Quadratic_hash_table {
 private:
@@ -87,8 +126,12 @@ private:
 	int mask;                      // Mask: Size of the hash table less one (M-1)
 	Type *array;                   // Pointer to a circular array which holds the contents of the hash table.
 	bin_state_t *occupied;         // Enumerator list of bin states; unoccipued, occupied, erased
+#ifdef DS_ENABLE_STATS
+	mutable Quadratic_hash_table_stats statistics;	// The event counters; member() is const
+#endif
 
 	int hash(Type const &) const;
+	int find(Type const &) const;
 
 public:		
 	Quadratic_hash_table(int = 5);
@@ -99,6 +142,9 @@ public:
 	bool empty() const;
 	bool member(Type const &) const;
 	Type bin(int) const;
+#ifdef DS_ENABLE_STATS
+	Quadratic_hash_table_stats stats() const;
+#endif
 
 	void print() const;
 
@@ -114,7 +160,7 @@ public:
 
 template <typename Type>
 Quadratic_hash_table<Type>::Quadratic_hash_table(int m) :
-count(0), power(m),
+count(0), erasedcount(0), power(m),
 array_size(1 << power),
 mask(array_size - 1),
 array(new Type[array_size]),
@@ -171,18 +217,22 @@ bool Quadratic_hash_table<Type>::empty() const {
 	return (size() == 0);
 }
 
+// Returns the index of the occupied bin holding the object, or -1 if there is none
 template <typename Type>
-bool Quadratic_hash_table<Type>::member(Type const &input) const{
+int Quadratic_hash_table<Type>::find(Type const &input) const{
 	// Uses the hashing function to find a starting bin
 	int index = hash(input);
 	int i = 0;
 
-	// Iterate through the array
-	while (i < array_size){
+	// Iterate through the array, stopping at the first unoccupied bin
+	while (i < array_size && occupied[index] != UNOCCUPIED){
 		// If the index is occupied, its a candidate for a match
 		if (occupied[index] == OCCUPIED){
-			// If the value at the index is equivalent, return true
-			if(array[index] == input){ return true; }
+			// If the value at the index is equivalent, return the index
+			if(array[index] == input){
+				DS_STATS(statistics.lookup_probes.record(i + 1);)
+				return index;
+			}
 		}
 		// Iterate using quadradic polling, then take the modulo
 		// to utilize the circular nature of the array
@@ -191,11 +241,33 @@ bool Quadratic_hash_table<Type>::member(Type const &input) const{
 		// Handle the edge case where the modulo results in a negative
 		if (index < 0){ index += capacity(); }
 	}
-	// There were no matches found in the array, return false
-	return false;
 
+	// There were no matches found in the array
+	DS_STATS(statistics.lookup_probes.record(i + 1);)
+	return -1;
 }
 
+template <typename Type>
+bool Quadratic_hash_table<Type>::member(Type const &input) const{
+	DS_STATS(Ds_latency_timer timer(statistics.member_latency);)
+	DS_STATS(statistics.lookups++;)
+	return (find(input) >= 0);
+}
+
+#ifdef DS_ENABLE_STATS
+// Returns the event counters together with the current occupancy of the table
+template <typename Type>
+Quadratic_hash_table_stats Quadratic_hash_table<Type>::stats() const{
+	Quadratic_hash_table_stats snapshot = statistics;
+	snapshot.size = count;
+	snapshot.capacity = array_size;
+	snapshot.tombstones = erasedcount;
+	snapshot.tombstone_ratio = static_cast<double>(erasedcount) / array_size;
+	snapshot.load_factor = load_factor();
+	return snapshot;
+}
+#endif
+
 
 template <typename Type>
 Type Quadratic_hash_table<Type>::bin(int i) const{
@@ -214,52 +286,30 @@ void Quadratic_hash_table<Type>::insert(Type const &obj) {
 	// If table is full, throw overflow
 	// If the object is already in the table, do nothing
 	// Object can go into an empty bin, or deleted bin
+	DS_STATS(Ds_latency_timer timer(statistics.insert_latency);)
 	if (count == capacity()){ throw overflow(); }
+	DS_STATS(statistics.inserts++;)
 	int index = hash(obj);
 	int i = 0;
+	int target = -1;	// The first bin along the polling sequence that is not occupied
 
-	// Look to see if the entry is already in the array
+	// Look to see if the entry is already in the array. It cannot lie beyond the
+	// first unoccupied bin, which is also the last place the object could go
 	while (i < array_size){
-		if (array[index] == obj) {
-			// If the object was erased, fix the counters
-			if (occupied[index] == ERASED){
-				erasedcount--;
-				count++;
-			}
-			// If the object is in an unoccupied bin, fix the count
-			if (occupied[index] == UNOCCUPIED){
-				count++;
-			}
-			// In all cases, this bin will now be occupied with the object
-			occupied[index] = OCCUPIED;
-			return;
+		if (occupied[index] == UNOCCUPIED){
+			if (target < 0){ target = index; }
+			break;
 		}
-		// Iterate using quadradic polling, then take the modulo
-		// to utilize the circular nature of the array
-		index += ++i;
-		index = index % capacity();
-		if (index < 0){ index += capacity(); }
-	}
-	
-	// Reset index and count variables for second iteration
-	index = hash(obj);
-	i = 0;
-	
-	// We now know that the element isnt in the array
-	// We must find a corresponding spot to place the element
-	while (i < array_size){
-		// If the bin is unoccupied we have a place for it
-		if (occupied[index] != OCCUPIED){
-			// If the bin is erased, erasedcount must be updated
-			if (occupied[index] == ERASED){ 
-				erasedcount--;
+		if (occupied[index] == OCCUPIED){
+			// The object is already in the table: do nothing
+			if (array[index] == obj){
+				DS_STATS(statistics.insert_probes.record(i + 1);)
+				return;
 			}
-			// Update the bin with the object, and in all cases
-			// the bin should now be makred occupied.
-			array[index] = obj;
-			occupied[index] = OCCUPIED;
-			count++;
-			return;
+		}
+		// The first erased bin is the best place for the object, if it is new
+		else if (target < 0){
+			target = index;
 		}
 		// Iterate using quadradic polling, then take the modulo
 		// to utilize the circular nature of the array
@@ -267,35 +317,35 @@ void Quadratic_hash_table<Type>::insert(Type const &obj) {
 		index = index % capacity();
 		if (index < 0){ index += capacity(); }
 	}
+	DS_STATS(statistics.insert_probes.record(i + 1);)
+
+	// We now know that the element isnt in the array: place it in the bin found.
+	// Polling over a table of size 2^m visits every bin, and the table is not full,
+	// so there is always one. If the bin is erased, erasedcount must be updated
+	if (occupied[target] == ERASED){
+		erasedcount--;
+	}
+	array[target] = obj;
+	occupied[target] = OCCUPIED;
+	count++;
 }
 
 template <typename Type>
 bool Quadratic_hash_table<Type>::erase(Type const &obj){
-	int index = hash(obj);
-	int i = 0;
-
-	// Iterate through the list, examine all occupied bins
-	while (i < array_size){
-		if (occupied[index] == OCCUPIED){
-			// At each occupied bin, check if the contents match our object
-			if (array[index] == obj){
-				// If the contents match, the bin should be erased and counters updated
-				occupied[index] = ERASED;
-				erasedcount++;
-				count--;
-				// Since a match was found, return true
-				return true;
-			}
-		}
-		// Iterate using quadradic polling, then take the modulo
-		// to utilize the circular nature of the array
-		index += ++i;
-		index = index % capacity();
-		if (index < 0){ index += capacity(); }
-	}
-
-	// If we make it to this point no match was found in the entire hash table, return false
-	return false;
+	DS_STATS(Ds_latency_timer timer(statistics.erase_latency);)
+	DS_STATS(statistics.lookups++;)
+	int index = find(obj);
+
+	// If no match was found in the entire hash table, return false
+	if (index < 0){ return false; }
+
+	// If the contents match, the bin should be erased and counters updated
+	occupied[index] = ERASED;
+	erasedcount++;
+	count--;
+	DS_STATS(statistics.erases++;)
+	// Since a match was found, return true
+	return true;
 
 }
 
@@ -0,0 +1,298 @@
+/*
+* Calendar_queue
+*
+* This class implements a bucketed calendar queue (a timer wheel) for monotone
+* integer keys, with the same push/pop/top interface as Leftist_heap
+* (ordered as a min-heap).
+*
+* The key space is divided into days of a fixed width, and the days are mapped
+* round robin onto a fixed number of buckets, so one pass over the buckets
+* covers a year of bucket_count * width keys. A pop scans forward from the
+* bucket of the last key popped and takes the first bucket whose smallest key
+* falls within its day of the current year. Each bucket is kept sorted with its
+* smallest key at the back.
+*
+* When the width is close to the typical gap between pending keys, most pops
+* and pushes touch only one short bucket. Like Radix_heap, the queue is
+* monotone: keys smaller than the last key popped are rejected.
+*
+* ---------------------------------------------------------
+*                           Member Variables:
+*
+*  std::vector<std::vector<Type> > buckets
+*                                     The buckets of the calendar, each sorted in
+*                                     decreasing order
+*
+*  Key               day_width        The number of consecutive keys mapped to one bucket
+*
+*  Key               last_key         The key of the last element popped (or found at the top)
+*
+*  int               queue_size       The number of elements in the queue
+*
+* ---------------------------------------------------------
+*                   Member Functions (Accessors):
+*
+* bool empty() const
+* int size() const
+* Type const &top() const
+*   Returns a reference to the smallest element. Throws an underflow if the queue is empty.
+*
+* int count(Type const &) const
+*   Returns the number of elements equal to the argument, searching only its bucket.
+*
+* ---------------------------------------------------------
+*                   Member Functions (Mutators):
+*
+* void push(Type const &);
+*   Inserts the element into its bucket.
+*   Throws an illegal_argument if the element is smaller than the last key popped.
+*
+* Type pop();
+*   Removes and returns the smallest element. Throws an underflow if the queue is empty.
+*
+* void clear();
+*   Removes all of the elements and resets the last key to the smallest possible key.
+*
+* ---------------------------------------------------------
+*                   Instrumentation (DS_ENABLE_STATS, see Ds_stats.h):
+*
+* Calendar_queue_stats stats() const
+*   Returns a snapshot of the size of the queue, the number of pushes and pops, a
+*   histogram of the buckets each search for the top scanned, and the number of
+*   searches that found nothing due within a year and searched every bucket. Long
+*   scans mean the day width is too narrow; long buckets (a high mean_bucket) that
+*   it is too wide.
+*/
+
+#ifndef CALENDAR_QUEUE_H
+#define CALENDAR_QUEUE_H
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "ece250.h"
+#include "Exception.h"
+#include "Ds_stats.h"
+
+#ifdef DS_ENABLE_STATS
+// A snapshot of the counters of a Calendar_queue (see Ds_stats.h)
+struct Calendar_queue_stats {
+	int size;
+	int buckets;
+	double mean_bucket;				// The mean length of the non-empty buckets
+	long long pushes;
+	long long pops;
+	long long direct_searches;		// Searches that fell back to scanning every bucket
+	Ds_histogram days_scanned;		// Buckets visited by each search for the top
+
+	Calendar_queue_stats() :
+	size(0), buckets(0), mean_bucket(0.0), pushes(0), pops(0), direct_searches(0) {
+		// Empty constructor
+	}
+};
+#endif
+
+template <typename Type>
+class Calendar_queue {
+private:
+	static_assert(std::is_integral<Type>::value, "a calendar queue needs integer keys");
+
+	typedef typename std::make_unsigned<Type>::type Key;
+
+	// Member variables
+	mutable std::vector<std::vector<Type> > buckets;
+	Key day_width;
+	mutable Key last_key;
+	int queue_size;
+#ifdef DS_ENABLE_STATS
+	mutable Calendar_queue_stats statistics;	// Updated by find_top(), which top() calls
+#endif
+
+	static Key key(Type);
+	int bucket(Key) const;
+	int find_top() const;
+
+public:
+	// Constructors
+	Calendar_queue(int = 256, Type = 1);
+
+	// Supplementary functions
+	void swap(Calendar_queue &);
+	Calendar_queue &operator=(Calendar_queue);
+
+	// Accessors
+	bool empty() const;
+	int size() const;
+	Type const &top() const;
+	int count(Type const &) const;
+#ifdef DS_ENABLE_STATS
+	Calendar_queue_stats stats() const;
+#endif
+
+	// Mutators
+	void push(Type const &);
+	Type pop();
+	void clear();
+};
+
+template <typename Type>
+Calendar_queue<Type>::Calendar_queue(int n, Type width) :
+buckets(std::max(n, 1)),
+day_width(width < 1 ? Key(1) : static_cast<Key>(width)),
+last_key(0),
+queue_size(0) {
+	// does nothing
+}
+
+// Maps the element to an unsigned key with the same ordering:
+// signed values have their sign bit flipped
+template <typename Type>
+typename Calendar_queue<Type>::Key Calendar_queue<Type>::key(Type obj) {
+	Key k = static_cast<Key>(obj);
+	if (std::numeric_limits<Type>::is_signed) {
+		k ^= static_cast<Key>(Key(1) << (std::numeric_limits<Key>::digits - 1));
+	}
+	return k;
+}
+
+// Returns the bucket that the day of the key maps to
+template <typename Type>
+int Calendar_queue<Type>::bucket(Key k) const {
+	return static_cast<int>((k / day_width) % buckets.size());
+}
+
+template <typename Type>
+void Calendar_queue<Type>::swap(Calendar_queue<Type> &queue) {
+	buckets.swap(queue.buckets);
+	std::swap(day_width, queue.day_width);
+	std::swap(last_key, queue.last_key);
+	std::swap(queue_size, queue.queue_size);
+	DS_STATS(std::swap(statistics, queue.statistics);)
+}
+
+template <typename Type>
+Calendar_queue<Type> &Calendar_queue<Type>::operator=(Calendar_queue<Type> rhs) {
+	swap(rhs);
+
+	return *this;
+}
+
+// Accessor Functions
+template <typename Type>
+bool Calendar_queue<Type>::empty() const {
+	return queue_size == 0;
+}
+
+template <typename Type>
+int Calendar_queue<Type>::size() const {
+	return queue_size;
+}
+
+template <typename Type>
+Type const &Calendar_queue<Type>::top() const {
+	// If the queue is empty, throw an underflow
+	if (empty()) throw underflow();
+	return buckets[find_top()].back();
+}
+
+template <typename Type>
+int Calendar_queue<Type>::count(Type const &obj) const {
+	std::vector<Type> const &b = buckets[bucket(key(obj))];
+	return static_cast<int>(std::count(b.begin(), b.end(), obj));
+}
+
+#ifdef DS_ENABLE_STATS
+// Returns the event counters together with the current size and bucket lengths
+template <typename Type>
+Calendar_queue_stats Calendar_queue<Type>::stats() const {
+	Calendar_queue_stats snapshot = statistics;
+	snapshot.size = queue_size;
+	snapshot.buckets = static_cast<int>(buckets.size());
+
+	int used = 0;
+	for (typename std::vector<std::vector<Type> >::const_iterator it = buckets.begin(); it != buckets.end(); ++it) {
+		if (!it->empty()) used++;
+	}
+	snapshot.mean_bucket = (used == 0) ? 0.0 : static_cast<double>(queue_size) / used;
+	return snapshot;
+}
+#endif
+
+// Returns the bucket holding the smallest element and advances last_key to it
+template <typename Type>
+int Calendar_queue<Type>::find_top() const {
+	int const n = static_cast<int>(buckets.size());
+	Key day = last_key / day_width;
+	int start = bucket(last_key);
+
+	// Walk one year of days starting with today: the first bucket whose
+	// smallest element falls on the day being visited holds the top
+	for (int i = 0; i < n; ++i) {
+		int b = (start + i) % n;
+		if (buckets[b].empty()) continue;
+
+		// No key is below last_key, so due is never before today; comparing the
+		// days between them, rather than day + i, cannot wrap near the largest key
+		Key due = key(buckets[b].back()) / day_width;
+		if (static_cast<unsigned long long>(due - day) <= static_cast<unsigned long long>(i)) {
+			last_key = key(buckets[b].back());
+			DS_STATS(statistics.days_scanned.record(i + 1);)
+			return b;
+		}
+	}
+
+	// Nothing is due within a year: fall back to a direct search of the buckets
+	int best = -1;
+	for (int b = 0; b < n; ++b) {
+		if (!buckets[b].empty() && (best < 0 || key(buckets[b].back()) < key(buckets[best].back()))) {
+			best = b;
+		}
+	}
+
+	last_key = key(buckets[best].back());
+	DS_STATS(statistics.direct_searches++; statistics.days_scanned.record(n);)
+	return best;
+}
+
+// Mutators
+template <typename Type>
+void Calendar_queue<Type>::push(Type const &obj) {
+	Key k = key(obj);
+
+	// The queue is monotone: nothing smaller than the last key may be pushed
+	if (k < last_key) throw illegal_argument();
+
+	// Keep the bucket in decreasing order so that its smallest element is at the back
+	std::vector<Type> &b = buckets[bucket(k)];
+	b.insert(std::upper_bound(b.begin(), b.end(), obj, std::greater<Type>()), obj);
+	queue_size++;
+	DS_STATS(statistics.pushes++;)
+}
+
+template <typename Type>
+Type Calendar_queue<Type>::pop() {
+	// The queue is empty: throw an underflow exception
+	if (empty()) throw underflow();
+
+	std::vector<Type> &b = buckets[find_top()];
+	Type returnval = b.back();
+	b.pop_back();
+	queue_size--;
+	DS_STATS(statistics.pops++;)
+
+	return returnval;
+}
+
+template <typename Type>
+void Calendar_queue<Type>::clear() {
+	for (typename std::vector<std::vector<Type> >::iterator it = buckets.begin(); it != buckets.end(); ++it) {
+		it->clear();
+	}
+	last_key = 0;
+	queue_size = 0;
+}
+
+#endif
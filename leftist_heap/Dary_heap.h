@@ -0,0 +1,351 @@
+/*
+* Dary_heap
+*
+* This class implements an implicit d-ary heap with the same public interface
+* as Leftist_heap. The elements are stored contiguously in an array, and the
+* children of the element at index i are found at indices D*i + 1 through D*i + D,
+* so a sift down reads one run of D neighbouring elements per level instead of
+* following a pointer to a separately allocated node.
+*
+* Use Dary_heap for pure push/pop workloads. Leftist_heap remains the better
+* choice when whole heaps must be merged, since a d-ary heap cannot meld two
+* heaps faster than pushing every element of one onto the other.
+*
+* ---------------------------------------------------------
+*                           Member Variables:
+*
+*  std::vector<Type> array            The elements of the heap in level order.
+*                                     The top of the heap is at index 0.
+*
+*  Compare           compare          The ordering of the heap: compare(a, b) == true means
+*                                     that a belongs closer to the top than b. As with
+*                                     Leftist_heap, std::less gives a min-heap.
+*
+*  D (template)                       The number of children of each element. The default
+*                                     fits one group of children in a cache line: 8 for
+*                                     elements of up to 8 bytes, 4 otherwise.
+*
+* ---------------------------------------------------------
+*                   Member Functions (Accessors):
+*
+* bool empty() const
+*   Returns true if the heap is empty, otherwise false.
+*
+* int size() const
+*   Returns the number of elements in the heap.
+*
+* Type const &top() const
+*   Returns a reference to the element at the top of the heap.
+*   Throws an underflow if the heap is empty.
+*
+* int count(Type const &) const
+*   Returns the number of elements in the heap equal to the argument.
+*
+* ---------------------------------------------------------
+*                   Member Functions (Mutators):
+*
+* void push(Type const &);
+* void push(Type &&);
+* void emplace(Args &&...);
+*   Appends the element to the array and sifts it up to its place.
+*
+* Type pop();
+*   Removes the top of the heap and returns it, moved out of the array.
+*   Throws an underflow if the heap is empty.
+*
+* void reserve(int);
+*   Allocates room for at least the given number of elements.
+*
+* void clear();
+*   Removes all of the elements from the heap.
+*
+* ---------------------------------------------------------
+*                   Instrumentation (DS_ENABLE_STATS, see Ds_stats.h):
+*
+* Dary_heap_stats stats() const
+*   Returns a snapshot of the size of the heap, the number of pushes and pops,
+*   histograms of the levels each sift up and sift down moved an element, and
+*   sampled push and pop latencies. Sift downs of about log_D(n) levels are
+*   expected; short sift ups mean the keys are pushed in nearly sorted order.
+*/
+
+#ifndef DARY_HEAP_H
+#define DARY_HEAP_H
+
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "ece250.h"
+#include "Exception.h"
+#include "Simd_search.h"
+#include "Ds_stats.h"
+
+#ifdef DS_ENABLE_STATS
+// A snapshot of the counters of a Dary_heap (see Ds_stats.h)
+struct Dary_heap_stats {
+	int size;
+	long long pushes;
+	long long pops;
+	Ds_histogram sift_up_levels;
+	Ds_histogram sift_down_levels;
+	Ds_latency_histogram push_latency;
+	Ds_latency_histogram pop_latency;
+
+	Dary_heap_stats() :
+	size(0), pushes(0), pops(0) {
+		// Empty constructor
+	}
+};
+#endif
+
+template <typename Type>
+struct Dary_heap_default_arity {
+	static int const value = (sizeof(Type) <= 8) ? 8 : 4;
+};
+
+// Finds the index of the best of n contiguous children
+template <typename Type, typename Compare, bool = std::is_arithmetic<Type>::value>
+struct Dary_heap_select {
+	static int best(Type const *first, int n, Compare const &compare) {
+		int best = 0;
+		for (int i = 1; i < n; ++i) {
+			if (compare(first[i], first[best])) best = i;
+		}
+		return best;
+	}
+};
+
+// For arithmetic types the running best is kept in a register and both the value
+// and the index are updated with selects rather than branches, which the compiler
+// lowers to conditional moves or vector min/blend instructions once the loop over
+// a full group of D children is unrolled.
+template <typename Type, typename Compare>
+struct Dary_heap_select<Type, Compare, true> {
+	static int best(Type const *first, int n, Compare const &compare) {
+		Type value = first[0];
+		int best = 0;
+		for (int i = 1; i < n; ++i) {
+			bool better = compare(first[i], value);
+			value = better ? first[i] : value;
+			best = better ? i : best;
+		}
+		return best;
+	}
+};
+
+template <typename Type, int D = Dary_heap_default_arity<Type>::value, typename Compare = std::less<Type> >
+class Dary_heap {
+private:
+	static_assert(D >= 2, "a d-ary heap needs at least two children per element");
+
+	// Member variables
+	std::vector<Type> array;
+	Compare compare;
+#ifdef DS_ENABLE_STATS
+	Dary_heap_stats statistics;
+#endif
+
+	void sift_up(int);
+	void sift_down(int);
+
+public:
+	// Constructors
+	Dary_heap(Compare const & = Compare());
+
+	// Supplementary functions
+	void swap(Dary_heap &);
+	Dary_heap &operator=(Dary_heap);
+
+	// Accessors
+	bool empty() const;
+	int size() const;
+	Type const &top() const;
+	int count(Type const &) const;
+#ifdef DS_ENABLE_STATS
+	Dary_heap_stats stats() const;
+#endif
+
+	// Mutators
+	void push(Type const &);
+	void push(Type &&);
+	template <typename... Args>
+	void emplace(Args &&...);
+	Type pop();
+	void reserve(int);
+	void clear();
+
+	// Friends
+
+	template <typename T, int N, typename C>
+	friend std::ostream &operator<<(std::ostream &, Dary_heap<T, N, C> const &);
+};
+
+template <typename Type, int D, typename Compare>
+Dary_heap<Type, D, Compare>::Dary_heap(Compare const &comp) :
+array(),
+compare(comp) {
+	// does nothing
+}
+
+template <typename Type, int D, typename Compare>
+void Dary_heap<Type, D, Compare>::swap(Dary_heap<Type, D, Compare> &heap) {
+	array.swap(heap.array);
+	std::swap(compare, heap.compare);
+	DS_STATS(std::swap(statistics, heap.statistics);)
+}
+
+template <typename Type, int D, typename Compare>
+Dary_heap<Type, D, Compare> &Dary_heap<Type, D, Compare>::operator=(Dary_heap<Type, D, Compare> rhs) {
+	swap(rhs);
+
+	return *this;
+}
+
+// Accessor Functions
+template <typename Type, int D, typename Compare>
+bool Dary_heap<Type, D, Compare>::empty() const {
+	return array.empty();
+}
+
+template <typename Type, int D, typename Compare>
+int Dary_heap<Type, D, Compare>::size() const {
+	return static_cast<int>(array.size());
+}
+
+template <typename Type, int D, typename Compare>
+Type const &Dary_heap<Type, D, Compare>::top() const {
+	// If the heap is empty, throw an underflow
+	if (empty()) throw underflow();
+	return array[0];
+}
+
+template <typename Type, int D, typename Compare>
+int Dary_heap<Type, D, Compare>::count(Type const &obj) const {
+	// The elements are contiguous, so a linear scan touches each cache line once,
+	// and arithmetic elements are compared a vector at a time
+	return simd_count(array.data(), static_cast<int>(array.size()), obj);
+}
+
+#ifdef DS_ENABLE_STATS
+// Returns the event counters together with the current size
+template <typename Type, int D, typename Compare>
+Dary_heap_stats Dary_heap<Type, D, Compare>::stats() const {
+	Dary_heap_stats snapshot = statistics;
+	snapshot.size = size();
+	return snapshot;
+}
+#endif
+
+// Mutators
+template <typename Type, int D, typename Compare>
+void Dary_heap<Type, D, Compare>::push(Type const &obj) {
+	DS_STATS(Ds_latency_timer timer(statistics.push_latency);)
+	array.push_back(obj);
+	sift_up(size() - 1);
+	DS_STATS(statistics.pushes++;)
+}
+
+template <typename Type, int D, typename Compare>
+void Dary_heap<Type, D, Compare>::push(Type &&obj) {
+	DS_STATS(Ds_latency_timer timer(statistics.push_latency);)
+	array.push_back(std::move(obj));
+	sift_up(size() - 1);
+	DS_STATS(statistics.pushes++;)
+}
+
+template <typename Type, int D, typename Compare>
+template <typename... Args>
+void Dary_heap<Type, D, Compare>::emplace(Args &&...args) {
+	DS_STATS(Ds_latency_timer timer(statistics.push_latency);)
+	array.emplace_back(std::forward<Args>(args)...);
+	sift_up(size() - 1);
+	DS_STATS(statistics.pushes++;)
+}
+
+template <typename Type, int D, typename Compare>
+Type Dary_heap<Type, D, Compare>::pop() {
+	// The heap is empty: throw an underflow exception
+	if (empty()) throw underflow();
+
+	DS_STATS(Ds_latency_timer timer(statistics.pop_latency);)
+	Type returnval(std::move(array[0]));
+
+	// Move the last element into the hole at the top and sift it down
+	if (size() > 1) {
+		array[0] = std::move(array.back());
+		array.pop_back();
+		sift_down(0);
+	}
+	else {
+		array.pop_back();
+	}
+	DS_STATS(statistics.pops++;)
+
+	return returnval;
+}
+
+template <typename Type, int D, typename Compare>
+void Dary_heap<Type, D, Compare>::reserve(int n) {
+	array.reserve(std::max(n, 0));
+}
+
+template <typename Type, int D, typename Compare>
+void Dary_heap<Type, D, Compare>::clear() {
+	array.clear();
+}
+
+// Moves the element at the given index up towards the top,
+// shifting each parent it passes down into the hole it leaves
+template <typename Type, int D, typename Compare>
+void Dary_heap<Type, D, Compare>::sift_up(int index) {
+	Type obj(std::move(array[index]));
+	DS_STATS(int levels = 0;)
+
+	while (index > 0) {
+		int parent = (index - 1) / D;
+		if (!compare(obj, array[parent])) break;
+		array[index] = std::move(array[parent]);
+		index = parent;
+		DS_STATS(levels++;)
+	}
+
+	array[index] = std::move(obj);
+	DS_STATS(statistics.sift_up_levels.record(levels);)
+}
+
+// Moves the element at the given index down towards the leaves,
+// shifting the best child of each level up into the hole
+template <typename Type, int D, typename Compare>
+void Dary_heap<Type, D, Compare>::sift_down(int index) {
+	int const n = size();
+	Type obj(std::move(array[index]));
+	DS_STATS(int levels = 0;)
+
+	while (true) {
+		int first = D * index + 1;
+		if (first >= n) break;
+
+		int child = first + Dary_heap_select<Type, Compare>::best(&array[first], std::min(D, n - first), compare);
+		if (!compare(array[child], obj)) break;
+
+		array[index] = std::move(array[child]);
+		index = child;
+		DS_STATS(levels++;)
+	}
+
+	array[index] = std::move(obj);
+	DS_STATS(statistics.sift_down_levels.record(levels);)
+}
+
+template <typename T, int N, typename C>
+std::ostream &operator<<(std::ostream &out, Dary_heap<T, N, C> const &heap) {
+	for (int i = 0; i < heap.size(); ++i) {
+		out << heap.array[i] << ' ';
+	}
+
+	return out;
+}
+
+#endif
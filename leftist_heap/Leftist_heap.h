@@ -7,12 +7,17 @@
 * ---------------------------------------------------------
 *                           Member Variables:
 *
-*  Leftist_node<Type> *root_node     This variable is a pointer to the root node of the heap
+*  Leftist_node<Type, Compare> *root_node
+*                                    This variable is a pointer to the root node of the heap
 *						             If the heap is empty, this variable should have value nullptr
 *
 *  int                heap_size      This variable contains the size of the heap
 *                                    Restrictions: can never be negative
 *
+*  Compare            compare        The ordering of the heap: compare(a, b) == true means that
+*                                    a belongs closer to the root than b. The default, std::less,
+*                                    gives a min-heap; std::greater<Type> gives a max-heap.
+*
 * ---------------------------------------------------------
 *                   Member Functions (Accessors):
 *
@@ -26,31 +31,61 @@
 * int null_path_length() const
 *   Returns the null path length of the heap 
 *
-* Type top() const
-*   Returns the root node, or top, of the heap using member variable root_node.
+* Type const &top() const
+*   Returns a reference to the element at the root node, or top, of the heap
+*   using member variable root_node. No copy of the element is made.
 *    
 * int count(Type const &) const
 *   Takes in a variable of type Type and looks for total matches in the heap.
 *   The total number of matches is returned as an integer.
+*   Sub trees whose root already lies beyond the object are not visited.
+*
+* std::vector<int> count_many(std::vector<Type> const &) const
+*   Counts the matches of every object in the argument with a single pruned
+*   traversal of the heap. The i-th entry of the result is the count of the
+*   i-th object.
 *
 * ---------------------------------------------------------
 *                   Member Functions (Mutators):
 *
-* void postorder_push(Leftist_node<Type>*);
+* void postorder_push(Leftist_node<Type, Compare>*);
 *    Acts as a helper method of the copy constructor.
 *    Takes in a node, and does a post order traversal starting at that node.
 *    Each node in the traversal is pushed onto the heap using the push mutator function
 * 
 * void push(Type const &);
-*    Pushes the object passed onto the heap
+* void push(Type &&);
+*    Pushes the object passed onto the heap, copying or moving it into a new node
+*
+* void emplace(Args &&...);
+*    Constructs a new element in place from the arguments and pushes it onto the heap
+*
+* void meld(Leftist_heap &);
+*    Moves every element of the heap passed into this heap by merging the two trees,
+*    which only walks their right paths, and leaves the heap passed empty
 *
 * Type pop();
 *    Pops the top node of the heap
-*    Returns the element in that node.
+*    Returns the element in that node, moved out of the node rather than copied.
+*
+* int erase(Type const &);
+*    Lazily deletes one element equal to the object passed: its node is only marked
+*    as erased, and is removed when a later merge (push or pop) passes over it.
+*    Returns 1 if a match was erased, otherwise 0.
 *
 * void clear();
 *    Clears the heap, resets the size of the heap, and sets the root node to a nullptr
 *
+* ---------------------------------------------------------
+*                   Instrumentation (DS_ENABLE_STATS, see Ds_stats.h):
+*
+* Leftist_heap_stats stats() const
+*    Returns a snapshot of the size and null path length of the heap, the number of
+*    pushes, pops and erases, and a histogram of push_depth: the calls of
+*    Leftist_node::push made by each merge of a push or pop. A leftist heap keeps
+*    this logarithmic; a growing mean points at erased nodes piling up on the right.
+*    Sampled latency histograms of push (and emplace) and pop give the time it costs.
+*
 *
 * References: Douglas Wilhelm Harder for the formatting of this comment block
 */
@@ -58,22 +93,47 @@
 #ifndef LEFTIST_HEAP_H
 #define LEFTIST_HEAP_H
 
-#ifndef nullptr
-#define nullptr 0
-#endif
-
+#include <algorithm>
+#include <functional>
+#include <utility>
+#include <vector>
 #include "Leftist_node.h"
+#include "Ds_stats.h"
+
+#ifdef DS_ENABLE_STATS
+struct Leftist_heap_stats {
+	int size;
+	int null_path_length;
+	long long pushes;
+	long long pops;
+	long long erases;
+	Ds_histogram push_depth;
+	Ds_latency_histogram push_latency;
+	Ds_latency_histogram pop_latency;
+
+	Leftist_heap_stats() :
+	size(0), null_path_length(-1), pushes(0), pops(0), erases(0) {
+		// Empty constructor
+	}
+};
+#endif
 
-template <typename Type>
+template <typename Type, typename Compare = std::less<Type> >
 class Leftist_heap {
 private:
 	// Member variables
-	Leftist_node<Type> *root_node;
+	Leftist_node<Type, Compare> *root_node;
 	int heap_size;
+	Compare compare;
+#ifdef DS_ENABLE_STATS
+	Leftist_heap_stats statistics;
+#endif
+
+	void merge(Leftist_node<Type, Compare> *);
 
 public:
 	// Constructors/Destructor
-	Leftist_heap();
+	Leftist_heap(Compare const & = Compare());
 	Leftist_heap(Leftist_heap const &);
 	~Leftist_heap();
 
@@ -85,138 +145,247 @@ public:
 	bool empty() const;
 	int size() const;
 	int null_path_length() const;
-	Type top() const;
+	Type const &top() const;
 	int count(Type const &) const;
+	std::vector<int> count_many(std::vector<Type> const &) const;
+#ifdef DS_ENABLE_STATS
+	Leftist_heap_stats stats() const;
+#endif
 
 	// Mutators
-	void postorder_push(Leftist_node<Type>*);
+	void postorder_push(Leftist_node<Type, Compare>*);
 	void push(Type const &);
+	void push(Type &&);
+	template <typename... Args>
+	void emplace(Args &&...);
+	void meld(Leftist_heap &);
 	Type pop();
+	int erase(Type const &);
 	void clear();
 
 	// Friends
 
-	template <typename T>
-	friend std::ostream &operator<<(std::ostream &, Leftist_heap<T> const &);
+	template <typename T, typename C>
+	friend std::ostream &operator<<(std::ostream &, Leftist_heap<T, C> const &);
 };
 
-template <typename Type>
-Leftist_heap<Type>::Leftist_heap() :
+template <typename Type, typename Compare>
+Leftist_heap<Type, Compare>::Leftist_heap(Compare const &comp) :
 root_node(nullptr),
-heap_size(0) {
+heap_size(0),
+compare(comp) {
 	// does nothing
 }
 
-template <typename Type>
-Leftist_heap<Type>::Leftist_heap(Leftist_heap const &heap) :
+template <typename Type, typename Compare>
+Leftist_heap<Type, Compare>::Leftist_heap(Leftist_heap const &heap) :
 root_node(nullptr),
-heap_size(0) {
+heap_size(0),
+compare(heap.compare) {
 	// If the heap is empty, we need not copy any elements over
 	if (heap.empty()) return;
 	postorder_push(heap.root_node);
 }
 
-template <typename Type>
-void Leftist_heap<Type>::postorder_push(Leftist_node<Type>* node) {
+template <typename Type, typename Compare>
+void Leftist_heap<Type, Compare>::postorder_push(Leftist_node<Type, Compare>* node) {
 	// Complete a depth first post order order traverse recursively
 	if (node->left() != nullptr) postorder_push(node->left());
 	if (node->right() != nullptr) postorder_push(node->right());
-	// Push the element at the node onto the heap
-	push(node->retrieve());
+	// Push the element at the node onto the heap, unless it was erased
+	if (!node->erased) push(node->retrieve());
 }
 
-template <typename Type>
-Leftist_heap<Type>::~Leftist_heap() {
+template <typename Type, typename Compare>
+Leftist_heap<Type, Compare>::~Leftist_heap() {
 	clear();  // might as well use it...
 }
 
-template <typename Type>
-void Leftist_heap<Type>::swap(Leftist_heap<Type> &heap) {
+template <typename Type, typename Compare>
+void Leftist_heap<Type, Compare>::swap(Leftist_heap<Type, Compare> &heap) {
 	// Swaps the root node and heap size of the current instance
 	// with the heap passed as an argument
 	std::swap(root_node, heap.root_node);
 	std::swap(heap_size, heap.heap_size);
+	std::swap(compare, heap.compare);
+	DS_STATS(std::swap(statistics, heap.statistics);)
 }
 
-template <typename Type>
-Leftist_heap<Type> &Leftist_heap<Type>::operator=(Leftist_heap<Type> rhs) {
+template <typename Type, typename Compare>
+Leftist_heap<Type, Compare> &Leftist_heap<Type, Compare>::operator=(Leftist_heap<Type, Compare> rhs) {
 	swap(rhs);
 
 	return *this;
 }
 
 // Accessor Functions
-template <typename Type>
-bool Leftist_heap <Type>::empty() const{
+template <typename Type, typename Compare>
+bool Leftist_heap<Type, Compare>::empty() const{
 	return heap_size == 0;
 }
 
-template <typename Type>
-int Leftist_heap<Type>::size() const{
+template <typename Type, typename Compare>
+int Leftist_heap<Type, Compare>::size() const{
 	return heap_size;
 }
 
-template <typename Type>
-int Leftist_heap<Type>::null_path_length() const{
-	return root_node->null_path_length();
+template <typename Type, typename Compare>
+int Leftist_heap<Type, Compare>::null_path_length() const{
+	return Leftist_node<Type, Compare>::npl(root_node);
 }
 
-template <typename Type>
-Type Leftist_heap<Type>::top() const{
+template <typename Type, typename Compare>
+Type const &Leftist_heap<Type, Compare>::top() const{
 	// If the stack is empty, throw an underflow
 	if (empty()) throw underflow();
 	// Otherwise, return the element at the root node
 	return root_node->retrieve();
 }
 
-template <typename Type>
-int Leftist_heap<Type>::count(Type const &obj) const {
+template <typename Type, typename Compare>
+int Leftist_heap<Type, Compare>::count(Type const &obj) const {
 	// Count the instances of the object within the heap
 	// Call the count() method of the Leftist_node class
 	// as it will begin the conting, traversing downwards from the root node
-	return root_node->count(obj);
+	if (root_node == nullptr) return 0;
+	return root_node->count(obj, compare);
+}
+
+template <typename Type, typename Compare>
+std::vector<int> Leftist_heap<Type, Compare>::count_many(std::vector<Type> const &objs) const {
+	int n = static_cast<int>(objs.size());
+	std::vector<int> result(n, 0);
+	if (root_node == nullptr || n == 0) return result;
+
+	// Sort the queries by the heap order, remembering where each one came from
+	std::vector<int> order(n);
+	for (int i = 0; i < n; ++i) order[i] = i;
+	Compare const &comp = compare;
+	std::sort(order.begin(), order.end(), [&objs, &comp](int a, int b) { return comp(objs[a], objs[b]); });
+
+	std::vector<Type> sorted;
+	sorted.reserve(n);
+	for (int i = 0; i < n; ++i) sorted.push_back(objs[order[i]]);
+
+	// A single traversal from the root tallies the matches of every query
+	std::vector<int> tallies(n, 0);
+	root_node->count_many(sorted.data(), 0, n, tallies.data(), compare);
+
+	for (int i = 0; i < n; ++i) result[order[i]] = tallies[i];
+	return result;
+}
+
+#ifdef DS_ENABLE_STATS
+// Returns the event counters together with the current shape of the heap
+template <typename Type, typename Compare>
+Leftist_heap_stats Leftist_heap<Type, Compare>::stats() const {
+	Leftist_heap_stats snapshot = statistics;
+	snapshot.size = heap_size;
+	snapshot.null_path_length = null_path_length();
+	return snapshot;
+}
+#endif
+
+// Merges a tree into the heap, recording how deep the merge recursed
+template <typename Type, typename Compare>
+void Leftist_heap<Type, Compare>::merge(Leftist_node<Type, Compare> *tree) {
+	DS_STATS(int calls = Leftist_node<Type, Compare>::push_calls();)
+	Leftist_node<Type, Compare>::push(tree, root_node, compare);
+	DS_STATS(statistics.push_depth.record(Leftist_node<Type, Compare>::push_calls() - calls);)
 }
 
 // Mutators
-template <typename Type>
-void Leftist_heap<Type>::push(Type const &obj) {
-	root_node->push(new Leftist_node<Type>(obj), root_node);
+template <typename Type, typename Compare>
+void Leftist_heap<Type, Compare>::push(Type const &obj) {
+	DS_STATS(Ds_latency_timer timer(statistics.push_latency);)
+	merge(new Leftist_node<Type, Compare>(obj));
+	heap_size++;
+	DS_STATS(statistics.pushes++;)
+}
+
+template <typename Type, typename Compare>
+void Leftist_heap<Type, Compare>::push(Type &&obj) {
+	DS_STATS(Ds_latency_timer timer(statistics.push_latency);)
+	merge(new Leftist_node<Type, Compare>(std::move(obj)));
+	heap_size++;
+	DS_STATS(statistics.pushes++;)
+}
+
+// Constructs the element directly inside its new node
+template <typename Type, typename Compare>
+template <typename... Args>
+void Leftist_heap<Type, Compare>::emplace(Args &&...args) {
+	DS_STATS(Ds_latency_timer timer(statistics.push_latency);)
+	merge(new Leftist_node<Type, Compare>(std::forward<Args>(args)...));
 	heap_size++;
+	DS_STATS(statistics.pushes++;)
 }
 
-template <typename Type>
-Type Leftist_heap<Type>::pop() {
+template <typename Type, typename Compare>
+void Leftist_heap<Type, Compare>::meld(Leftist_heap<Type, Compare> &heap) {
+	// Melding a heap with itself would link its tree into itself
+	if (&heap == this || heap.root_node == nullptr) return;
+
+	// Take over the whole tree of the other heap, leaving it empty
+	merge(heap.root_node);
+	heap_size += heap.heap_size;
+
+	heap.root_node = nullptr;
+	heap.heap_size = 0;
+}
+
+template <typename Type, typename Compare>
+Type Leftist_heap<Type, Compare>::pop() {
+	DS_STATS(Ds_latency_timer timer(statistics.pop_latency);)
 	// The tree is empty: throw an underflow exception
 	if (empty()) { throw underflow(); };
 
 	// Grab the current root node
-	Leftist_node<Type> *temp = root_node;
+	Leftist_node<Type, Compare> *temp = root_node;
 
 	// Make the left tree the new root node, and push the right tree onto the new root
 	root_node = root_node->left();
-	root_node->push(temp->right(), root_node);
+	merge(temp->right());
 
-	// Cleanup: get the return value, and then delete the popped node
-	Type returnval = temp->retrieve();
+	// Cleanup: move the return value out, and then delete the popped node
+	Type returnval(std::move(temp->element));
 	delete temp;
 	temp = nullptr;
 
 	heap_size--;
+	DS_STATS(statistics.pops++;)
 	return returnval;
 
 }
 
-template <typename Type>
-void Leftist_heap<Type>::clear(){
-	// Clear the root node using the clear() function of Leftist_node
-	root_node->clear();
-	// Cleanup: set the root node to a nullptr and change the heap size to 0 (empty)
-	root_node = nullptr;
+template <typename Type, typename Compare>
+int Leftist_heap<Type, Compare>::erase(Type const &obj) {
+	if (root_node == nullptr) return 0;
+
+	// Find a matching node that has not already been erased
+	Leftist_node<Type, Compare> *node = root_node->find(obj, compare);
+	if (node == nullptr) return 0;
+
+	// Mark the node; it stays in the tree until a merge passes over it
+	node->erased = true;
+	heap_size--;
+	DS_STATS(statistics.erases++;)
+
+	// The root must always hold a live element for top()
+	Leftist_node<Type, Compare>::purge(root_node, compare);
+	return 1;
+}
+
+template <typename Type, typename Compare>
+void Leftist_heap<Type, Compare>::clear(){
+	// Clear the tree using the clear() function of Leftist_node, which sets the root node to a nullptr
+	Leftist_node<Type, Compare>::clear(root_node);
+	// Cleanup: change the heap size to 0 (empty)
 	heap_size = 0;
 }
 
-template <typename T>
-std::ostream &operator<<(std::ostream &out, Leftist_heap<T> const &heap) {
+template <typename T, typename C>
+std::ostream &operator<<(std::ostream &out, Leftist_heap<T, C> const &heap) {
 	return out;
 }
 
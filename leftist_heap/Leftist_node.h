@@ -18,27 +18,47 @@
 *  int heap_null_path_length         Stores the null path length of the node
 *                                    This element is always >= 0
 *
+*  bool erased                       True if the element has been lazily deleted.
+*                                    Erased nodes keep their place in the tree until
+*                                    a later merge passes over them and purges them.
+*
 * ---------------------------------------------------------
 *                   Member Functions (Accessors):
 *
-* Type retrieve() const;
-*   Retrieves the element member variable
-* bool empty() const;
-*   Returns true if the node is a nullptr
+* Type const &retrieve() const;
+*   Retrieves a reference to the element member variable
 *
 * Leftist_node *left() const;
 *   Returns a pointer to the left sub tree of the node
 * Leftist_node *right() const;
 *   Returns a pointer to the right sub tree of the node
 *
-* int count(Type const &) const;
+* int count(Type const &, Compare const &) const;
 *   Searches through the current node and its sub trees
 *   to find the total matches between the passed object and
-*   the member variable, element.
+*   the member variable, element. Erased nodes are not counted.
+*   Since no descendant belongs above its ancestor, a sub tree whose
+*   root lies beyond the passed object (compare(obj, element) == true)
+*   cannot contain a match and is skipped entirely.
+*
+* void count_many(Type const *, int, int, int *, Compare const &) const;
+*   Counts the matches of several queries in one traversal. The queries must be
+*   sorted by the comparator; the matches of queries[i] are added to tallies[i].
+*   Each node narrows the range of queries passed to its sub trees to those that
+*   do not lie before its own element.
+*
+* Leftist_node *find(Type const &, Compare const &);
+*   Returns a node holding an element equal to the passed object that has not been
+*   erased, or nullptr if there is none. Uses the same pruning as count.
 *
 * int null_path_length() const;
 *   Returns the null path length of the current node
 *
+* static int npl(Leftist_node const *);
+*   Returns the null path length of the tree in the argument, or -1 if it is nullptr.
+*   Every function that may be handed an empty tree is static and takes the
+*   tree as an argument, so no member function is ever called through nullptr.
+*
 * void inorder_traversal(Leftist_node *) const;
 *   Testing function, completes an inorder traversal
 *   and prints the element member variable for each node
@@ -46,13 +66,25 @@
 * ---------------------------------------------------------
 *                   Member Functions (Mutators):
 *	
-* void push(Leftist_node *, Leftist_node *&);
+* static void push(Leftist_node *, Leftist_node *&, Compare const &);
 *   Push the tree in argument 1 onto the right side of the tree in argument 2.
+*   Either tree may be empty (nullptr).
 *   Given the restrictions of a leftist heap, if this is not possible, adjust the 
-*   structure of the heap and attempt the push again
+*   structure of the heap and attempt the push again.
+*   The comparator decides which root stays on top: compare(a, b) == true
+*   means a belongs above b (std::less gives a min-heap, std::greater a max-heap)
+*
+* static void purge(Leftist_node *&, Compare const &);
+*   While the tree in the argument has an erased root, replace it with the
+*   merge of its two sub trees and delete it.
 *
-* void clear();
-*   Clear the node and all of its descendents. Set all cleared nodes to nullptr.
+* static void clear(Leftist_node *&);
+*   Clear the tree in the argument and all of its descendents, and set it to nullptr.
+*
+* static int &push_calls();
+*   With DS_ENABLE_STATS defined (see Ds_stats.h), the number of calls of push made
+*   so far by the calling thread, recursive calls included. Leftist_heap reads it
+*   before and after a merge to find how deep the merge recursed.
 *
 
 */
@@ -60,12 +92,14 @@
 #define LEFTIST_NODE_H
 
 #include <algorithm>
+#include <functional>
+#include <utility>
+#include "Ds_stats.h"
 
-#ifndef nullptr
-#define nullptr 0
-#endif
+template <typename Type, typename Compare>
+class Leftist_heap;
 
-template <typename Type>
+template <typename Type, typename Compare = std::less<Type> >
 class Leftist_node {
 private:
 	// Member variables
@@ -73,130 +107,211 @@ private:
 	Leftist_node *left_tree;
 	Leftist_node *right_tree;
 	int heap_null_path_length;
+	bool erased;
 
 public:
-	// Constructor
-	Leftist_node(Type const &);
+	// Constructor: forwards its arguments to the constructor of the element
+	template <typename... Args>
+	explicit Leftist_node(Args &&...);
 
 	// Accessors
-	Type retrieve() const;
-	bool empty() const;
+	Type const &retrieve() const;
 	Leftist_node *left() const;
 	Leftist_node *right() const;
-	int count(Type const &) const;
+	int count(Type const &, Compare const & = Compare()) const;
+	void count_many(Type const *, int, int, int *, Compare const & = Compare()) const;
+	Leftist_node *find(Type const &, Compare const & = Compare());
 	int null_path_length() const;
+	static int npl(Leftist_node const *);
 	void inorder_traversal(Leftist_node *) const;
 
 	// Mutators
-	void push(Leftist_node *, Leftist_node *&);
-	void clear();
+	static void push(Leftist_node *, Leftist_node *&, Compare const & = Compare());
+	static void purge(Leftist_node *&, Compare const & = Compare());
+	static void clear(Leftist_node *&);
+#ifdef DS_ENABLE_STATS
+	static int &push_calls();
+#endif
+
+	// The heap moves elements out of popped nodes and marks erased nodes
+	friend class Leftist_heap<Type, Compare>;
 };
 
-template <typename Type>
-Leftist_node<Type>::Leftist_node(Type const &obj) :
-element(obj),
+template <typename Type, typename Compare>
+template <typename... Args>
+Leftist_node<Type, Compare>::Leftist_node(Args &&...args) :
+element(std::forward<Args>(args)...),
 left_tree(nullptr),
 right_tree(nullptr),
-heap_null_path_length(0) {
+heap_null_path_length(0),
+erased(false) {
 	// does nothing
 }
 
-template <typename Type>
-Type Leftist_node<Type>::retrieve() const{
+template <typename Type, typename Compare>
+Type const &Leftist_node<Type, Compare>::retrieve() const{
 	return element;
 }
 
-template <typename Type>
-bool Leftist_node<Type>::empty() const {
-	return (this == nullptr);
-}
-
-template <typename Type>
-Leftist_node<Type>* Leftist_node<Type>::left() const{
+template <typename Type, typename Compare>
+Leftist_node<Type, Compare>* Leftist_node<Type, Compare>::left() const{
 	return left_tree;
 }
 
-template <typename Type>
-Leftist_node<Type>* Leftist_node<Type>::right() const{
+template <typename Type, typename Compare>
+Leftist_node<Type, Compare>* Leftist_node<Type, Compare>::right() const{
 	return right_tree;
 }
 
-template <typename Type>
-int Leftist_node<Type>::count(Type const &obj) const{
+template <typename Type, typename Compare>
+int Leftist_node<Type, Compare>::count(Type const &obj, Compare const &compare) const{
+	// If the object belongs above this node, it also belongs above every node
+	// in its sub trees, so none of them can match
+	if (compare(obj, element))
+		return 0;
+
 	int count = 0;		// Initialize counter variable
-	if (element == obj) // If the current node's element matches the object passed, increment count
+	if (!erased && element == obj) // If the current node's element matches the object passed, increment count
 		count++;
 
 	if (left_tree != nullptr)            // If the left tree exists, execute conditional
-		count += left_tree->count(obj);  // Recursively look for more matches in left sub tree
+		count += left_tree->count(obj, compare);  // Recursively look for more matches in left sub tree
 	if (right_tree != nullptr)			 // If the right tree exists, execute conditional
-		count += right_tree->count(obj); // Recursively look for more matches in the right sub tree
+		count += right_tree->count(obj, compare); // Recursively look for more matches in the right sub tree
 
 	return count;	// Return the total matches for the passed object.
 }
 
-template <typename Type>
-int Leftist_node<Type>::null_path_length() const{
-	if (empty()) { return -1; }		// If the node is empty, return -1.
-	return heap_null_path_length;	// Otherwise, return the null path length as desired
+template <typename Type, typename Compare>
+void Leftist_node<Type, Compare>::count_many(Type const *queries, int first, int last, int *tallies, Compare const &compare) const{
+	// Drop the queries that belong above this node: they cannot match it or any of its descendants
+	first = static_cast<int>(std::lower_bound(queries + first, queries + last, element, compare) - queries);
+	if (first == last)
+		return;
+
+	// Every query that is equivalent to this element is a candidate match
+	if (!erased) {
+		for (int i = first; i < last && !compare(element, queries[i]); ++i) {
+			if (element == queries[i])
+				tallies[i]++;
+		}
+	}
+
+	if (left_tree != nullptr)
+		left_tree->count_many(queries, first, last, tallies, compare);
+	if (right_tree != nullptr)
+		right_tree->count_many(queries, first, last, tallies, compare);
 }
 
-template <typename Type>
-void Leftist_node<Type>::push(Leftist_node *new_heap, Leftist_node *&ptrtothis){
+template <typename Type, typename Compare>
+Leftist_node<Type, Compare> *Leftist_node<Type, Compare>::find(Type const &obj, Compare const &compare){
+	// Prune the sub tree exactly as count does
+	if (compare(obj, element))
+		return nullptr;
+
+	if (!erased && element == obj)
+		return this;
+
+	Leftist_node *node = nullptr;
+	if (left_tree != nullptr)
+		node = left_tree->find(obj, compare);
+	if (node == nullptr && right_tree != nullptr)
+		node = right_tree->find(obj, compare);
+
+	return node;
+}
+
+template <typename Type, typename Compare>
+int Leftist_node<Type, Compare>::null_path_length() const{
+	return heap_null_path_length;
+}
+
+template <typename Type, typename Compare>
+int Leftist_node<Type, Compare>::npl(Leftist_node const *tree){
+	if (tree == nullptr) { return -1; }		// If the tree is empty, return -1.
+	return tree->heap_null_path_length;	// Otherwise, return the null path length as desired
+}
+
+template <typename Type, typename Compare>
+void Leftist_node<Type, Compare>::push(Leftist_node *new_heap, Leftist_node *&ptrtothis, Compare const &compare){
+	DS_STATS(push_calls()++;)
+
+	// Erased nodes that the merge would pass over are removed first
+	purge(new_heap, compare);
+	purge(ptrtothis, compare);
 
 	// If new heap is empty, exit. (precondition exit)
-	if (new_heap->empty()) return;					
+	if (new_heap == nullptr) return;
 	// If the current node is empty, new heap is now the new node. (recursive exit)
-	if (ptrtothis->empty()){ ptrtothis = new_heap; return; }
+	if (ptrtothis == nullptr){ ptrtothis = new_heap; return; }
 
-	// If the new heap is greater than or equal to the root node
+	// If the new heap does not belong above the root node
 	// then the new heap should just be pushed onto the right sub tree, recursively.
-	if (new_heap->retrieve() >= ptrtothis->retrieve()){
-		push(new_heap, ptrtothis->right_tree);
+	if (!compare(new_heap->element, ptrtothis->element)){
+		push(new_heap, ptrtothis->right_tree, compare);
 
 		// Update the null path length of the min of the right and left trees,
 		// plus one to account for the new element being pushed onto the tree.
-		ptrtothis->heap_null_path_length = std::min(ptrtothis->left()->null_path_length(), ptrtothis->right()->null_path_length()) + 1;
-		
+		ptrtothis->heap_null_path_length = std::min(npl(ptrtothis->left_tree), npl(ptrtothis->right_tree)) + 1;
+
 		// If the left tree is shorter than the right tree, swap them
-		if (ptrtothis->left()->null_path_length() < ptrtothis->right()->null_path_length()){
+		if (npl(ptrtothis->left_tree) < npl(ptrtothis->right_tree)){
 			std::swap(ptrtothis->left_tree, ptrtothis->right_tree);
 		}
 	}
-	// If the new heap is less than the root node,
+	// If the new heap belongs above the root node,
 	// then the root node should be pushed onto the right sub tree of the new node.
 	else{
 		Leftist_node *temp = ptrtothis;
 		ptrtothis = new_heap;
-		push(temp, ptrtothis);
+		push(temp, ptrtothis, compare);
 
 	}
 	return;
 }
 
-template <typename Type>
-void Leftist_node<Type>::inorder_traversal(Leftist_node *node) const{
+template <typename Type, typename Compare>
+void Leftist_node<Type, Compare>::purge(Leftist_node *&tree, Compare const &compare){
+	while (tree != nullptr && tree->erased){
+		Leftist_node *temp = tree;
+
+		// Replace the erased root by the merge of its sub trees, then delete it.
+		// Either sub tree may be empty, which push handles
+		tree = temp->left_tree;
+		push(temp->right_tree, tree, compare);
+		delete temp;
+	}
+}
+
+template <typename Type, typename Compare>
+void Leftist_node<Type, Compare>::inorder_traversal(Leftist_node *node) const{
 	if (node->left_tree != nullptr) inorder_traversal(node->left_tree);
 	std::cout << "Nullpath: " << node->null_path_length() << "    Node:" << node->retrieve() << std::endl;
 	if (node->right_tree != nullptr) inorder_traversal(node->right_tree);
 }
-template <typename Type>
-void Leftist_node<Type>::clear(){
-	// If the node we are attempting to clear doesn't exist, return
-	if (this == nullptr)
+template <typename Type, typename Compare>
+void Leftist_node<Type, Compare>::clear(Leftist_node *&tree){
+	// If the tree we are attempting to clear doesn't exist, return
+	if (tree == nullptr)
 		return;
 
-	// Recursively clear the subtrees and set them to null
-	left_tree->clear();
-	left_tree = nullptr;
-	right_tree->clear();
-	right_tree = nullptr;
+	// Recursively clear the subtrees, which sets them to null
+	clear(tree->left_tree);
+	clear(tree->right_tree);
+
+	// Delete the root node and set it to null
+	delete tree;
+	tree = nullptr;
+}
 
-	// Delete the root node.
-	// The function calling this method should set the root node to null
-	delete this;
-	
+#ifdef DS_ENABLE_STATS
+// The calls are counted per thread, so heaps used by different threads do not mix their counts
+template <typename Type, typename Compare>
+int &Leftist_node<Type, Compare>::push_calls() {
+	static thread_local int calls = 0;
+	return calls;
 }
+#endif
 
 
 
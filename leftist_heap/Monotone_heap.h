@@ -0,0 +1,40 @@
+/*
+* Monotone_heap
+*
+* Selects a priority queue for workloads whose keys never decrease below the
+* last key popped (event timestamps, Dijkstra distances).
+*
+*   Monotone_heap_traits<Type>::type
+*     Radix_heap<Type> for integer types, Leftist_heap<Type> otherwise.
+*
+*   Monotone_heap_traits<Type>::calendar_type
+*     Calendar_queue<Type> for integer types, Leftist_heap<Type> otherwise.
+*     Prefer this for timer-wheel-like traces, where pending keys are spread
+*     evenly over a window and a bucket width can be chosen to match.
+*
+* All of the selected types share push/pop/top/size/empty/count, so code
+* written against one of them compiles against the others. Note that the
+* integer queues reject keys smaller than the last key popped.
+*/
+
+#ifndef MONOTONE_HEAP_H
+#define MONOTONE_HEAP_H
+
+#include <type_traits>
+#include "Leftist_heap.h"
+#include "Radix_heap.h"
+#include "Calendar_queue.h"
+
+template <typename Type, bool = std::is_integral<Type>::value && !std::is_same<Type, bool>::value>
+struct Monotone_heap_traits {
+	typedef Leftist_heap<Type> type;
+	typedef Leftist_heap<Type> calendar_type;
+};
+
+template <typename Type>
+struct Monotone_heap_traits<Type, true> {
+	typedef Radix_heap<Type> type;
+	typedef Calendar_queue<Type> calendar_type;
+};
+
+#endif
@@ -0,0 +1,324 @@
+/*
+* Multi_queue
+*
+* This class implements a relaxed concurrent priority queue (a MultiQueue)
+* built from c*P independent Leftist_heap shards, where P is the number of
+* threads expected to use the queue and c is a small constant.
+*
+* Each shard is a Leftist_heap protected by its own mutex. A push goes to a
+* random shard, and a pop locks two random shards and removes the better of
+* their two tops; both only try_lock the shards they pick, and choose another
+* at random instead of waiting when one is busy. Only if a bounded number of
+* random attempts find nothing does a pop fall back to sweeping every shard,
+* waiting for each lock in turn.
+*
+* The queue is relaxed: pop() returns an element close to the top of the
+* whole queue but not necessarily the top itself. With two choices per pop
+* the expected rank of the returned element is O(number of shards).
+*
+* ---------------------------------------------------------
+*                           Member Variables:
+*
+*  Multi_queue_shard *shard_array     The array of shards, each aligned to its own cache line.
+*                                     Allocated with cache_aligned_allocate.
+*
+*  int               shard_count      The number of shards in the array
+*
+*  std::atomic<int>  queue_size       The number of elements in all of the shards combined.
+*                                     Updated while the shard's lock is held, so a pop can
+*                                     never decrement it before the matching push increments it.
+*
+*  Compare           compare          The ordering shared by all of the shards
+*
+* ---------------------------------------------------------
+*                   Member Functions (Accessors):
+*
+* bool empty() const
+*   Returns true if no elements are currently in the queue.
+*
+* int size() const
+*   Returns the number of elements in the queue. The value may be stale
+*   by the time it is used if other threads are pushing or popping.
+*
+* int shards() const
+*   Returns the number of shards in the queue.
+*
+* ---------------------------------------------------------
+*                   Member Functions (Mutators):
+*
+* void push(Type const &);
+* void push(Type &&);
+*   Pushes the element onto the first random shard that can be locked without waiting.
+*
+* bool try_pop(Type &);
+*   Locks two random shards and moves the better of their tops into the argument.
+*   Returns false if the element count reads zero, or if the sweep after the random
+*   attempts finds every shard empty. The count is only incremented once a push has
+*   its element in a shard, so false may be returned while another thread is still pushing.
+*
+* Type pop();
+*   As try_pop, but returns the element. Throws an underflow if the queue is empty.
+*
+* ---------------------------------------------------------
+*                   Instrumentation (DS_ENABLE_STATS, see Ds_stats.h):
+*
+* Multi_queue_stats stats() const
+*   Returns a snapshot of the pushes and pops, how many shard locks were found busy
+*   (collisions), and how many pops fell back to the sweep. Collisions that grow with
+*   the number of threads mean there are too few shards per thread; frequent sweeps
+*   mean the queue is usually nearly empty.
+*/
+
+#ifndef MULTI_QUEUE_H
+#define MULTI_QUEUE_H
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+#include "ece250.h"
+#include "Exception.h"
+#include "Cache_aligned.h"
+#include "Leftist_heap.h"
+#include "Thread_random.h"
+#include "Ds_stats.h"
+
+#ifdef DS_ENABLE_STATS
+// A snapshot of the counters of a Multi_queue (see Ds_stats.h)
+struct Multi_queue_stats {
+	int size;
+	int shards;
+	Ds_counter pushes;
+	Ds_counter pops;
+	Ds_counter failed_pops;			// try_pop calls that returned false
+	Ds_counter push_collisions;		// Shards a push found locked
+	Ds_counter pop_collisions;		// Shards a pop found locked
+	Ds_counter sweeps;				// Pops that fell back to sweeping every shard
+
+	Multi_queue_stats() :
+	size(0), shards(0) {
+		// Empty constructor
+	}
+};
+#endif
+
+template <typename Type, typename Compare>
+struct alignas(64) Multi_queue_shard {
+	std::mutex lock;
+	Leftist_heap<Type, Compare> heap;
+
+	Multi_queue_shard(Compare const &comp) :
+	heap(comp) {
+		// does nothing
+	}
+};
+
+template <typename Type, typename Compare = std::less<Type> >
+class Multi_queue {
+private:
+	// Member variables
+	Multi_queue_shard<Type, Compare> *shard_array;
+	int shard_count;
+	std::atomic<int> queue_size;
+	Compare compare;
+#ifdef DS_ENABLE_STATS
+	Multi_queue_stats statistics;
+#endif
+
+	// Do not implement these functions!
+	// The shards hold mutexes, so the queue can be neither copied nor assigned
+	Multi_queue(Multi_queue const &);
+	Multi_queue &operator=(Multi_queue const &);
+
+	int random_shard() const;
+	template <typename Arg>
+	void push_value(Arg &&);
+	bool pop_from(Multi_queue_shard<Type, Compare> &, Type &);
+
+public:
+	// Constructors/Destructor
+	Multi_queue(int = std::thread::hardware_concurrency(), int = 2, Compare const & = Compare());
+	~Multi_queue();
+
+	// Accessors
+	bool empty() const;
+	int size() const;
+	int shards() const;
+#ifdef DS_ENABLE_STATS
+	Multi_queue_stats stats() const;
+#endif
+
+	// Mutators
+	void push(Type const &);
+	void push(Type &&);
+	bool try_pop(Type &);
+	Type pop();
+};
+
+// Creates c shards for each of the given number of threads
+template <typename Type, typename Compare>
+Multi_queue<Type, Compare>::Multi_queue(int threads, int c, Compare const &comp) :
+shard_array(nullptr),
+shard_count(std::max(threads, 1) * std::max(c, 1)),
+queue_size(0),
+compare(comp) {
+	// The shards are constructed in raw storage since each one needs the comparator;
+	// the storage is aligned by hand, as operator new ignores alignas before C++17
+	shard_array = static_cast<Multi_queue_shard<Type, Compare> *>(
+		cache_aligned_allocate(shard_count * sizeof(Multi_queue_shard<Type, Compare>)));
+	for (int i = 0; i < shard_count; ++i) {
+		new (shard_array + i) Multi_queue_shard<Type, Compare>(compare);
+	}
+}
+
+template <typename Type, typename Compare>
+Multi_queue<Type, Compare>::~Multi_queue() {
+	for (int i = 0; i < shard_count; ++i) {
+		shard_array[i].~Multi_queue_shard<Type, Compare>();
+	}
+	cache_aligned_deallocate(shard_array);
+}
+
+// Accessor Functions
+template <typename Type, typename Compare>
+bool Multi_queue<Type, Compare>::empty() const {
+	return queue_size.load(std::memory_order_relaxed) == 0;
+}
+
+template <typename Type, typename Compare>
+int Multi_queue<Type, Compare>::size() const {
+	return queue_size.load(std::memory_order_relaxed);
+}
+
+template <typename Type, typename Compare>
+int Multi_queue<Type, Compare>::shards() const {
+	return shard_count;
+}
+
+#ifdef DS_ENABLE_STATS
+// Returns the event counters together with the current size
+template <typename Type, typename Compare>
+Multi_queue_stats Multi_queue<Type, Compare>::stats() const {
+	Multi_queue_stats snapshot = statistics;
+	snapshot.size = size();
+	snapshot.shards = shard_count;
+	return snapshot;
+}
+#endif
+
+// Returns a random shard index
+template <typename Type, typename Compare>
+int Multi_queue<Type, Compare>::random_shard() const {
+	return static_cast<int>(thread_random() % static_cast<unsigned>(shard_count));
+}
+
+// Mutators
+template <typename Type, typename Compare>
+void Multi_queue<Type, Compare>::push(Type const &obj) {
+	push_value(obj);
+}
+
+template <typename Type, typename Compare>
+void Multi_queue<Type, Compare>::push(Type &&obj) {
+	push_value(std::move(obj));
+}
+
+template <typename Type, typename Compare>
+template <typename Arg>
+void Multi_queue<Type, Compare>::push_value(Arg &&obj) {
+	// Keep choosing random shards until one can be locked without waiting
+	while (true) {
+		Multi_queue_shard<Type, Compare> &shard = shard_array[random_shard()];
+		if (shard.lock.try_lock()) {
+			std::lock_guard<std::mutex> guard(shard.lock, std::adopt_lock);
+			shard.heap.push(std::forward<Arg>(obj));
+			queue_size.fetch_add(1, std::memory_order_relaxed);
+			DS_STATS(statistics.pushes.add();)
+			return;
+		}
+		DS_STATS(statistics.push_collisions.add();)
+	}
+}
+
+// Pops the top of a locked, non-empty shard into the argument and unlocks the shard.
+// The guard releases the lock even if the pop throws, and the element is only
+// assigned to the argument once the shard is unlocked.
+template <typename Type, typename Compare>
+bool Multi_queue<Type, Compare>::pop_from(Multi_queue_shard<Type, Compare> &shard, Type &obj) {
+	std::unique_lock<std::mutex> guard(shard.lock, std::adopt_lock);
+	Type top = shard.heap.pop();
+	queue_size.fetch_sub(1, std::memory_order_relaxed);
+	guard.unlock();
+	DS_STATS(statistics.pops.add();)
+
+	obj = std::move(top);
+	return true;
+}
+
+template <typename Type, typename Compare>
+bool Multi_queue<Type, Compare>::try_pop(Type &obj) {
+	// Try a bounded number of random pairs of shards before falling back to a full sweep
+	for (int attempt = 0; attempt < 4 * shard_count; ++attempt) {
+		if (empty()) {
+			DS_STATS(statistics.failed_pops.add();)
+			return false;
+		}
+
+		Multi_queue_shard<Type, Compare> &first = shard_array[random_shard()];
+		if (!first.lock.try_lock()) {
+			DS_STATS(statistics.pop_collisions.add();)
+			continue;
+		}
+
+		Multi_queue_shard<Type, Compare> &second = shard_array[random_shard()];
+		if (&second == &first || !second.lock.try_lock()) {
+			DS_STATS(if (&second != &first) statistics.pop_collisions.add();)
+			// Only one shard could be locked: use it if it has anything
+			if (!first.heap.empty()) return pop_from(first, obj);
+			first.lock.unlock();
+			continue;
+		}
+
+		// Both shards are locked: pop from whichever has the better top
+		if (first.heap.empty() && second.heap.empty()) {
+			first.lock.unlock();
+			second.lock.unlock();
+			continue;
+		}
+
+		if (first.heap.empty() || (!second.heap.empty() && compare(second.heap.top(), first.heap.top()))) {
+			first.lock.unlock();
+			return pop_from(second, obj);
+		}
+
+		second.lock.unlock();
+		return pop_from(first, obj);
+	}
+
+	// Every shard may be empty: sweep them all, waiting for each lock,
+	// so that false is only returned if no shard held an element
+	DS_STATS(statistics.sweeps.add();)
+	for (int i = 0; i < shard_count; ++i) {
+		shard_array[i].lock.lock();
+		if (!shard_array[i].heap.empty()) return pop_from(shard_array[i], obj);
+		shard_array[i].lock.unlock();
+	}
+
+	DS_STATS(statistics.failed_pops.add();)
+	return false;
+}
+
+template <typename Type, typename Compare>
+Type Multi_queue<Type, Compare>::pop() {
+	Type obj;
+
+	// If no shard has an element, throw an underflow
+	if (!try_pop(obj)) throw underflow();
+
+	return obj;
+}
+
+#endif
@@ -0,0 +1,288 @@
+/*
+* Radix_heap
+*
+* This class implements a monotone radix heap for integer keys with the same
+* push/pop/top interface as Leftist_heap (ordered as a min-heap).
+*
+* A radix heap only accepts keys that are no smaller than the last key popped,
+* which is the case for event timestamps and for Dijkstra distances. In return
+* every operation is a handful of integer instructions: an element is placed in
+* the bucket given by the highest bit in which it differs from the last key
+* popped, and a bucket is only redistributed when all of the buckets below it
+* are empty. Each element moves to a lower bucket at most once per bit.
+*
+* ---------------------------------------------------------
+*                           Member Variables:
+*
+*  std::vector<Type> buckets[BUCKETS] Bucket 0 holds the elements equal to last_key.
+*                                     Bucket i holds the elements whose highest bit
+*                                     differing from last_key is bit i - 1.
+*
+*  Key               last_key         The key of the last element popped (or found at the
+*                                     top). Pushing a smaller key throws an illegal_argument.
+*
+*  int               heap_size        The number of elements in the heap
+*
+* ---------------------------------------------------------
+*                   Member Functions (Accessors):
+*
+* bool empty() const
+*   Returns true if the heap is empty, otherwise false.
+*
+* int size() const
+*   Returns the number of elements in the heap.
+*
+* Type const &top() const
+*   Returns a reference to the smallest element in the heap.
+*   Throws an underflow if the heap is empty.
+*
+* int count(Type const &) const
+*   Returns the number of elements equal to the argument. Only the one bucket
+*   that could contain the argument is searched.
+*
+* ---------------------------------------------------------
+*                   Member Functions (Mutators):
+*
+* void push(Type const &);
+*   Places the element in its bucket.
+*   Throws an illegal_argument if the element is smaller than the last key popped.
+*
+* Type pop();
+*   Removes and returns the smallest element. Throws an underflow if the heap is empty.
+*
+* void clear();
+*   Removes all of the elements and resets the last key to the smallest possible key.
+*
+* ---------------------------------------------------------
+*                   Instrumentation (DS_ENABLE_STATS, see Ds_stats.h):
+*
+* Radix_heap_stats stats() const
+*   Returns a snapshot of the size of the heap, the number of pushes and pops, and
+*   the number of redistributions together with the elements they moved. Moves per
+*   pop stay below the number of bits in a key; fewer mean keys close to last_key.
+*/
+
+#ifndef RADIX_HEAP_H
+#define RADIX_HEAP_H
+
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "ece250.h"
+#include "Exception.h"
+#include "Ds_stats.h"
+
+#ifdef DS_ENABLE_STATS
+// A snapshot of the counters of a Radix_heap (see Ds_stats.h)
+struct Radix_heap_stats {
+	int size;
+	long long pushes;
+	long long pops;
+	long long redistributions;		// Buckets emptied into lower buckets
+	long long moves;				// Elements moved by those redistributions
+
+	Radix_heap_stats() :
+	size(0), pushes(0), pops(0), redistributions(0), moves(0) {
+		// Empty constructor
+	}
+};
+#endif
+
+template <typename Type>
+class Radix_heap {
+private:
+	static_assert(std::is_integral<Type>::value, "a radix heap needs integer keys");
+
+	typedef typename std::make_unsigned<Type>::type Key;
+	static int const BUCKETS = std::numeric_limits<Key>::digits + 1;
+
+	// Member variables
+	mutable std::vector<Type> buckets[BUCKETS];
+	mutable Key last_key;
+	int heap_size;
+#ifdef DS_ENABLE_STATS
+	mutable Radix_heap_stats statistics;	// Updated by pull(), which top() calls
+#endif
+
+	static Key key(Type);
+	static int bucket(Key, Key);
+	void pull() const;
+
+public:
+	// Constructors
+	Radix_heap();
+
+	// Supplementary functions
+	void swap(Radix_heap &);
+	Radix_heap &operator=(Radix_heap);
+
+	// Accessors
+	bool empty() const;
+	int size() const;
+	Type const &top() const;
+	int count(Type const &) const;
+#ifdef DS_ENABLE_STATS
+	Radix_heap_stats stats() const;
+#endif
+
+	// Mutators
+	void push(Type const &);
+	Type pop();
+	void clear();
+};
+
+template <typename Type>
+Radix_heap<Type>::Radix_heap() :
+last_key(0),
+heap_size(0) {
+	// does nothing
+}
+
+// Maps the element to an unsigned key with the same ordering:
+// signed values have their sign bit flipped
+template <typename Type>
+typename Radix_heap<Type>::Key Radix_heap<Type>::key(Type obj) {
+	Key k = static_cast<Key>(obj);
+	if (std::numeric_limits<Type>::is_signed) {
+		k ^= static_cast<Key>(Key(1) << (std::numeric_limits<Key>::digits - 1));
+	}
+	return k;
+}
+
+// Returns the bucket of a key: one more than the index of the highest bit
+// in which it differs from the last key, or 0 if the two are equal
+template <typename Type>
+int Radix_heap<Type>::bucket(Key k, Key last) {
+	Key diff = k ^ last;
+	if (diff == 0) return 0;
+
+#if defined(__GNUC__)
+	return std::numeric_limits<unsigned long long>::digits - __builtin_clzll(static_cast<unsigned long long>(diff));
+#else
+	int width = 0;
+	while (diff != 0) {
+		diff >>= 1;
+		++width;
+	}
+	return width;
+#endif
+}
+
+template <typename Type>
+void Radix_heap<Type>::swap(Radix_heap<Type> &heap) {
+	for (int i = 0; i < BUCKETS; ++i) {
+		buckets[i].swap(heap.buckets[i]);
+	}
+	std::swap(last_key, heap.last_key);
+	std::swap(heap_size, heap.heap_size);
+	DS_STATS(std::swap(statistics, heap.statistics);)
+}
+
+template <typename Type>
+Radix_heap<Type> &Radix_heap<Type>::operator=(Radix_heap<Type> rhs) {
+	swap(rhs);
+
+	return *this;
+}
+
+// Accessor Functions
+template <typename Type>
+bool Radix_heap<Type>::empty() const {
+	return heap_size == 0;
+}
+
+template <typename Type>
+int Radix_heap<Type>::size() const {
+	return heap_size;
+}
+
+template <typename Type>
+Type const &Radix_heap<Type>::top() const {
+	// If the heap is empty, throw an underflow
+	if (empty()) throw underflow();
+	pull();
+	return buckets[0].back();
+}
+
+template <typename Type>
+int Radix_heap<Type>::count(Type const &obj) const {
+	Key k = key(obj);
+	if (empty() || k < last_key) return 0;
+
+	// An element can only ever be in the bucket its key maps to
+	std::vector<Type> const &b = buckets[bucket(k, last_key)];
+	return static_cast<int>(std::count(b.begin(), b.end(), obj));
+}
+
+#ifdef DS_ENABLE_STATS
+// Returns the event counters together with the current size
+template <typename Type>
+Radix_heap_stats Radix_heap<Type>::stats() const {
+	Radix_heap_stats snapshot = statistics;
+	snapshot.size = heap_size;
+	return snapshot;
+}
+#endif
+
+// Makes sure bucket 0 is not empty: if it is, the lowest non-empty bucket is
+// emptied and its elements are redistributed around its smallest key
+template <typename Type>
+void Radix_heap<Type>::pull() const {
+	if (!buckets[0].empty()) return;
+
+	int i = 1;
+	while (buckets[i].empty()) ++i;
+
+	Key smallest = key(buckets[i][0]);
+	for (typename std::vector<Type>::const_iterator it = buckets[i].begin(); it != buckets[i].end(); ++it) {
+		smallest = std::min(smallest, key(*it));
+	}
+	last_key = smallest;
+
+	// Every element of bucket i lands in a strictly lower bucket
+	for (typename std::vector<Type>::iterator it = buckets[i].begin(); it != buckets[i].end(); ++it) {
+		buckets[bucket(key(*it), last_key)].push_back(*it);
+	}
+	DS_STATS(statistics.redistributions++; statistics.moves += static_cast<long long>(buckets[i].size());)
+	buckets[i].clear();
+}
+
+// Mutators
+template <typename Type>
+void Radix_heap<Type>::push(Type const &obj) {
+	Key k = key(obj);
+
+	// The heap is monotone: nothing smaller than the last key may be pushed
+	if (k < last_key) throw illegal_argument();
+
+	buckets[bucket(k, last_key)].push_back(obj);
+	heap_size++;
+	DS_STATS(statistics.pushes++;)
+}
+
+template <typename Type>
+Type Radix_heap<Type>::pop() {
+	// The heap is empty: throw an underflow exception
+	if (empty()) throw underflow();
+
+	pull();
+	Type returnval = buckets[0].back();
+	buckets[0].pop_back();
+	heap_size--;
+	DS_STATS(statistics.pops++;)
+
+	return returnval;
+}
+
+template <typename Type>
+void Radix_heap<Type>::clear() {
+	for (int i = 0; i < BUCKETS; ++i) {
+		buckets[i].clear();
+	}
+	last_key = 0;
+	heap_size = 0;
+}
+
+#endif
@@ -0,0 +1,319 @@
+/*
+* Chase_lev_deque
+*
+* This class implements an unbounded, lock-free work-stealing deque after
+* Chase and Lev, with the memory orderings of Le, Pop, Cohen and Zappa Nardelli
+* ("Correct and Efficient Work-Stealing for Weak Memory Models").
+*
+* It replaces a Double_sentinel_list shared under a global lock in the common
+* owner/thief pattern: one thread, the owner, pushes and pops at the back as if
+* the deque were its private stack, while any number of other threads steal
+* from the front. The owner only contends with thieves when a single element
+* is left, so in the common case its operations are a few plain loads and
+* stores.
+*
+* The elements live in a circular array of atomic slots that doubles when it
+* fills. A thief may still be reading the old array while the owner copies it,
+* so replaced arrays are retired rather than freed, and are only freed when
+* the deque is destroyed; since each array is twice the size of the one before,
+* the retired arrays together are never larger than the current one.
+*
+* A thief can read a slot at the same time as the owner overwrites it (the
+* thief then loses the compare-and-swap on the top and discards what it read),
+* so the elements must be trivially copyable: pointers to tasks, indices and
+* the like.
+*
+* ---------------------------------------------------------
+*                           Member Variables:
+*
+*  std::atomic<std::int64_t> itop      Index of the front element (advanced by thieves and the owner)
+*  std::atomic<std::int64_t> ibottom   Index one past the back element (written by the owner)
+*  std::atomic<Chase_lev_array *> array       The current circular array
+*  Chase_lev_array *retired_arrays     Arrays replaced by larger ones, most recent first
+*
+* ---------------------------------------------------------
+*                   Member Functions:
+*
+* Chase_lev_deque(int = 64)
+*   Creates a deque with room for at least n elements before it first grows.
+*
+* void push_back(Type);
+*   Owner only. Adds an element to the back of the deque.
+*
+* bool pop_back(Type &);
+*   Owner only. Moves the back element into the argument. Returns false if the deque is empty.
+*
+* bool pop_front(Type &);
+*   Any thread. Steals the front element into the argument. Returns false if the deque
+*   is empty or another thread took the element first.
+*
+* int size() const;
+* bool empty() const;
+*   Approximate while other threads are active.
+*
+* int capacity() const;
+*   Returns the number of elements the current array can hold. Owner only.
+*
+* ---------------------------------------------------------
+*                   Instrumentation (DS_ENABLE_STATS, see Ds_stats.h):
+*
+* Chase_lev_stats stats() const
+*   Returns a snapshot of the owner's pushes, pops and array growths, and of the
+*   steals: those that took an element, those that found the deque empty, and those
+*   that lost the race for the element to the owner or another thief (aborts).
+*   Many aborts per steal mean thieves keep converging on the same deque.
+*/
+
+#ifndef CHASE_LEV_DEQUE_H
+#define CHASE_LEV_DEQUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include "ece250.h"
+#include "Exception.h"
+#include "Cache_aligned.h"
+#include "Ds_stats.h"
+
+#ifdef DS_ENABLE_STATS
+// A snapshot of the counters of a Chase_lev_deque (see Ds_stats.h)
+struct Chase_lev_stats {
+	int size;
+	int capacity;
+	Ds_counter pushes;
+	Ds_counter pops;				// Elements the owner popped from the back
+	Ds_counter grows;
+	Ds_counter lost_pops;			// Last elements the owner lost to a thief
+	Ds_counter steals;
+	Ds_counter empty_steals;		// Steals that found the deque empty
+	Ds_counter aborted_steals;		// Steals that lost the race for the front element
+
+	Chase_lev_stats() :
+	size(0), capacity(0) {
+		// Empty constructor
+	}
+};
+#endif
+
+// A circular array of atomic slots, indexed by the unbounded indices of the deque
+template <typename Type>
+struct Chase_lev_array {
+	std::int64_t mask;
+	std::atomic<Type> *slots;
+	Chase_lev_array *next_retired;
+
+	explicit Chase_lev_array(std::int64_t capacity) :
+	mask(capacity - 1),
+	slots(new std::atomic<Type>[capacity]),
+	next_retired(nullptr) {
+		// Empty constructor
+	}
+
+	~Chase_lev_array() {
+		delete[] slots;
+	}
+
+	std::int64_t capacity() const {
+		return mask + 1;
+	}
+
+	Type get(std::int64_t i) const {
+		return slots[i & mask].load(std::memory_order_relaxed);
+	}
+
+	void put(std::int64_t i, Type obj) {
+		slots[i & mask].store(obj, std::memory_order_relaxed);
+	}
+
+private:
+	// Do not implement these functions!
+	Chase_lev_array(Chase_lev_array const &);
+	Chase_lev_array &operator=(Chase_lev_array const &);
+};
+
+template <typename Type>
+class Chase_lev_deque : public Cache_aligned {
+private:
+	static_assert(std::is_trivially_copyable<Type>::value, "a thief may read an element while the owner overwrites it");
+
+	typedef Chase_lev_array<Type> circular_array;
+
+	alignas(64) std::atomic<std::int64_t> itop;
+	alignas(64) std::atomic<std::int64_t> ibottom;
+	std::atomic<circular_array *> array;
+	circular_array *retired_arrays;
+#ifdef DS_ENABLE_STATS
+	alignas(64) Chase_lev_stats statistics;
+#endif
+
+	// Do not implement these functions!
+	// The deque is shared between threads and can be neither copied nor assigned
+	Chase_lev_deque(Chase_lev_deque const &);
+	Chase_lev_deque &operator=(Chase_lev_deque const &);
+
+	circular_array *grow(circular_array *, std::int64_t, std::int64_t);
+
+public:
+	Chase_lev_deque(int = 64);
+	~Chase_lev_deque();
+
+	int size() const;
+	bool empty() const;
+	int capacity() const;
+#ifdef DS_ENABLE_STATS
+	Chase_lev_stats stats() const;
+#endif
+
+	void push_back(Type);
+	bool pop_back(Type &);
+	bool pop_front(Type &);
+};
+
+// Creates an array with room for at least n elements, rounded up to a power of two
+template <typename Type>
+Chase_lev_deque<Type>::Chase_lev_deque(int n) :
+itop(0),
+ibottom(0),
+array(nullptr),
+retired_arrays(nullptr) {
+	std::int64_t cap = 1;
+	while (cap < n) cap <<= 1;
+
+	array.store(new circular_array(cap), std::memory_order_relaxed);
+}
+
+// Destructor: frees the current array and every retired one
+template <typename Type>
+Chase_lev_deque<Type>::~Chase_lev_deque() {
+	delete array.load(std::memory_order_relaxed);
+
+	while (retired_arrays != nullptr) {
+		circular_array *temp = retired_arrays;
+		retired_arrays = temp->next_retired;
+		delete temp;
+	}
+}
+
+template <typename Type>
+int Chase_lev_deque<Type>::size() const {
+	std::int64_t b = ibottom.load(std::memory_order_relaxed);
+	std::int64_t t = itop.load(std::memory_order_relaxed);
+	return (b > t) ? static_cast<int>(b - t) : 0;
+}
+
+template <typename Type>
+bool Chase_lev_deque<Type>::empty() const {
+	return size() == 0;
+}
+
+template <typename Type>
+int Chase_lev_deque<Type>::capacity() const {
+	return static_cast<int>(array.load(std::memory_order_relaxed)->capacity());
+}
+
+#ifdef DS_ENABLE_STATS
+// Returns the event counters together with the current size and capacity
+template <typename Type>
+Chase_lev_stats Chase_lev_deque<Type>::stats() const {
+	Chase_lev_stats snapshot = statistics;
+	snapshot.size = size();
+	snapshot.capacity = capacity();
+	return snapshot;
+}
+#endif
+
+// Copies the elements in [t, b) into an array of twice the size and publishes it.
+// The old array is retired, not freed: a thief may still be reading from it
+template <typename Type>
+typename Chase_lev_deque<Type>::circular_array *Chase_lev_deque<Type>::grow(circular_array *old_array, std::int64_t b, std::int64_t t) {
+	circular_array *temp = new circular_array(2 * old_array->capacity());
+
+	for (std::int64_t i = t; i < b; ++i) {
+		temp->put(i, old_array->get(i));
+	}
+
+	old_array->next_retired = retired_arrays;
+	retired_arrays = old_array;
+
+	array.store(temp, std::memory_order_release);
+	DS_STATS(statistics.grows.add();)
+	return temp;
+}
+
+template <typename Type>
+void Chase_lev_deque<Type>::push_back(Type obj) {
+	std::int64_t b = ibottom.load(std::memory_order_relaxed);
+	std::int64_t t = itop.load(std::memory_order_acquire);
+	circular_array *a = array.load(std::memory_order_relaxed);
+
+	// If the array is full, double it
+	if (b - t > a->mask)
+		a = grow(a, b, t);
+
+	a->put(b, obj);
+
+	// Publish the element to the thieves
+	ibottom.store(b + 1, std::memory_order_release);
+	DS_STATS(statistics.pushes.add();)
+}
+
+template <typename Type>
+bool Chase_lev_deque<Type>::pop_back(Type &obj) {
+	// Claim the back element first, then check that no thief has taken it
+	std::int64_t b = ibottom.load(std::memory_order_relaxed) - 1;
+	circular_array *a = array.load(std::memory_order_relaxed);
+	ibottom.store(b, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	std::int64_t t = itop.load(std::memory_order_relaxed);
+
+	// The deque was empty: restore the bottom
+	if (t > b) {
+		ibottom.store(b + 1, std::memory_order_relaxed);
+		return false;
+	}
+
+	Type temp = a->get(b);
+
+	// More than one element was left, so no thief can reach this one
+	if (t < b) {
+		obj = temp;
+		DS_STATS(statistics.pops.add();)
+		return true;
+	}
+
+	// This is the last element: race the thieves for it by advancing the top
+	bool won = itop.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	ibottom.store(b + 1, std::memory_order_relaxed);
+
+	if (won)
+		obj = temp;
+	DS_STATS(if (won) statistics.pops.add(); else statistics.lost_pops.add();)
+	return won;
+}
+
+template <typename Type>
+bool Chase_lev_deque<Type>::pop_front(Type &obj) {
+	std::int64_t t = itop.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	std::int64_t b = ibottom.load(std::memory_order_acquire);
+
+	if (t >= b) {
+		DS_STATS(statistics.empty_steals.add();)
+		return false;
+	}
+
+	// Read the element before claiming it: once the top advances the owner may reuse the slot
+	circular_array *a = array.load(std::memory_order_acquire);
+	Type temp = a->get(t);
+
+	if (!itop.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+		DS_STATS(statistics.aborted_steals.add();)
+		return false;
+	}
+
+	obj = temp;
+	DS_STATS(statistics.steals.add();)
+	return true;
+}
+
+#endif
@@ -10,10 +10,7 @@
 #ifndef DOUBLE_NODE_H
 #define DOUBLE_NODE_H
 
-#ifndef nullptr
-#define nullptr 0
-#endif
-
+#include <utility>
 #include "ece250.h"
 
 template <typename Type>
@@ -23,6 +20,9 @@ template <typename Type>
 class Cyclic_double_list;
 
 template <typename Type>
+class Double_node_pool;
+
+template <typename Type, typename Alloc = Double_node_pool<Type> >
 class Double_sentinel_list;
 
 template <typename Type>
@@ -37,14 +37,17 @@ private:
 
 public:
 	Double_node(Type const & = Type(), Double_node * = nullptr, Double_node * = nullptr);
+	template <typename... Args>
+	Double_node(Double_node *, Double_node *, Args &&...);
 
-	Type retrieve() const;
+	Type const &retrieve() const;
 	Double_node *previous() const;
 	Double_node *next() const;
 
 	friend class Double_list<Type>;
 	friend class Cyclic_double_list<Type>;
-	friend class Double_sentinel_list<Type>;
+	template <typename T, typename A>
+	friend class Double_sentinel_list;
 	friend class Cyclic_double_sentinel_list<Type>;
 
 	// if ptr is a pointer to a Double_node<Type> object
@@ -61,9 +64,20 @@ next_node(n) {
 	// empty constructor
 }
 
-// Return the element at the node
+// Construct the element in place from the trailing arguments, e.g. to move an
+// element into the node rather than copy it
+template <typename Type>
+template <typename... Args>
+Double_node<Type>::Double_node(Double_node<Type> *p, Double_node<Type> *n, Args &&... args) :
+element(std::forward<Args>(args)...),
+previous_node(p),
+next_node(n) {
+	// empty constructor
+}
+
+// Return a reference to the element at the node
 template <typename Type>
-Type Double_node<Type>::retrieve() const {
+Type const &Double_node<Type>::retrieve() const {
 	return element;
 }
 
@@ -0,0 +1,233 @@
+/*
+* Double_node_pool
+*
+* This class implements a slab allocator for Double_node objects, and is the
+* default node allocator of Double_sentinel_list.
+*
+* Nodes are carved out of slabs of about 4 KiB, so nodes allocated one after
+* another sit next to each other in memory. A deallocated node is destroyed
+* and threaded onto an intrusive free list through its own storage, and the
+* next allocation reuses it; a list that churns at a steady size therefore
+* stops calling the system allocator. The
+* slabs themselves are only freed when the pool is destroyed, all at once.
+*
+* A pool may be shared by several lists (for example, every list of an LRU
+* cache), but not between threads.
+*
+* Any allocator used in place of this one must provide allocate and
+* deallocate with the signatures below, and must release every node it has
+* allocated when it is destroyed.
+*
+* ---------------------------------------------------------
+*                           Member Variables:
+*
+*  Double_node_slab *slab_list        The slabs, most recently allocated first
+*  int slab_used                      The number of slots handed out from the newest slab
+*  Double_node_slot *free_slots       Deallocated slots, waiting to be reused
+*  int node_count                     The number of nodes currently allocated
+*  int slab_count                     The number of slabs allocated
+*
+* ---------------------------------------------------------
+*                   Member Functions:
+*
+* Double_node<Type> *allocate(Double_node<Type> *, Double_node<Type> *, Args &&...);
+*   Constructs a node with the given previous and next nodes, constructing its
+*   element in place from the remaining arguments.
+*
+* void deallocate(Double_node<Type> *);
+*   Destroys the node and returns its storage to the free list.
+*
+* int size() const;
+*   Returns the number of nodes currently allocated.
+*
+* int slabs() const;
+*   Returns the number of slabs allocated.
+*
+* ---------------------------------------------------------
+*                   Instrumentation (DS_ENABLE_STATS, see Ds_stats.h):
+*
+* Double_node_pool_stats stats() const
+*   Returns a snapshot of the nodes and slabs in use, the peak number of nodes, and
+*   how many allocations reused a freed slot rather than taking a new one. A list
+*   churning at a steady size should see nearly every allocation recycled.
+*/
+
+#ifndef DOUBLE_NODE_POOL_H
+#define DOUBLE_NODE_POOL_H
+
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "ece250.h"
+#include "Double_node.h"
+#include "Ds_stats.h"
+
+#ifdef DS_ENABLE_STATS
+// A snapshot of the counters of a Double_node_pool (see Ds_stats.h)
+struct Double_node_pool_stats {
+	int nodes;
+	int slabs;
+	int peak_nodes;
+	long long allocations;
+	long long recycled;				// Allocations that reused a freed slot
+	long long deallocations;
+	long long slab_bytes;			// Total size of every slab allocated
+
+	Double_node_pool_stats() :
+	nodes(0), slabs(0), peak_nodes(0), allocations(0), recycled(0), deallocations(0), slab_bytes(0) {
+		// Empty constructor
+	}
+};
+#endif
+
+template <typename Type>
+union Double_node_slot {
+	Double_node_slot *next_free;
+	typename std::aligned_storage<sizeof(Double_node<Type>), alignof(Double_node<Type>)>::type storage;
+};
+
+template <typename Type>
+struct Double_node_slab_capacity {
+	static int const value = (sizeof(Double_node_slot<Type>) < (4096 - 16) / 16) ? static_cast<int>((4096 - 16) / sizeof(Double_node_slot<Type>)) : 16;
+};
+
+template <typename Type>
+struct Double_node_slab {
+	Double_node_slab *next_slab;
+	Double_node_slot<Type> slots[Double_node_slab_capacity<Type>::value];
+};
+
+template <typename Type>
+class Double_node_pool {
+private:
+	typedef Double_node_slot<Type> slot;
+	typedef Double_node_slab<Type> slab;
+
+	static int const SLAB_CAPACITY = Double_node_slab_capacity<Type>::value;
+
+	slab *slab_list;
+	int slab_used;
+	slot *free_slots;
+	int node_count;
+	int slab_count;
+#ifdef DS_ENABLE_STATS
+	Double_node_pool_stats statistics;
+#endif
+
+	// Do not implement these functions!
+	// The nodes are owned by the lists they belong to, so a pool can be neither copied nor assigned
+	Double_node_pool(Double_node_pool const &);
+	Double_node_pool &operator=(Double_node_pool const &);
+
+	slot *take_slot();
+
+public:
+	Double_node_pool();
+	~Double_node_pool();
+
+	int size() const;
+	int slabs() const;
+#ifdef DS_ENABLE_STATS
+	Double_node_pool_stats stats() const;
+#endif
+
+	template <typename... Args>
+	Double_node<Type> *allocate(Double_node<Type> *, Double_node<Type> *, Args &&...);
+	void deallocate(Double_node<Type> *);
+};
+
+template <typename Type>
+Double_node_pool<Type>::Double_node_pool() :
+slab_list(nullptr),
+slab_used(SLAB_CAPACITY),
+free_slots(nullptr),
+node_count(0),
+slab_count(0) {
+	// Empty constructor
+}
+
+// Destructor: frees every slab. The nodes are not destroyed here: the
+// lists using the pool destroy the elements that need it first
+template <typename Type>
+Double_node_pool<Type>::~Double_node_pool() {
+	while (slab_list != nullptr) {
+		slab *temp = slab_list;
+		slab_list = temp->next_slab;
+		delete temp;
+	}
+}
+
+template <typename Type>
+int Double_node_pool<Type>::size() const {
+	return node_count;
+}
+
+template <typename Type>
+int Double_node_pool<Type>::slabs() const {
+	return slab_count;
+}
+
+#ifdef DS_ENABLE_STATS
+// Returns the event counters together with the current nodes and slabs
+template <typename Type>
+Double_node_pool_stats Double_node_pool<Type>::stats() const {
+	Double_node_pool_stats snapshot = statistics;
+	snapshot.nodes = node_count;
+	snapshot.slabs = slab_count;
+	return snapshot;
+}
+#endif
+
+// Returns storage for one node: a freed slot if there is one, otherwise the
+// next unused slot of the newest slab, allocating a new slab if it is full
+template <typename Type>
+typename Double_node_pool<Type>::slot *Double_node_pool<Type>::take_slot() {
+	if (free_slots != nullptr) {
+		slot *temp = free_slots;
+		free_slots = temp->next_free;
+		DS_STATS(statistics.recycled++;)
+		return temp;
+	}
+
+	if (slab_used == SLAB_CAPACITY) {
+		slab *temp = new slab;
+		temp->next_slab = slab_list;
+		slab_list = temp;
+		slab_used = 0;
+		slab_count++;
+		DS_STATS(statistics.slab_bytes += sizeof(slab);)
+	}
+
+	return slab_list->slots + slab_used++;
+}
+
+template <typename Type>
+template <typename... Args>
+Double_node<Type> *Double_node_pool<Type>::allocate(Double_node<Type> *p, Double_node<Type> *n, Args &&... args) {
+	slot *temp = take_slot();
+
+	try {
+		Double_node<Type> *node = new (&temp->storage) Double_node<Type>(p, n, std::forward<Args>(args)...);
+		node_count++;
+		DS_STATS(statistics.allocations++; if (node_count > statistics.peak_nodes) statistics.peak_nodes = node_count;)
+		return node;
+	}
+	catch (...) {
+		temp->next_free = free_slots;
+		free_slots = temp;
+		throw;
+	}
+}
+
+template <typename Type>
+void Double_node_pool<Type>::deallocate(Double_node<Type> *node) {
+	node->~Double_node();
+
+	slot *temp = reinterpret_cast<slot *>(node);
+	temp->next_free = free_slots;
+	free_slots = temp;
+	node_count--;
+	DS_STATS(statistics.deallocations++;)
+}
+
+#endif
@@ -5,31 +5,82 @@
 * This class implements the functions for a doubly linked list
 * with sentinel nodes
 * It includes methods to traverse, find, delete, pop, and push
-* elements onto the list
+* elements onto the list
+*
+* Nodes are allocated from a node pool (Double_node_pool by default), which
+* recycles freed nodes and allocates them in slabs. Each list creates its own
+* pool when it first allocates a node, unless one is passed to the constructor,
+* in which case several lists can share it. The pool is held by a shared_ptr,
+* so it lives as long as any list using it. A list that is the last user of
+* its pool is destroyed by destroying its elements (if they have destructors)
+* and freeing the pool's slabs, rather than by deallocating its nodes one at
+* a time.
+*
+* The sentinels are members of the list rather than nodes from the pool, so
+* an empty list allocates nothing, and moving a list relinks its first and
+* last nodes to the new sentinels without allocating. Swapping or moving a
+* list therefore invalidates its end() iterators, but no others.
+*
+* Assignment builds the new contents in the list's current pool, so a list
+* that shares its pool keeps sharing it. A move assignment takes over the
+* other list's nodes, and its pool with them, when the two lists already use
+* the same pool or when no other list uses this one's. Either way the other
+* list is left empty, as after a move construction.
+*
+* Bidirectional iterators give O(1) insertion and erasure at a position, and
+* splice and move_to_front relink nodes without copying them, which is what
+* an LRU cache needs. Splicing between lists that allocate from different
+* pools moves the elements over instead, since each node must be returned
+* to the pool it came from.
+*
+* Elements can be moved into the list, or constructed in place in their
+* nodes with the emplace functions, and pop_front and pop_back move the
+* element out of its node, so a list of strings need not copy them.
 *
 */
 
 #ifndef DOUBLE_SENTINEL_LIST_H
 #define DOUBLE_SENTINEL_LIST_H
 
-#ifndef nullptr
-#define nullptr 0
-#endif
-
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
 #include "ece250.h"
 #include "Double_node.h"
+#include "Double_node_pool.h"
 #include "Exception.h"
 
-template <typename Type>
+template <typename Type, typename Alloc>
 class Double_sentinel_list {
 private:
-	Double_node<Type> *list_head;
-	Double_node<Type> *list_tail;
+	mutable std::shared_ptr<Alloc> node_pool;	// The allocator the nodes come from, created on first use
+	// The sentinels' elements are default constructed in place, so that Type need not be copyable
+	Double_node<Type> head_sentinel{static_cast<Double_node<Type> *>(nullptr), static_cast<Double_node<Type> *>(nullptr)};
+	Double_node<Type> tail_sentinel{static_cast<Double_node<Type> *>(nullptr), static_cast<Double_node<Type> *>(nullptr)};
+	Double_node<Type> *list_head;	// Always &head_sentinel
+	Double_node<Type> *list_tail;	// Always &tail_sentinel
 	int list_size;
 
+	void initialize();
+	void adopt(Double_node<Type> *, Double_node<Type> *, int);
+	Alloc &allocator();
+	void copy_from(Double_sentinel_list const &);
+
+public:
+	class iterator;
+	class const_iterator;
+
+private:
+	void transfer(iterator, Double_sentinel_list &, iterator, iterator, int);
+
 public:
 	Double_sentinel_list();
+	explicit Double_sentinel_list(std::shared_ptr<Alloc>);
 	Double_sentinel_list(Double_sentinel_list const &);
+	Double_sentinel_list(Double_sentinel_list const &, std::shared_ptr<Alloc>);
+	Double_sentinel_list(Double_sentinel_list &&) noexcept(std::is_nothrow_default_constructible<Type>::value);
 	~Double_sentinel_list();
 
 	// Accessors
@@ -37,54 +88,206 @@ public:
 	int size() const;
 	bool empty() const;
 
-	Type front() const;
-	Type back() const;
+	Type const &front() const;
+	Type const &back() const;
 
 	Double_node<Type> *head() const;
 	Double_node<Type> *tail() const;
 
+	std::shared_ptr<Alloc> pool() const;
+
 	int count(Type const &) const;
 
+	iterator begin();
+	iterator end();
+	const_iterator begin() const;
+	const_iterator end() const;
+
 	// Mutators
 
 	void swap(Double_sentinel_list &);
 	Double_sentinel_list &operator=(Double_sentinel_list const &);
+	Double_sentinel_list &operator=(Double_sentinel_list &&);
 
 	void push_front(Type const &);
+	void push_front(Type &&);
 	void push_back(Type const &);
+	void push_back(Type &&);
+	template <typename... Args>
+	void emplace_front(Args &&...);
+	template <typename... Args>
+	void emplace_back(Args &&...);
 
 	Type pop_front();
 	Type pop_back();
 
 	int erase(Type const &);
 
+	iterator insert(iterator, Type const &);
+	iterator insert(iterator, Type &&);
+	template <typename... Args>
+	iterator emplace(iterator, Args &&...);
+	iterator erase(iterator);
+
+	void splice(iterator, Double_sentinel_list &);
+	void splice(iterator, Double_sentinel_list &, iterator);
+	void splice(iterator, Double_sentinel_list &, iterator, iterator);
+	void move_to_front(iterator);
+
+	// Iterators
+
+	class iterator {
+	private:
+		Double_node<Type> *node;
+
+		friend class Double_sentinel_list;
+		friend class const_iterator;
+
+	public:
+		typedef std::bidirectional_iterator_tag iterator_category;
+		typedef Type value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef Type *pointer;
+		typedef Type &reference;
+
+		iterator() : node(nullptr) {}
+		explicit iterator(Double_node<Type> *n) : node(n) {}
+
+		Type &operator*() const { return node->element; }
+		Type *operator->() const { return &node->element; }
+
+		iterator &operator++() { node = node->next_node; return *this; }
+		iterator operator++(int) { iterator temp(*this); node = node->next_node; return temp; }
+		iterator &operator--() { node = node->previous_node; return *this; }
+		iterator operator--(int) { iterator temp(*this); node = node->previous_node; return temp; }
+
+		bool operator==(iterator const &rhs) const { return node == rhs.node; }
+		bool operator!=(iterator const &rhs) const { return node != rhs.node; }
+	};
+
+	class const_iterator {
+	private:
+		Double_node<Type> const *node;
+
+	public:
+		typedef std::bidirectional_iterator_tag iterator_category;
+		typedef Type value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef Type const *pointer;
+		typedef Type const &reference;
+
+		const_iterator() : node(nullptr) {}
+		explicit const_iterator(Double_node<Type> const *n) : node(n) {}
+		const_iterator(iterator const &it) : node(it.node) {}
+
+		Type const &operator*() const { return node->element; }
+		Type const *operator->() const { return &node->element; }
+
+		const_iterator &operator++() { node = node->next_node; return *this; }
+		const_iterator operator++(int) { const_iterator temp(*this); node = node->next_node; return temp; }
+		const_iterator &operator--() { node = node->previous_node; return *this; }
+		const_iterator operator--(int) { const_iterator temp(*this); node = node->previous_node; return temp; }
+
+		bool operator==(const_iterator const &rhs) const { return node == rhs.node; }
+		bool operator!=(const_iterator const &rhs) const { return node != rhs.node; }
+	};
+
 	// Friends
 
-	template <typename T>
-	friend std::ostream &operator<<(std::ostream &, Double_sentinel_list<T> const &);
+	template <typename T, typename A>
+	friend std::ostream &operator<<(std::ostream &, Double_sentinel_list<T, A> const &);
 };
 
-// Constructor: Create an empty list with a sentinel head and tail that point to each other.
-template <typename Type>
-Double_sentinel_list<Type>::Double_sentinel_list() :
-list_head(new Double_node<Type>()),
-list_tail(new Double_node<Type>()),
+// Constructor: Create an empty list. Its node pool is created when the first node is allocated.
+template <typename Type, typename Alloc>
+Double_sentinel_list<Type, Alloc>::Double_sentinel_list() :
+node_pool(),
+list_head(nullptr),
+list_tail(nullptr),
 list_size(0) {
-	list_head->next_node = list_tail;
-	list_tail->previous_node = list_head;
+	initialize();
 }
 
-// Copy Constructor: Take in a list, and create a separate copy of it.
-template <typename Type>
-Double_sentinel_list<Type>::Double_sentinel_list(Double_sentinel_list<Type> const &list) :
-list_head(new Double_node<Type>()),
-list_tail(new Double_node<Type>()),
-list_size(list.size()) {
+// Constructor: Create an empty list whose nodes come from a pool shared with other lists.
+template <typename Type, typename Alloc>
+Double_sentinel_list<Type, Alloc>::Double_sentinel_list(std::shared_ptr<Alloc> pool) :
+node_pool(std::move(pool)),
+list_head(nullptr),
+list_tail(nullptr),
+list_size(0) {
+	initialize();
+}
 
-	// Point the sentinel head and tail nodes to each other.
-	list_head->next_node = list_tail;
-	list_tail->previous_node = list_head;
-	
+// Copy Constructor: Take in a list, and create a separate copy of it with its own node pool.
+template <typename Type, typename Alloc>
+Double_sentinel_list<Type, Alloc>::Double_sentinel_list(Double_sentinel_list<Type, Alloc> const &list) :
+node_pool(),
+list_head(nullptr),
+list_tail(nullptr),
+list_size(0) {
+	initialize();
+	copy_from(list);
+}
+
+// Copy Constructor: As above, but allocate the copy's nodes from the given pool.
+template <typename Type, typename Alloc>
+Double_sentinel_list<Type, Alloc>::Double_sentinel_list(Double_sentinel_list<Type, Alloc> const &list, std::shared_ptr<Alloc> pool) :
+node_pool(std::move(pool)),
+list_head(nullptr),
+list_tail(nullptr),
+list_size(0) {
+	initialize();
+	copy_from(list);
+}
+
+// Move Constructor: Take the nodes of the given list, and its pool, in O(1) and
+// without allocating. The other list is left empty, and creates a new pool if it
+// allocates again.
+template <typename Type, typename Alloc>
+Double_sentinel_list<Type, Alloc>::Double_sentinel_list(Double_sentinel_list<Type, Alloc> &&list) noexcept(std::is_nothrow_default_constructible<Type>::value) :
+node_pool(std::move(list.node_pool)),
+list_head(nullptr),
+list_tail(nullptr),
+list_size(0) {
+	initialize();
+	adopt(list.list_head->next_node, list.list_tail->previous_node, list.list_size);
+	list.adopt(nullptr, nullptr, 0);
+}
+
+// Point the head and tail at the sentinels, and the sentinels at each other.
+template <typename Type, typename Alloc>
+void Double_sentinel_list<Type, Alloc>::initialize() {
+	list_head = &head_sentinel;
+	list_tail = &tail_sentinel;
+	adopt(nullptr, nullptr, 0);
+}
+
+// Link the n nodes from first to last, already linked to each other, between the
+// sentinels in place of the current contents. If n is 0 the list is made empty.
+template <typename Type, typename Alloc>
+void Double_sentinel_list<Type, Alloc>::adopt(Double_node<Type> *first, Double_node<Type> *last, int n) {
+	if (n == 0) {
+		first = list_tail;
+		last = list_head;
+	}
+
+	list_head->next_node = first;
+	first->previous_node = list_head;
+	list_tail->previous_node = last;
+	last->next_node = list_tail;
+	list_size = n;
+}
+
+// Return the pool to allocate nodes from, creating it if this is the first allocation.
+template <typename Type, typename Alloc>
+Alloc &Double_sentinel_list<Type, Alloc>::allocator() {
+	if (!node_pool)
+		node_pool = std::make_shared<Alloc>();
+	return *node_pool;
+}
+
+template <typename Type, typename Alloc>
+void Double_sentinel_list<Type, Alloc>::copy_from(Double_sentinel_list<Type, Alloc> const &list) {
 	// Iterate through the list and continuously add nodes to the back of the list.
 	for (
 		Double_node<Type> *temp = list.head()->next();
@@ -97,35 +300,50 @@ list_size(list.size()) {
 }
 
 // Destructor: Delete/deallocate all nodes from memory thus deleting the list.
-template <typename Type>
-Double_sentinel_list<Type>::~Double_sentinel_list() {
+template <typename Type, typename Alloc>
+Double_sentinel_list<Type, Alloc>::~Double_sentinel_list() {
 	Double_node<Type> *temp = list_head->next_node;
-	
-	// Iterate through the list and delete the nodes.
-	while (temp != 0)
+
+	// If no other list uses the pool, the shared_ptr frees all of the nodes at once,
+	// slab by slab; the nodes only need to be visited if their elements have
+	// destructors to run.
+	if (node_pool.use_count() <= 1) {
+		if (!std::is_trivially_destructible<Type>::value) {
+			while (temp != list_tail)
+			{
+				Double_node<Type> *next = temp->next_node;
+				temp->~Double_node();
+				temp = next;
+			}
+		}
+		return;
+	}
+
+	// Iterate through the list and return the nodes to the shared pool.
+	while (temp != list_tail)
 	{
-		delete temp->previous_node;
-		temp = temp->next_node;
+		Double_node<Type> *next = temp->next_node;
+		node_pool->deallocate(temp);
+		temp = next;
 	}
-	delete list_tail;
 	return;
 }
 
 // Returns the size of the list
-template <typename Type>
-int Double_sentinel_list<Type>::size() const {
+template <typename Type, typename Alloc>
+int Double_sentinel_list<Type, Alloc>::size() const {
 	return list_size;
 }
 
 // Checks if the list is empty. Returns true if it is, otherwise false.
-template <typename Type>
-bool Double_sentinel_list<Type>::empty() const {
+template <typename Type, typename Alloc>
+bool Double_sentinel_list<Type, Alloc>::empty() const {
 	return (list_size == 0);
 }
 
 // Returns the element of the node after the head
-template <typename Type>
-Type Double_sentinel_list<Type>::front() const {
+template <typename Type, typename Alloc>
+Type const &Double_sentinel_list<Type, Alloc>::front() const {
 	// Throw an underflow if the list is empty.
 	if (list_size == 0)
 		throw underflow();
@@ -133,8 +351,8 @@ Type Double_sentinel_list<Type>::front() const {
 }
 
 // Returns the element of the node before the head.
-template <typename Type>
-Type Double_sentinel_list<Type>::back() const {
+template <typename Type, typename Alloc>
+Type const &Double_sentinel_list<Type, Alloc>::back() const {
 	// Throw an underflow if the list is empty.
 	if (list_size == 0)
 		throw underflow();
@@ -142,21 +360,29 @@ Type Double_sentinel_list<Type>::back() const {
 }
 
 // Return the head node.
-template <typename Type>
-Double_node<Type> *Double_sentinel_list<Type>::head() const {
+template <typename Type, typename Alloc>
+Double_node<Type> *Double_sentinel_list<Type, Alloc>::head() const {
 	return list_head;
 }
 
 // Return the tail node.
-template <typename Type>
-Double_node<Type> *Double_sentinel_list<Type>::tail() const {
+template <typename Type, typename Alloc>
+Double_node<Type> *Double_sentinel_list<Type, Alloc>::tail() const {
 	return list_tail;
 }
 
+// Return the pool the list allocates its nodes from, e.g. to create another list sharing it.
+template <typename Type, typename Alloc>
+std::shared_ptr<Alloc> Double_sentinel_list<Type, Alloc>::pool() const {
+	if (!node_pool)
+		node_pool = std::make_shared<Alloc>();
+	return node_pool;
+}
+
 /* Take in an object, and look for all matches within the list.
 Return a count of the total number of matching objects. */
-template <typename Type>
-int Double_sentinel_list<Type>::count(Type const &obj) const {
+template <typename Type, typename Alloc>
+int Double_sentinel_list<Type, Alloc>::count(Type const &obj) const {
 	Double_node<Type> *temp = list_head->next();
 	int count = 0;
 	while (temp->next() != 0)
@@ -168,27 +394,109 @@ int Double_sentinel_list<Type>::count(Type const &obj) const {
 	return count;
 }
 
-// Swaps two existing lists with each other, including all nodes inside.
-template <typename Type>
-void Double_sentinel_list<Type>::swap(Double_sentinel_list<Type> &list) {
-	std::swap(list_head, list.list_head);
-	std::swap(list_tail, list.list_tail);
-	std::swap(list_size, list.list_size);
+// Returns an iterator to the first element (the node after the head sentinel).
+template <typename Type, typename Alloc>
+typename Double_sentinel_list<Type, Alloc>::iterator Double_sentinel_list<Type, Alloc>::begin() {
+	return iterator(list_head->next_node);
 }
 
-template <typename Type>
-Double_sentinel_list<Type> &Double_sentinel_list<Type>::operator=(Double_sentinel_list<Type> const &rhs) {
-	Double_sentinel_list<Type> copy(rhs);
+// Returns an iterator to the tail sentinel, one past the last element.
+template <typename Type, typename Alloc>
+typename Double_sentinel_list<Type, Alloc>::iterator Double_sentinel_list<Type, Alloc>::end() {
+	return iterator(list_tail);
+}
+
+template <typename Type, typename Alloc>
+typename Double_sentinel_list<Type, Alloc>::const_iterator Double_sentinel_list<Type, Alloc>::begin() const {
+	return const_iterator(list_head->next_node);
+}
 
-	swap(copy);
+template <typename Type, typename Alloc>
+typename Double_sentinel_list<Type, Alloc>::const_iterator Double_sentinel_list<Type, Alloc>::end() const {
+	return const_iterator(list_tail);
+}
+
+// Swaps two existing lists with each other, including all nodes inside, by relinking
+// them to the other list's sentinels. The pools are swapped too, since each node
+// must go back to the pool it came from.
+template <typename Type, typename Alloc>
+void Double_sentinel_list<Type, Alloc>::swap(Double_sentinel_list<Type, Alloc> &list) {
+	if (this == &list)
+		return;
+
+	Double_node<Type> *first = list_head->next_node;
+	Double_node<Type> *last = list_tail->previous_node;
+	int n = list_size;
+
+	adopt(list.list_head->next_node, list.list_tail->previous_node, list.list_size);
+	list.adopt(first, last, n);
+	std::swap(node_pool, list.node_pool);
+}
+
+template <typename Type, typename Alloc>
+Double_sentinel_list<Type, Alloc> &Double_sentinel_list<Type, Alloc>::operator=(Double_sentinel_list<Type, Alloc> const &rhs) {
+	// Build the copy in this list's pool, so that a list sharing its pool keeps
+	// sharing it; the old nodes go back to the same pool when the copy is destroyed
+	if (this != &rhs) {
+		Double_sentinel_list<Type, Alloc> copy(rhs, node_pool);
+		swap(copy);
+	}
+
+	return *this;
+}
+
+template <typename Type, typename Alloc>
+Double_sentinel_list<Type, Alloc> &Double_sentinel_list<Type, Alloc>::operator=(Double_sentinel_list<Type, Alloc> &&rhs) {
+	if (this == &rhs)
+		return *this;
+
+	// The nodes of rhs can be taken over if they come from this list's pool, or if
+	// no other list uses this list's pool, so it may as well be replaced by theirs
+	if (node_pool == rhs.node_pool || node_pool.use_count() <= 1) {
+		swap(rhs);
+	}
+	else {
+		// Otherwise the pool is shared: move the elements into new nodes from it
+		Double_sentinel_list<Type, Alloc> copy(node_pool);
+		for (iterator it = rhs.begin(); it != rhs.end(); ++it) {
+			copy.push_back(std::move(*it));
+		}
+		swap(copy);
+	}
+
+	// Leave rhs empty: the nodes it still holds, this list's old ones after a swap,
+	// are released here rather than whenever rhs happens to be destroyed
+	Double_sentinel_list<Type, Alloc> released(std::move(rhs));
 
 	return *this;
 }
 
-// Insert a new node at the beginning of the list (after the list head sentinel node).
-template <typename Type>
-void Double_sentinel_list<Type>::push_front(Type const &obj) {
-	Double_node<Type> *temp = new Double_node<Type>(obj, list_head, list_head->next());
+template <typename Type, typename Alloc>
+void Double_sentinel_list<Type, Alloc>::push_front(Type const &obj) {
+	emplace_front(obj);
+}
+
+template <typename Type, typename Alloc>
+void Double_sentinel_list<Type, Alloc>::push_front(Type &&obj) {
+	emplace_front(std::move(obj));
+}
+
+template <typename Type, typename Alloc>
+void Double_sentinel_list<Type, Alloc>::push_back(Type const &obj) {
+	emplace_back(obj);
+}
+
+template <typename Type, typename Alloc>
+void Double_sentinel_list<Type, Alloc>::push_back(Type &&obj) {
+	emplace_back(std::move(obj));
+}
+
+// Insert a new node at the beginning of the list (after the list head sentinel node),
+// constructing its element from the arguments.
+template <typename Type, typename Alloc>
+template <typename... Args>
+void Double_sentinel_list<Type, Alloc>::emplace_front(Args &&... args) {
+	Double_node<Type> *temp = allocator().allocate(list_head, list_head->next(), std::forward<Args>(args)...);
 
 	// Set next and previous node pointers of the surrounding nodes.
 	list_head->next_node = temp;
@@ -198,10 +506,12 @@ void Double_sentinel_list<Type>::push_front(Type const &obj) {
 	list_size++;
 }
 
-// Insert a new node at the end of the list (before the list tail sentinel node).
-template <typename Type>
-void Double_sentinel_list<Type>::push_back(Type const &obj) {
-	Double_node<Type> *temp = new Double_node<Type>(obj, list_tail->previous(), list_tail);
+// Insert a new node at the end of the list (before the list tail sentinel node),
+// constructing its element from the arguments.
+template <typename Type, typename Alloc>
+template <typename... Args>
+void Double_sentinel_list<Type, Alloc>::emplace_back(Args &&... args) {
+	Double_node<Type> *temp = allocator().allocate(list_tail->previous(), list_tail, std::forward<Args>(args)...);
 
 	// Set next and previous node pointers of the surrounding nodes.
 	list_tail->previous_node = temp;
@@ -212,8 +522,8 @@ void Double_sentinel_list<Type>::push_back(Type const &obj) {
 }
 
 // Remove the node at the front of the list (after the list head sentinel node).
-template <typename Type>
-Type Double_sentinel_list<Type>::pop_front() {
+template <typename Type, typename Alloc>
+Type Double_sentinel_list<Type, Alloc>::pop_front() {
 	if (list_size == 0)
 		throw underflow();
 	Double_node<Type> *temp = list_head->next();
@@ -222,16 +532,16 @@ Type Double_sentinel_list<Type>::pop_front() {
 	list_head->next_node = temp->next();
 	list_head->next()->previous_node = list_head;
 
-	// Set the return element, delete the node, and return the element.
-	Type tempreturn = temp->retrieve();
-	delete temp;
+	// Move the element out, delete the node, and return the element.
+	Type tempreturn(std::move(temp->element));
+	node_pool->deallocate(temp);
 	list_size--;
 	return tempreturn;
 }
 
 // Remove the node at the end of the list (before the list tail sentinel node).
-template <typename Type>
-Type Double_sentinel_list<Type>::pop_back() {
+template <typename Type, typename Alloc>
+Type Double_sentinel_list<Type, Alloc>::pop_back() {
 	if (list_size == 0)
 		throw underflow();
 	Double_node<Type> *temp = list_tail->previous();
@@ -240,16 +550,16 @@ Type Double_sentinel_list<Type>::pop_back() {
 	list_tail->previous_node = temp->previous();
 	list_tail->previous()->next_node = list_tail;
 
-	// Set the return element, delete the node, and return the element.
-	Type tempreturn = temp->retrieve();
-	delete temp;
+	// Move the element out, delete the node, and return the element.
+	Type tempreturn(std::move(temp->element));
+	node_pool->deallocate(temp);
 	list_size--;
 	return tempreturn;
 }
 
 // Erase the first node that contains the matching object passed to the method
-template <typename Type>
-int Double_sentinel_list<Type>::erase(Type const &obj) {
+template <typename Type, typename Alloc>
+int Double_sentinel_list<Type, Alloc>::erase(Type const &obj) {
 
 	// Iterare through the list
 	for (Double_node<Type> *temp = list_head->next();
@@ -263,7 +573,7 @@ int Double_sentinel_list<Type>::erase(Type const &obj) {
 			temp->previous()->next_node = temp->next();
 			temp->next()->previous_node = temp->previous();
 			// Delete the node, decrement the size of the list
-			delete temp;
+			node_pool->deallocate(temp);
 			list_size--;
 			// Return 1, indicating a match was found
 			return 1;
@@ -272,9 +582,145 @@ int Double_sentinel_list<Type>::erase(Type const &obj) {
 	return 0;
 }
 
+template <typename Type, typename Alloc>
+typename Double_sentinel_list<Type, Alloc>::iterator Double_sentinel_list<Type, Alloc>::insert(iterator position, Type const &obj) {
+	return emplace(position, obj);
+}
+
+template <typename Type, typename Alloc>
+typename Double_sentinel_list<Type, Alloc>::iterator Double_sentinel_list<Type, Alloc>::insert(iterator position, Type &&obj) {
+	return emplace(position, std::move(obj));
+}
+
+// Insert a new node before the given position, constructing its element from
+// the arguments, and return an iterator to it.
+template <typename Type, typename Alloc>
+template <typename... Args>
+typename Double_sentinel_list<Type, Alloc>::iterator Double_sentinel_list<Type, Alloc>::emplace(iterator position, Args &&... args) {
+	Double_node<Type> *temp = allocator().allocate(position.node->previous(), position.node, std::forward<Args>(args)...);
+
+	// Set next and previous node pointers of the surrounding nodes.
+	temp->previous()->next_node = temp;
+	position.node->previous_node = temp;
+
+	list_size++;
+	return iterator(temp);
+}
+
+// Erase the node at the given position in O(1), and return an iterator to the node after it.
+template <typename Type, typename Alloc>
+typename Double_sentinel_list<Type, Alloc>::iterator Double_sentinel_list<Type, Alloc>::erase(iterator position) {
+	Double_node<Type> *temp = position.node;
+
+	// The sentinels cannot be erased
+	if (temp == list_head || temp == list_tail)
+		throw illegal_argument();
+
+	Double_node<Type> *next = temp->next();
+	temp->previous()->next_node = next;
+	next->previous_node = temp->previous();
+
+	node_pool->deallocate(temp);
+	list_size--;
+	return iterator(next);
+}
+
+// Move the n nodes in [first, last) of the given list to before position. If both
+// lists allocate from the same pool the nodes are relinked in O(1); otherwise each
+// element is moved into a node from this list's pool and erased from the other.
+template <typename Type, typename Alloc>
+void Double_sentinel_list<Type, Alloc>::transfer(iterator position, Double_sentinel_list<Type, Alloc> &list, iterator first, iterator last, int n) {
+	if (first == last || position == last)
+		return;
+
+	// A list that has never allocated can simply start using the other list's pool
+	if (!node_pool)
+		node_pool = list.node_pool;
+
+	if (node_pool != list.node_pool) {
+		while (first != last) {
+			insert(position, std::move(*first));
+			first = list.erase(first);
+		}
+		return;
+	}
+
+	Double_node<Type> *first_node = first.node;
+	Double_node<Type> *last_node = last.node->previous();
+
+	// Unlink [first_node, last_node] from its list
+	first_node->previous()->next_node = last.node;
+	last.node->previous_node = first_node->previous();
+
+	// Link it in before position
+	first_node->previous_node = position.node->previous();
+	last_node->next_node = position.node;
+	position.node->previous()->next_node = first_node;
+	position.node->previous_node = last_node;
+
+	if (this != &list) {
+		list.list_size -= n;
+		list_size += n;
+	}
+}
+
+// Move every element of the given list to before position, leaving it empty.
+template <typename Type, typename Alloc>
+void Double_sentinel_list<Type, Alloc>::splice(iterator position, Double_sentinel_list<Type, Alloc> &list) {
+	if (this != &list)
+		transfer(position, list, list.begin(), list.end(), list.list_size);
+}
+
+// Move the element at it, from the given list, to before position.
+template <typename Type, typename Alloc>
+void Double_sentinel_list<Type, Alloc>::splice(iterator position, Double_sentinel_list<Type, Alloc> &list, iterator it) {
+	iterator last = it;
+	++last;
+
+	if (position != it)
+		transfer(position, list, it, last, 1);
+}
+
+// Move the elements in [first, last), from the given list, to before position.
+// Splicing between two different lists counts the range, so is linear in its length.
+template <typename Type, typename Alloc>
+void Double_sentinel_list<Type, Alloc>::splice(iterator position, Double_sentinel_list<Type, Alloc> &list, iterator first, iterator last) {
+	int n = 0;
+
+	if (this != &list) {
+		for (iterator it = first; it != last; ++it) {
+			n++;
+		}
+	}
+
+	transfer(position, list, first, last, n);
+}
+
+// Move the element at the given position to the front of the list in O(1).
+template <typename Type, typename Alloc>
+void Double_sentinel_list<Type, Alloc>::move_to_front(iterator position) {
+	Double_node<Type> *temp = position.node;
+
+	if (temp == list_head || temp == list_tail)
+		throw illegal_argument();
+
+	if (temp == list_head->next())
+		return;
+
+	// Unlink the node
+	temp->previous()->next_node = temp->next();
+	temp->next()->previous_node = temp->previous();
+
+	// Relink it after the head sentinel
+	temp->previous_node = list_head;
+	temp->next_node = list_head->next();
+	list_head->next()->previous_node = temp;
+	list_head->next_node = temp;
+}
+
 
-template <typename T>
-std::ostream &operator<<(std::ostream &out, Double_sentinel_list<T> const &list) {
+template <typename T, typename A>
+std::ostream &operator<<(std::ostream &out, Double_sentinel_list<T, A> const &list) {
 	out << "head";
 
 	for (Double_node<T> *ptr = list.head(); ptr != nullptr; ptr = ptr->next()) {
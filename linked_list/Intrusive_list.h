@@ -0,0 +1,431 @@
+/*
+* Intrusive_sentinel_list
+*
+* This class implements a doubly linked list with sentinel nodes, like
+* Double_sentinel_list, whose nodes are hooks embedded in the elements
+* themselves rather than separately allocated Double_nodes holding copies.
+*
+* A type that is to be kept on a list declares an Intrusive_hook member for
+* each list it may be on at the same time, and the list is told which member
+* to use:
+*
+*     struct Entry {
+*         int key;
+*         Intrusive_hook lru_hook;
+*         Intrusive_hook bucket_hook;
+*     };
+*
+*     Intrusive_sentinel_list<Entry, &Entry::lru_hook> lru;
+*
+* Linking and unlinking never allocate or copy: the list stores pointers to
+* the caller's objects, which must outlive their membership of the list (an
+* object's hooks unlink themselves when it is destroyed). Each hook also
+* records the size of the list it is on, so an object can be removed from
+* whichever list holds it in O(1) without a reference to that list, and the
+* object it is embedded in, so the list can get from a hook to its object
+* for any Type, standard layout or not.
+*
+* The head and tail sentinels are hooks owned by the list, exactly as the
+* sentinel nodes of Double_sentinel_list are, so no operation needs to test
+* for the ends of the list.
+*
+* ---------------------------------------------------------
+*                   Intrusive_hook:
+*
+* bool linked() const
+*   Returns true if the hook is on a list.
+*
+* void unlink()
+*   Removes the object from the list it is on, if any.
+*
+* Copying an object does not copy its list memberships: a copied hook starts
+* unlinked, and assigning to a hook leaves it where it is.
+*
+* ---------------------------------------------------------
+*                   Intrusive_sentinel_list:
+*
+* int size() const
+* bool empty() const
+*
+* Type &front() const
+* Type &back() const
+*   Throw an underflow if the list is empty.
+*
+* iterator begin(), end()
+*   Bidirectional iterators over the objects.
+*
+* static iterator iterator_to(Type &)
+*   Returns an iterator to an object on the list.
+*
+* void push_front(Type &)
+* void push_back(Type &)
+* iterator insert(iterator, Type &)
+*   Link the object in. Throw an illegal_argument if it is already on a list.
+*
+* Type &pop_front()
+* Type &pop_back()
+*   Unlink the first or last object and return it. Throw an underflow if the list is empty.
+*
+* int erase(Type &)
+*   Unlinks the object in O(1) and returns 1 if it is on this list; returns 0 otherwise.
+*
+* iterator erase(iterator)
+*   Unlinks the object at the position and returns an iterator to the next one.
+*
+* void move_to_front(Type &)
+*   Moves an object on the list to the front in O(1).
+*
+* void clear()
+*   Unlinks every object.
+*/
+
+#ifndef INTRUSIVE_LIST_H
+#define INTRUSIVE_LIST_H
+
+#include <cstddef>
+#include <iterator>
+#include "ece250.h"
+#include "Exception.h"
+
+class Intrusive_hook;
+
+template <typename Type, Intrusive_hook Type::*Hook>
+class Intrusive_sentinel_list;
+
+class Intrusive_hook {
+private:
+	Intrusive_hook *previous_hook;
+	Intrusive_hook *next_hook;
+	int *owner_size;	// The size of the list the hook is on, or nullptr if it is unlinked
+	void *owner_object;	// The object the hook is embedded in, recorded when it is linked
+
+	template <typename T, Intrusive_hook T::*H>
+	friend class Intrusive_sentinel_list;
+
+	template <typename T, Intrusive_hook T::*H>
+	friend std::ostream &operator<<(std::ostream &, Intrusive_sentinel_list<T, H> const &);
+
+public:
+	Intrusive_hook() :
+	previous_hook(nullptr),
+	next_hook(nullptr),
+	owner_size(nullptr),
+	owner_object(nullptr) {
+		// Empty constructor
+	}
+
+	// Copy Constructor: the copy of an object is not on any list
+	Intrusive_hook(Intrusive_hook const &) :
+	previous_hook(nullptr),
+	next_hook(nullptr),
+	owner_size(nullptr),
+	owner_object(nullptr) {
+		// Empty constructor
+	}
+
+	// Assigning to an object leaves its list memberships unchanged
+	Intrusive_hook &operator=(Intrusive_hook const &) {
+		return *this;
+	}
+
+	// Destructor: an object that is destroyed while on a list removes itself from it
+	~Intrusive_hook() {
+		unlink();
+	}
+
+	bool linked() const {
+		return owner_size != nullptr;
+	}
+
+	void unlink() {
+		if (owner_size == nullptr)
+			return;
+
+		previous_hook->next_hook = next_hook;
+		next_hook->previous_hook = previous_hook;
+		(*owner_size)--;
+
+		previous_hook = next_hook = nullptr;
+		owner_size = nullptr;
+	}
+};
+
+template <typename Type, Intrusive_hook Type::*Hook>
+class Intrusive_sentinel_list {
+private:
+	Intrusive_hook list_head;
+	Intrusive_hook list_tail;
+	int list_size;
+
+	// Do not implement these functions!
+	// The list links the caller's objects rather than owning copies of them,
+	// so it can be neither copied nor assigned
+	Intrusive_sentinel_list(Intrusive_sentinel_list const &);
+	Intrusive_sentinel_list &operator=(Intrusive_sentinel_list const &);
+
+	static Type *object(Intrusive_hook *);
+	void link_before(Intrusive_hook *, Type &);
+
+public:
+	class iterator {
+	private:
+		Intrusive_hook *hook;
+
+		friend class Intrusive_sentinel_list;
+
+	public:
+		typedef std::bidirectional_iterator_tag iterator_category;
+		typedef Type value_type;
+		typedef std::ptrdiff_t difference_type;
+		typedef Type *pointer;
+		typedef Type &reference;
+
+		iterator() : hook(nullptr) {}
+		explicit iterator(Intrusive_hook *h) : hook(h) {}
+
+		Type &operator*() const { return *object(hook); }
+		Type *operator->() const { return object(hook); }
+
+		iterator &operator++() { hook = hook->next_hook; return *this; }
+		iterator operator++(int) { iterator temp(*this); hook = hook->next_hook; return temp; }
+		iterator &operator--() { hook = hook->previous_hook; return *this; }
+		iterator operator--(int) { iterator temp(*this); hook = hook->previous_hook; return temp; }
+
+		bool operator==(iterator const &rhs) const { return hook == rhs.hook; }
+		bool operator!=(iterator const &rhs) const { return hook != rhs.hook; }
+	};
+
+	Intrusive_sentinel_list();
+	~Intrusive_sentinel_list();
+
+	// Accessors
+
+	int size() const;
+	bool empty() const;
+
+	Type &front() const;
+	Type &back() const;
+
+	iterator begin();
+	iterator end();
+	static iterator iterator_to(Type &);
+
+	// Mutators
+
+	void push_front(Type &);
+	void push_back(Type &);
+	iterator insert(iterator, Type &);
+
+	Type &pop_front();
+	Type &pop_back();
+
+	int erase(Type &);
+	iterator erase(iterator);
+
+	void move_to_front(Type &);
+	void clear();
+
+	// Friends
+
+	template <typename T, Intrusive_hook T::*H>
+	friend std::ostream &operator<<(std::ostream &, Intrusive_sentinel_list<T, H> const &);
+};
+
+// Constructor: Create an empty list with a sentinel head and tail that point to each other.
+template <typename Type, Intrusive_hook Type::*Hook>
+Intrusive_sentinel_list<Type, Hook>::Intrusive_sentinel_list() :
+list_size(0) {
+	list_head.next_hook = &list_tail;
+	list_tail.previous_hook = &list_head;
+}
+
+// Destructor: Unlinks every object; the objects themselves belong to the caller.
+template <typename Type, Intrusive_hook Type::*Hook>
+Intrusive_sentinel_list<Type, Hook>::~Intrusive_sentinel_list() {
+	clear();
+}
+
+// Returns the object a linked hook is embedded in
+template <typename Type, Intrusive_hook Type::*Hook>
+Type *Intrusive_sentinel_list<Type, Hook>::object(Intrusive_hook *hook) {
+	return static_cast<Type *>(hook->owner_object);
+}
+
+// Links the object's hook in before the given hook.
+template <typename Type, Intrusive_hook Type::*Hook>
+void Intrusive_sentinel_list<Type, Hook>::link_before(Intrusive_hook *position, Type &obj) {
+	Intrusive_hook &hook = obj.*Hook;
+
+	// An object can only be on one list through each of its hooks
+	if (hook.linked())
+		throw illegal_argument();
+
+	hook.previous_hook = position->previous_hook;
+	hook.next_hook = position;
+	position->previous_hook->next_hook = &hook;
+	position->previous_hook = &hook;
+	hook.owner_size = &list_size;
+	hook.owner_object = &obj;
+
+	list_size++;
+}
+
+template <typename Type, Intrusive_hook Type::*Hook>
+int Intrusive_sentinel_list<Type, Hook>::size() const {
+	return list_size;
+}
+
+template <typename Type, Intrusive_hook Type::*Hook>
+bool Intrusive_sentinel_list<Type, Hook>::empty() const {
+	return (list_size == 0);
+}
+
+template <typename Type, Intrusive_hook Type::*Hook>
+Type &Intrusive_sentinel_list<Type, Hook>::front() const {
+	// Throw an underflow if the list is empty.
+	if (list_size == 0)
+		throw underflow();
+	return *object(list_head.next_hook);
+}
+
+template <typename Type, Intrusive_hook Type::*Hook>
+Type &Intrusive_sentinel_list<Type, Hook>::back() const {
+	// Throw an underflow if the list is empty.
+	if (list_size == 0)
+		throw underflow();
+	return *object(list_tail.previous_hook);
+}
+
+template <typename Type, Intrusive_hook Type::*Hook>
+typename Intrusive_sentinel_list<Type, Hook>::iterator Intrusive_sentinel_list<Type, Hook>::begin() {
+	return iterator(list_head.next_hook);
+}
+
+template <typename Type, Intrusive_hook Type::*Hook>
+typename Intrusive_sentinel_list<Type, Hook>::iterator Intrusive_sentinel_list<Type, Hook>::end() {
+	return iterator(&list_tail);
+}
+
+template <typename Type, Intrusive_hook Type::*Hook>
+typename Intrusive_sentinel_list<Type, Hook>::iterator Intrusive_sentinel_list<Type, Hook>::iterator_to(Type &obj) {
+	return iterator(&(obj.*Hook));
+}
+
+// Insert the object at the beginning of the list (after the list head sentinel).
+template <typename Type, Intrusive_hook Type::*Hook>
+void Intrusive_sentinel_list<Type, Hook>::push_front(Type &obj) {
+	link_before(list_head.next_hook, obj);
+}
+
+// Insert the object at the end of the list (before the list tail sentinel).
+template <typename Type, Intrusive_hook Type::*Hook>
+void Intrusive_sentinel_list<Type, Hook>::push_back(Type &obj) {
+	link_before(&list_tail, obj);
+}
+
+// Insert the object before the given position, and return an iterator to it.
+template <typename Type, Intrusive_hook Type::*Hook>
+typename Intrusive_sentinel_list<Type, Hook>::iterator Intrusive_sentinel_list<Type, Hook>::insert(iterator position, Type &obj) {
+	link_before(position.hook, obj);
+	return iterator(&(obj.*Hook));
+}
+
+// Unlink the object at the front of the list and return it.
+template <typename Type, Intrusive_hook Type::*Hook>
+Type &Intrusive_sentinel_list<Type, Hook>::pop_front() {
+	if (list_size == 0)
+		throw underflow();
+
+	Intrusive_hook *hook = list_head.next_hook;
+	hook->unlink();
+	return *object(hook);
+}
+
+// Unlink the object at the end of the list and return it.
+template <typename Type, Intrusive_hook Type::*Hook>
+Type &Intrusive_sentinel_list<Type, Hook>::pop_back() {
+	if (list_size == 0)
+		throw underflow();
+
+	Intrusive_hook *hook = list_tail.previous_hook;
+	hook->unlink();
+	return *object(hook);
+}
+
+// Unlink the object if it is on this list.
+template <typename Type, Intrusive_hook Type::*Hook>
+int Intrusive_sentinel_list<Type, Hook>::erase(Type &obj) {
+	Intrusive_hook &hook = obj.*Hook;
+
+	if (hook.owner_size != &list_size)
+		return 0;
+
+	hook.unlink();
+	return 1;
+}
+
+// Unlink the object at the given position, and return an iterator to the one after it.
+template <typename Type, Intrusive_hook Type::*Hook>
+typename Intrusive_sentinel_list<Type, Hook>::iterator Intrusive_sentinel_list<Type, Hook>::erase(iterator position) {
+	// The sentinels cannot be erased
+	if (position.hook == &list_head || position.hook == &list_tail)
+		throw illegal_argument();
+
+	Intrusive_hook *next = position.hook->next_hook;
+	position.hook->unlink();
+	return iterator(next);
+}
+
+// Move an object on this list to the front of the list.
+template <typename Type, Intrusive_hook Type::*Hook>
+void Intrusive_sentinel_list<Type, Hook>::move_to_front(Type &obj) {
+	Intrusive_hook &hook = obj.*Hook;
+
+	if (hook.owner_size != &list_size)
+		throw illegal_argument();
+
+	if (list_head.next_hook == &hook)
+		return;
+
+	// Unlink the hook
+	hook.previous_hook->next_hook = hook.next_hook;
+	hook.next_hook->previous_hook = hook.previous_hook;
+
+	// Relink it after the head sentinel
+	hook.previous_hook = &list_head;
+	hook.next_hook = list_head.next_hook;
+	list_head.next_hook->previous_hook = &hook;
+	list_head.next_hook = &hook;
+}
+
+// Unlink every object, leaving each hook ready to be linked again.
+template <typename Type, Intrusive_hook Type::*Hook>
+void Intrusive_sentinel_list<Type, Hook>::clear() {
+	Intrusive_hook *hook = list_head.next_hook;
+
+	while (hook != &list_tail) {
+		Intrusive_hook *next = hook->next_hook;
+		hook->previous_hook = hook->next_hook = nullptr;
+		hook->owner_size = nullptr;
+		hook = next;
+	}
+
+	list_head.next_hook = &list_tail;
+	list_tail.previous_hook = &list_head;
+	list_size = 0;
+}
+
+template <typename T, Intrusive_hook T::*H>
+std::ostream &operator<<(std::ostream &out, Intrusive_sentinel_list<T, H> const &list) {
+	out << "head->S";
+
+	for (Intrusive_hook *ptr = list.list_head.next_hook; ptr != &list.list_tail; ptr = ptr->next_hook) {
+		out << "->" << *Intrusive_sentinel_list<T, H>::object(ptr);
+	}
+
+	out << "->S->0";
+
+	return out;
+}
+
+#endif
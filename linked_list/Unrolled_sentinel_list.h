@@ -0,0 +1,632 @@
+/*
+* Unrolled_sentinel_list
+*
+* This class implements an unrolled doubly linked list with sentinel nodes:
+* a Double_sentinel_list whose nodes each hold up to K elements in an array
+* instead of one. Each node keeps its elements contiguous in the range
+* [first, last) of its array, so pushing at the back fills a node from the
+* left and pushing at the front fills a node from the right. A push into an
+* end node whose free slots are all at its other end first centres its range,
+* and a push into a full end node first moves half of its elements to a new
+* end node.
+*
+* Scans (count, erase, copy, print) walk arrays of elements rather than one
+* node per element, so they take roughly one cache miss per node instead of
+* one per element, and the two link pointers are shared by K elements. The
+* default K fills a node of about two cache lines.
+*
+* count and erase search each node's array with the vectorized search in
+* Simd_search.h, so arithmetic elements are compared 16 or 32 bytes at a time.
+*
+* Erasing an element shifts the shorter side of its node's range over by
+* one. After an erase or a pop, a node left less than half full is merged
+* with its next node (or its previous one, if it is the last node) when
+* their elements fit in one node, and otherwise takes elements from it until
+* the two are balanced. Every node but a lone one therefore stays at least
+* half full, and a scan of n elements visits at most about 2n/K nodes.
+* Pushes keep this too, since they only ever add a node by splitting a full one.
+*
+* ---------------------------------------------------------
+*                           Member Variables:
+*
+*  Unrolled_link *list_head           The head sentinel
+*  Unrolled_link *list_tail           The tail sentinel
+*  int list_size                      The number of elements in the list
+*  int node_count                     The number of (non-sentinel) nodes
+*
+*  K (template)                       The most elements a node can hold
+*
+* ---------------------------------------------------------
+*                   Member Functions (Accessors):
+*
+* int size() const
+* bool empty() const
+*
+* Type front() const
+* Type back() const
+*   Throw an underflow if the list is empty.
+*
+* int count(Type const &) const
+*   Returns the number of elements equal to the argument.
+*
+* int nodes() const
+*   Returns the number of nodes holding elements.
+*
+* ---------------------------------------------------------
+*                   Member Functions (Mutators):
+*
+* void push_front(Type const &)
+* void push_back(Type const &)
+*
+* Type pop_front()
+* Type pop_back()
+*   Throw an underflow if the list is empty.
+*
+* int erase(Type const &)
+*   Erases the first element equal to the argument; returns 1 if one was found, 0 otherwise.
+*
+* void clear()
+*
+* ---------------------------------------------------------
+*                   Instrumentation (DS_ENABLE_STATS, see Ds_stats.h):
+*
+* Unrolled_sentinel_list_stats stats() const
+*   Returns a snapshot of the size, the nodes and their mean fill, and how often each
+*   rebalancing step ran: pushes that centred or split an end node, and removals that
+*   merged two nodes or moved elements between them. Frequent borrows with few merges
+*   mean elements are being removed and added around the same node boundary.
+*/
+
+#ifndef UNROLLED_SENTINEL_LIST_H
+#define UNROLLED_SENTINEL_LIST_H
+
+#include <algorithm>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "ece250.h"
+#include "Exception.h"
+#include "Simd_search.h"
+#include "Ds_stats.h"
+
+#ifdef DS_ENABLE_STATS
+// A snapshot of the counters of an Unrolled_sentinel_list (see Ds_stats.h)
+struct Unrolled_sentinel_list_stats {
+	int size;
+	int nodes;
+	double mean_fill;				// Elements per node, as a fraction of K
+	long long node_allocations;
+	long long centres;				// Pushes that first centred the range of an end node
+	long long splits;				// Pushes that first split a full end node
+	long long merges;				// Removals that merged two nodes into one
+	long long borrows;				// Removals that moved elements between two nodes
+
+	Unrolled_sentinel_list_stats() :
+	size(0), nodes(0), mean_fill(0.0), node_allocations(0), centres(0), splits(0), merges(0), borrows(0) {
+		// Empty constructor
+	}
+};
+#endif
+
+struct Unrolled_link {
+	Unrolled_link *previous_node;
+	Unrolled_link *next_node;
+};
+
+template <typename Type, int K>
+struct Unrolled_node : Unrolled_link {
+	int first;
+	int last;
+	typename std::aligned_storage<sizeof(Type), alignof(Type)>::type slots[K];
+
+	Type *slot(int i) {
+		return reinterpret_cast<Type *>(slots + i);
+	}
+
+	Type const *slot(int i) const {
+		return reinterpret_cast<Type const *>(slots + i);
+	}
+};
+
+template <typename Type>
+struct Unrolled_default_capacity {
+	static int const value = (sizeof(Type) <= (128 - sizeof(Unrolled_link) - 2 * sizeof(int)) / 4)
+		? static_cast<int>((128 - sizeof(Unrolled_link) - 2 * sizeof(int)) / sizeof(Type)) : 4;
+};
+
+template <typename Type, int K = Unrolled_default_capacity<Type>::value>
+class Unrolled_sentinel_list {
+private:
+	static_assert(K >= 1, "a node must hold at least one element");
+
+	typedef Unrolled_node<Type, K> node;
+
+	Unrolled_link *list_head;
+	Unrolled_link *list_tail;
+	int list_size;
+	int node_count;
+#ifdef DS_ENABLE_STATS
+	Unrolled_sentinel_list_stats statistics;
+#endif
+
+	static node *as_node(Unrolled_link *);
+	static node const *as_node(Unrolled_link const *);
+	node *link_node(Unrolled_link *, int);
+	void unlink_node(node *);
+	static void relocate(Type *, Type *);
+	static void shift_range(node *, int);
+	void rebalance(node *);
+
+public:
+	Unrolled_sentinel_list();
+	Unrolled_sentinel_list(Unrolled_sentinel_list const &);
+	~Unrolled_sentinel_list();
+
+	// Accessors
+
+	int size() const;
+	bool empty() const;
+	int nodes() const;
+#ifdef DS_ENABLE_STATS
+	Unrolled_sentinel_list_stats stats() const;
+#endif
+
+	Type front() const;
+	Type back() const;
+
+	int count(Type const &) const;
+
+	// Mutators
+
+	void swap(Unrolled_sentinel_list &);
+	Unrolled_sentinel_list &operator=(Unrolled_sentinel_list const &);
+
+	void push_front(Type const &);
+	void push_back(Type const &);
+
+	Type pop_front();
+	Type pop_back();
+
+	int erase(Type const &);
+	void clear();
+
+	// Friends
+
+	template <typename T, int N>
+	friend std::ostream &operator<<(std::ostream &, Unrolled_sentinel_list<T, N> const &);
+};
+
+// Constructor: Create an empty list with a sentinel head and tail that point to each other.
+template <typename Type, int K>
+Unrolled_sentinel_list<Type, K>::Unrolled_sentinel_list() :
+list_head(new Unrolled_link()),
+list_tail(new Unrolled_link()),
+list_size(0),
+node_count(0) {
+	list_head->previous_node = nullptr;
+	list_head->next_node = list_tail;
+	list_tail->previous_node = list_head;
+	list_tail->next_node = nullptr;
+}
+
+// Copy Constructor: Copy the list node by node, each array with its elements in the same slots.
+template <typename Type, int K>
+Unrolled_sentinel_list<Type, K>::Unrolled_sentinel_list(Unrolled_sentinel_list<Type, K> const &list) :
+list_head(new Unrolled_link()),
+list_tail(new Unrolled_link()),
+list_size(0),
+node_count(0) {
+	list_head->previous_node = nullptr;
+	list_head->next_node = list_tail;
+	list_tail->previous_node = list_head;
+	list_tail->next_node = nullptr;
+
+	for (Unrolled_link const *ptr = list.list_head->next_node; ptr != list.list_tail; ptr = ptr->next_node) {
+		node const *source = as_node(ptr);
+		node *temp = link_node(list_tail, source->first);
+
+		for (int i = source->first; i < source->last; ++i) {
+			new (temp->slot(i)) Type(*source->slot(i));
+			temp->last++;
+			list_size++;
+		}
+	}
+}
+
+// Destructor: Destroy every element, then delete every node and both sentinels.
+template <typename Type, int K>
+Unrolled_sentinel_list<Type, K>::~Unrolled_sentinel_list() {
+	clear();
+	delete list_head;
+	delete list_tail;
+}
+
+template <typename Type, int K>
+typename Unrolled_sentinel_list<Type, K>::node *Unrolled_sentinel_list<Type, K>::as_node(Unrolled_link *ptr) {
+	return static_cast<node *>(ptr);
+}
+
+template <typename Type, int K>
+typename Unrolled_sentinel_list<Type, K>::node const *Unrolled_sentinel_list<Type, K>::as_node(Unrolled_link const *ptr) {
+	return static_cast<node const *>(ptr);
+}
+
+// Links a new, empty node in before the given node, with its range starting at index
+template <typename Type, int K>
+typename Unrolled_sentinel_list<Type, K>::node *Unrolled_sentinel_list<Type, K>::link_node(Unrolled_link *position, int index) {
+	node *temp = new node;
+	temp->first = temp->last = index;
+
+	temp->previous_node = position->previous_node;
+	temp->next_node = position;
+	position->previous_node->next_node = temp;
+	position->previous_node = temp;
+
+	node_count++;
+	DS_STATS(statistics.node_allocations++;)
+	return temp;
+}
+
+// Unlinks and deletes a node whose elements have all been destroyed
+template <typename Type, int K>
+void Unrolled_sentinel_list<Type, K>::unlink_node(node *ptr) {
+	ptr->previous_node->next_node = ptr->next_node;
+	ptr->next_node->previous_node = ptr->previous_node;
+	delete ptr;
+	node_count--;
+}
+
+// Moves an element into an empty slot, leaving its old slot empty
+template <typename Type, int K>
+void Unrolled_sentinel_list<Type, K>::relocate(Type *from, Type *to) {
+	new (to) Type(std::move(*from));
+	from->~Type();
+}
+
+// Moves the elements of a node within its array so that its range starts at index
+template <typename Type, int K>
+void Unrolled_sentinel_list<Type, K>::shift_range(node *ptr, int index) {
+	int n = ptr->last - ptr->first;
+
+	// Move towards the end of the range first, so that no element is overwritten
+	if (index < ptr->first) {
+		for (int i = 0; i < n; ++i) {
+			relocate(ptr->slot(ptr->first + i), ptr->slot(index + i));
+		}
+	}
+	else if (index > ptr->first) {
+		for (int i = n - 1; i >= 0; --i) {
+			relocate(ptr->slot(ptr->first + i), ptr->slot(index + i));
+		}
+	}
+
+	ptr->first = index;
+	ptr->last = index + n;
+}
+
+// Restores the occupancy of a node that an element was just removed from: an empty
+// node is freed, and one less than half full is merged with or borrows from a neighbour
+template <typename Type, int K>
+void Unrolled_sentinel_list<Type, K>::rebalance(node *ptr) {
+	if (ptr->first == ptr->last) {
+		unlink_node(ptr);
+		return;
+	}
+
+	if (ptr->last - ptr->first >= K / 2)
+		return;
+
+	// Pair the node with the next one, or with the previous one if it is the last node
+	node *left;
+	node *right;
+
+	if (ptr->next_node != list_tail) {
+		left = ptr;
+		right = as_node(ptr->next_node);
+	}
+	else if (ptr->previous_node != list_head) {
+		left = as_node(ptr->previous_node);
+		right = ptr;
+	}
+	else {
+		// A lone node may hold any number of elements
+		return;
+	}
+
+	int left_count = left->last - left->first;
+	int right_count = right->last - right->first;
+	int total = left_count + right_count;
+
+	if (total <= K) {
+		// Merge: make room after the left node's elements and move the right node's into it
+		shift_range(left, std::min(left->first, K - total));
+
+		for (int i = right->first; i < right->last; ++i) {
+			relocate(right->slot(i), left->slot(left->last++));
+		}
+
+		unlink_node(right);
+		DS_STATS(statistics.merges++;)
+		return;
+	}
+
+	// Borrow: move elements across the boundary until the left node holds half of them
+	int target = total / 2;
+	DS_STATS(statistics.borrows++;)
+
+	if (left_count < target) {
+		shift_range(left, 0);
+
+		while (left->last - left->first < target) {
+			relocate(right->slot(right->first++), left->slot(left->last++));
+		}
+	}
+	else {
+		shift_range(right, K - right_count);
+
+		while (left->last - left->first > target) {
+			relocate(left->slot(--left->last), right->slot(--right->first));
+		}
+	}
+}
+
+template <typename Type, int K>
+int Unrolled_sentinel_list<Type, K>::size() const {
+	return list_size;
+}
+
+template <typename Type, int K>
+bool Unrolled_sentinel_list<Type, K>::empty() const {
+	return (list_size == 0);
+}
+
+template <typename Type, int K>
+int Unrolled_sentinel_list<Type, K>::nodes() const {
+	return node_count;
+}
+
+#ifdef DS_ENABLE_STATS
+// Returns the event counters together with the current size and nodes
+template <typename Type, int K>
+Unrolled_sentinel_list_stats Unrolled_sentinel_list<Type, K>::stats() const {
+	Unrolled_sentinel_list_stats snapshot = statistics;
+	snapshot.size = list_size;
+	snapshot.nodes = node_count;
+	snapshot.mean_fill = (node_count == 0) ? 0.0 : static_cast<double>(list_size) / (static_cast<double>(node_count) * K);
+	return snapshot;
+}
+#endif
+
+// Returns the first element of the first node
+template <typename Type, int K>
+Type Unrolled_sentinel_list<Type, K>::front() const {
+	// Throw an underflow if the list is empty.
+	if (list_size == 0)
+		throw underflow();
+	node const *temp = as_node(list_head->next_node);
+	return *temp->slot(temp->first);
+}
+
+// Returns the last element of the last node
+template <typename Type, int K>
+Type Unrolled_sentinel_list<Type, K>::back() const {
+	// Throw an underflow if the list is empty.
+	if (list_size == 0)
+		throw underflow();
+	node const *temp = as_node(list_tail->previous_node);
+	return *temp->slot(temp->last - 1);
+}
+
+// Returns the number of elements equal to the argument, scanning each node's array in turn
+template <typename Type, int K>
+int Unrolled_sentinel_list<Type, K>::count(Type const &obj) const {
+	int count = 0;
+
+	for (Unrolled_link const *ptr = list_head->next_node; ptr != list_tail; ptr = ptr->next_node) {
+		node const *temp = as_node(ptr);
+		count += simd_count(temp->slot(temp->first), temp->last - temp->first, obj);
+	}
+
+	return count;
+}
+
+// Swaps two existing lists with each other, including all nodes inside.
+template <typename Type, int K>
+void Unrolled_sentinel_list<Type, K>::swap(Unrolled_sentinel_list<Type, K> &list) {
+	std::swap(list_head, list.list_head);
+	std::swap(list_tail, list.list_tail);
+	std::swap(list_size, list.list_size);
+	std::swap(node_count, list.node_count);
+	DS_STATS(std::swap(statistics, list.statistics);)
+}
+
+template <typename Type, int K>
+Unrolled_sentinel_list<Type, K> &Unrolled_sentinel_list<Type, K>::operator=(Unrolled_sentinel_list<Type, K> const &rhs) {
+	Unrolled_sentinel_list<Type, K> copy(rhs);
+
+	swap(copy);
+
+	return *this;
+}
+
+// Insert an element at the front of the first node, making room at its left end if need be.
+template <typename Type, int K>
+void Unrolled_sentinel_list<Type, K>::push_front(Type const &obj) {
+	node *temp = (list_size == 0) ? nullptr : as_node(list_head->next_node);
+
+	if (temp == nullptr) {
+		// The new node fills from the right, so that further pushes at the front can use it
+		temp = link_node(list_head->next_node, K);
+	}
+	else if (temp->first == 0) {
+		if (temp->last < K) {
+			// The free slots are all at the right end: centre the range to open some at the left
+			shift_range(temp, (K - temp->last + 1) / 2);
+			DS_STATS(statistics.centres++;)
+		}
+		else {
+			// The node is full: move its front half into a new first node
+			node *full = temp;
+			temp = link_node(list_head->next_node, K);
+
+			for (int i = K / 2 - 1; i >= 0; --i) {
+				relocate(full->slot(i), temp->slot(--temp->first));
+			}
+
+			full->first = K / 2;
+			DS_STATS(statistics.splits++;)
+		}
+	}
+
+	new (temp->slot(temp->first - 1)) Type(obj);
+	temp->first--;
+	list_size++;
+}
+
+// Insert an element at the back of the last node, making room at its right end if need be.
+template <typename Type, int K>
+void Unrolled_sentinel_list<Type, K>::push_back(Type const &obj) {
+	node *temp = (list_size == 0) ? nullptr : as_node(list_tail->previous_node);
+
+	if (temp == nullptr) {
+		// The new node fills from the left, so that further pushes at the back can use it
+		temp = link_node(list_tail, 0);
+	}
+	else if (temp->last == K) {
+		if (temp->first > 0) {
+			// The free slots are all at the left end: centre the range to open some at the right
+			shift_range(temp, temp->first / 2);
+			DS_STATS(statistics.centres++;)
+		}
+		else {
+			// The node is full: move its back half into a new last node
+			node *full = temp;
+			temp = link_node(list_tail, 0);
+
+			for (int i = K - K / 2; i < K; ++i) {
+				relocate(full->slot(i), temp->slot(temp->last++));
+			}
+
+			full->last = K - K / 2;
+			DS_STATS(statistics.splits++;)
+		}
+	}
+
+	new (temp->slot(temp->last)) Type(obj);
+	temp->last++;
+	list_size++;
+}
+
+// Remove the first element, then rebalance its node.
+template <typename Type, int K>
+Type Unrolled_sentinel_list<Type, K>::pop_front() {
+	if (list_size == 0)
+		throw underflow();
+
+	node *temp = as_node(list_head->next_node);
+	Type *slot = temp->slot(temp->first);
+	Type tempreturn(std::move(*slot));
+	slot->~Type();
+	temp->first++;
+	list_size--;
+
+	rebalance(temp);
+
+	return tempreturn;
+}
+
+// Remove the last element, then rebalance its node.
+template <typename Type, int K>
+Type Unrolled_sentinel_list<Type, K>::pop_back() {
+	if (list_size == 0)
+		throw underflow();
+
+	node *temp = as_node(list_tail->previous_node);
+	Type *slot = temp->slot(temp->last - 1);
+	Type tempreturn(std::move(*slot));
+	slot->~Type();
+	temp->last--;
+	list_size--;
+
+	rebalance(temp);
+
+	return tempreturn;
+}
+
+// Erase the first element that matches the argument.
+template <typename Type, int K>
+int Unrolled_sentinel_list<Type, K>::erase(Type const &obj) {
+	for (Unrolled_link *ptr = list_head->next_node; ptr != list_tail; ptr = ptr->next_node) {
+		node *temp = as_node(ptr);
+		int i = temp->first + simd_find(temp->slot(temp->first), temp->last - temp->first, obj);
+
+		if (i < temp->last) {
+			// Close the gap by shifting whichever side of the range is shorter
+			if (i - temp->first < temp->last - 1 - i) {
+				for (int j = i; j > temp->first; --j) {
+					*temp->slot(j) = std::move(*temp->slot(j - 1));
+				}
+				temp->slot(temp->first)->~Type();
+				temp->first++;
+			}
+			else {
+				for (int j = i; j < temp->last - 1; ++j) {
+					*temp->slot(j) = std::move(*temp->slot(j + 1));
+				}
+				temp->slot(temp->last - 1)->~Type();
+				temp->last--;
+			}
+
+			list_size--;
+			rebalance(temp);
+
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+// Destroy every element and delete every node, leaving only the sentinels.
+template <typename Type, int K>
+void Unrolled_sentinel_list<Type, K>::clear() {
+	Unrolled_link *ptr = list_head->next_node;
+
+	while (ptr != list_tail) {
+		node *temp = as_node(ptr);
+		ptr = ptr->next_node;
+
+		for (int i = temp->first; i < temp->last; ++i) {
+			temp->slot(i)->~Type();
+		}
+		delete temp;
+	}
+
+	list_head->next_node = list_tail;
+	list_tail->previous_node = list_head;
+	list_size = 0;
+	node_count = 0;
+}
+
+template <typename T, int N>
+std::ostream &operator<<(std::ostream &out, Unrolled_sentinel_list<T, N> const &list) {
+	typedef Unrolled_node<T, N> node;
+
+	out << "head->S";
+
+	for (Unrolled_link const *ptr = list.list_head->next_node; ptr != list.list_tail; ptr = ptr->next_node) {
+		node const *temp = static_cast<node const *>(ptr);
+
+		out << "->[ ";
+		for (int i = temp->first; i < temp->last; ++i) {
+			out << *temp->slot(i) << " ";
+		}
+		out << "]";
+	}
+
+	out << "->S->0";
+
+	return out;
+}
+
+#endif
@@ -0,0 +1,408 @@
+/*
+* Array_stack
+*
+* This class implements a stack with the same interface as Linked_stack,
+* stored in a single contiguous array instead of a list of chunks, so top()
+* is one indexed load rather than two pointer hops.
+*
+* The first INLINE_CAPACITY elements are stored inside the stack object
+* itself, so a short-lived stack that never grows past them never touches
+* the heap. Beyond that the elements move to raw storage on the heap, which
+* doubles whenever it fills. Elements are only constructed while they are on
+* the stack, are moved (or, for trivially copyable types, copied with memcpy)
+* when the array grows, and are moved out by pop().
+*
+* ---------------------------------------------------------
+*                           Member Variables:
+*
+*  Type *array                        The elements: either the inline buffer or a heap array
+*  int   array_capacity               The number of elements array has room for
+*  int   stack_size                   The number of elements on the stack
+*
+*  inline_buffer                      Raw storage for INLINE_CAPACITY elements
+*
+*  INLINE_CAPACITY (template)         The default fills about 128 bytes, and is at least one.
+*
+* ---------------------------------------------------------
+*                   Member Functions (Accessors):
+*
+* bool empty() const
+* int size() const
+*
+* int capacity() const
+*   Returns the number of elements the stack can hold before it next grows.
+*
+* Type const &top() const
+*   Returns the element at the top of the stack. Throws an underflow if the stack is empty.
+*
+* ---------------------------------------------------------
+*                   Member Functions (Mutators):
+*
+* void push(Type const &);
+* void push(Type &&);
+* void emplace(Args &&...);
+*   Adds an element to the top of the stack.
+*
+* Type pop();
+*   Removes the element at the top of the stack and returns it.
+*   Throws an underflow if the stack is empty.
+*
+* void reserve(int);
+*   Grows the array, if necessary, to hold at least n elements.
+*
+* void clear();
+*   Destroys every element, keeping the array.
+*
+* ---------------------------------------------------------
+*                   Instrumentation (DS_ENABLE_STATS, see Ds_stats.h):
+*
+* Array_stack_stats stats() const
+*   Returns a snapshot of the size and capacity, the peak size, and how many times
+*   the elements moved to a larger heap array. If most stacks never leave the inline
+*   buffer, heap_allocations stays at zero; if they all do, INLINE_CAPACITY is too small.
+*/
+
+#ifndef ARRAY_STACK_H
+#define ARRAY_STACK_H
+
+#include <algorithm>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "ece250.h"
+#include "Exception.h"
+#include "Ds_stats.h"
+
+#ifdef DS_ENABLE_STATS
+// A snapshot of the counters of an Array_stack (see Ds_stats.h)
+struct Array_stack_stats {
+	int size;
+	int capacity;
+	int peak_size;
+	bool inline_storage;			// The elements are still in the inline buffer
+	int heap_allocations;			// Heap arrays allocated, by growth or by reserve()
+	long long bytes_allocated;		// Total size of those arrays
+	long long pushes;
+	long long pops;
+
+	Array_stack_stats() :
+	size(0), capacity(0), peak_size(0), inline_storage(true), heap_allocations(0),
+	bytes_allocated(0), pushes(0), pops(0) {
+		// Empty constructor
+	}
+};
+#endif
+
+template <typename Type>
+struct Array_stack_default_capacity {
+	static int const value = (sizeof(Type) < 128) ? static_cast<int>(128 / sizeof(Type)) : 1;
+};
+
+template <typename Type, int INLINE_CAPACITY = Array_stack_default_capacity<Type>::value>
+class Array_stack {
+private:
+	static_assert(INLINE_CAPACITY >= 1, "the inline buffer must hold at least one element");
+
+	Type *array;
+	int array_capacity;
+	int stack_size;
+	typename std::aligned_storage<sizeof(Type), alignof(Type)>::type inline_buffer[INLINE_CAPACITY];
+#ifdef DS_ENABLE_STATS
+	Array_stack_stats statistics;
+#endif
+
+	Type *inline_array();
+	bool is_inline() const;
+	static void relocate(Type *, Type *, int, std::true_type);
+	static void relocate(Type *, Type *, int, std::false_type);
+	void resize(int);
+	void release();
+	void take(Array_stack &);
+
+public:
+	Array_stack();
+	Array_stack(Array_stack const &);
+	Array_stack(Array_stack &&);
+	~Array_stack();
+
+	bool empty() const;
+	int size() const;
+	int capacity() const;
+#ifdef DS_ENABLE_STATS
+	Array_stack_stats stats() const;
+#endif
+
+	Type const &top() const;
+
+	void swap(Array_stack &);
+	Array_stack &operator=(Array_stack);
+	void push(Type const &);
+	void push(Type &&);
+	template <typename... Args>
+	void emplace(Args &&...);
+	Type pop();
+	void reserve(int);
+	void clear();
+
+	// Friends
+
+	template <typename T, int N>
+	friend std::ostream &operator<<(std::ostream &, Array_stack<T, N> const &);
+};
+
+template <typename Type, int INLINE_CAPACITY>
+Array_stack<Type, INLINE_CAPACITY>::Array_stack() :
+array(inline_array()),
+array_capacity(INLINE_CAPACITY),
+stack_size(0) {
+	// Empty constructor
+}
+
+// Copy Constructor: copies each element into a buffer just large enough for them
+template <typename Type, int INLINE_CAPACITY>
+Array_stack<Type, INLINE_CAPACITY>::Array_stack(Array_stack const &stack) :
+array(inline_array()),
+array_capacity(INLINE_CAPACITY),
+stack_size(0) {
+	reserve(stack.stack_size);
+
+	for (int i = 0; i < stack.stack_size; ++i) {
+		new (array + i) Type(stack.array[i]);
+		stack_size++;
+	}
+}
+
+// Move Constructor: takes the heap array, or moves the elements out of the inline buffer
+template <typename Type, int INLINE_CAPACITY>
+Array_stack<Type, INLINE_CAPACITY>::Array_stack(Array_stack &&stack) :
+array(inline_array()),
+array_capacity(INLINE_CAPACITY),
+stack_size(0) {
+	take(stack);
+}
+
+// Destructor: destroys the elements and frees the heap array, if there is one
+template <typename Type, int INLINE_CAPACITY>
+Array_stack<Type, INLINE_CAPACITY>::~Array_stack() {
+	release();
+}
+
+template <typename Type, int INLINE_CAPACITY>
+Type *Array_stack<Type, INLINE_CAPACITY>::inline_array() {
+	return reinterpret_cast<Type *>(inline_buffer);
+}
+
+template <typename Type, int INLINE_CAPACITY>
+bool Array_stack<Type, INLINE_CAPACITY>::is_inline() const {
+	return array == reinterpret_cast<Type const *>(inline_buffer);
+}
+
+// Moves n elements to uninitialized storage, leaving the source slots unconstructed
+template <typename Type, int INLINE_CAPACITY>
+void Array_stack<Type, INLINE_CAPACITY>::relocate(Type *destination, Type *source, int n, std::true_type) {
+	if (n > 0) std::memcpy(static_cast<void *>(destination), static_cast<void const *>(source), n * sizeof(Type));
+}
+
+template <typename Type, int INLINE_CAPACITY>
+void Array_stack<Type, INLINE_CAPACITY>::relocate(Type *destination, Type *source, int n, std::false_type) {
+	for (int i = 0; i < n; ++i) {
+		new (destination + i) Type(std::move(source[i]));
+		source[i].~Type();
+	}
+}
+
+// Moves the elements to a heap array with room for new_capacity elements
+template <typename Type, int INLINE_CAPACITY>
+void Array_stack<Type, INLINE_CAPACITY>::resize(int new_capacity) {
+	Type *temp_array = static_cast<Type *>(::operator new(new_capacity * sizeof(Type)));
+	relocate(temp_array, array, stack_size, std::is_trivially_copyable<Type>());
+
+	if (!is_inline())
+		::operator delete(array);
+
+	array = temp_array;
+	array_capacity = new_capacity;
+	DS_STATS(statistics.heap_allocations++; statistics.bytes_allocated += static_cast<long long>(new_capacity) * sizeof(Type);)
+}
+
+// Destroys the elements and frees the heap array, returning to the empty inline buffer
+template <typename Type, int INLINE_CAPACITY>
+void Array_stack<Type, INLINE_CAPACITY>::release() {
+	clear();
+
+	if (!is_inline())
+		::operator delete(array);
+
+	array = inline_array();
+	array_capacity = INLINE_CAPACITY;
+}
+
+// Replaces the contents of this stack with those of the argument, leaving it empty
+template <typename Type, int INLINE_CAPACITY>
+void Array_stack<Type, INLINE_CAPACITY>::take(Array_stack &stack) {
+	release();
+
+	if (stack.is_inline()) {
+		relocate(array, stack.array, stack.stack_size, std::is_trivially_copyable<Type>());
+	}
+	else {
+		array = stack.array;
+		array_capacity = stack.array_capacity;
+		stack.array = stack.inline_array();
+		stack.array_capacity = INLINE_CAPACITY;
+	}
+
+	stack_size = stack.stack_size;
+	stack.stack_size = 0;
+}
+
+template <typename Type, int INLINE_CAPACITY>
+bool Array_stack<Type, INLINE_CAPACITY>::empty() const {
+	return (stack_size == 0);
+}
+
+template <typename Type, int INLINE_CAPACITY>
+int Array_stack<Type, INLINE_CAPACITY>::size() const {
+	return stack_size;
+}
+
+template <typename Type, int INLINE_CAPACITY>
+int Array_stack<Type, INLINE_CAPACITY>::capacity() const {
+	return array_capacity;
+}
+
+#ifdef DS_ENABLE_STATS
+// Returns the event counters together with the current size and storage
+template <typename Type, int INLINE_CAPACITY>
+Array_stack_stats Array_stack<Type, INLINE_CAPACITY>::stats() const {
+	Array_stack_stats snapshot = statistics;
+	snapshot.size = stack_size;
+	snapshot.capacity = array_capacity;
+	snapshot.inline_storage = is_inline();
+	return snapshot;
+}
+#endif
+
+// Returns the element at the top of the stack
+template <typename Type, int INLINE_CAPACITY>
+Type const &Array_stack<Type, INLINE_CAPACITY>::top() const {
+	if (empty()) // if the stack is empty, throws an underflow error
+		throw underflow();
+	return array[stack_size - 1];
+}
+
+// Swapping two heap arrays swaps pointers; an inline buffer has to be moved element by element
+template <typename Type, int INLINE_CAPACITY>
+void Array_stack<Type, INLINE_CAPACITY>::swap(Array_stack<Type, INLINE_CAPACITY> &stack) {
+	if (this == &stack)
+		return;
+
+	if (!is_inline() && !stack.is_inline()) {
+		std::swap(array, stack.array);
+		std::swap(array_capacity, stack.array_capacity);
+		std::swap(stack_size, stack.stack_size);
+	}
+	else {
+		Array_stack<Type, INLINE_CAPACITY> temp(std::move(stack));
+		stack.take(*this);
+		take(temp);
+	}
+
+	DS_STATS(std::swap(statistics, stack.statistics);)
+}
+
+template <typename Type, int INLINE_CAPACITY>
+Array_stack<Type, INLINE_CAPACITY> &Array_stack<Type, INLINE_CAPACITY>::operator=(Array_stack<Type, INLINE_CAPACITY> rhs) {
+	swap(rhs);
+
+	return *this;
+}
+
+// Pushes a new element to the top of the stack
+template <typename Type, int INLINE_CAPACITY>
+void Array_stack<Type, INLINE_CAPACITY>::push(Type const &obj) {
+	emplace(obj);
+}
+
+template <typename Type, int INLINE_CAPACITY>
+void Array_stack<Type, INLINE_CAPACITY>::push(Type &&obj) {
+	emplace(std::move(obj));
+}
+
+template <typename Type, int INLINE_CAPACITY>
+template <typename... Args>
+void Array_stack<Type, INLINE_CAPACITY>::emplace(Args &&... args) {
+	// If the array is full, construct the element in the new array first,
+	// since the arguments may refer to an element of the old one
+	if (stack_size == array_capacity) {
+		int new_capacity = 2 * array_capacity;
+		Type *temp_array = static_cast<Type *>(::operator new(new_capacity * sizeof(Type)));
+
+		try {
+			new (temp_array + stack_size) Type(std::forward<Args>(args)...);
+		}
+		catch (...) {
+			::operator delete(temp_array);
+			throw;
+		}
+
+		relocate(temp_array, array, stack_size, std::is_trivially_copyable<Type>());
+		if (!is_inline())
+			::operator delete(array);
+
+		array = temp_array;
+		array_capacity = new_capacity;
+		DS_STATS(statistics.heap_allocations++; statistics.bytes_allocated += static_cast<long long>(new_capacity) * sizeof(Type);)
+	}
+	else {
+		new (array + stack_size) Type(std::forward<Args>(args)...);
+	}
+
+	stack_size++;
+	DS_STATS(statistics.pushes++; statistics.peak_size = std::max(statistics.peak_size, stack_size);)
+}
+
+// Removes the element at the top of the stack and returns it
+template <typename Type, int INLINE_CAPACITY>
+Type Array_stack<Type, INLINE_CAPACITY>::pop() {
+	if (empty()) // Throw an underflow if the stack is empty
+		throw underflow();
+
+	stack_size--;
+	Type temp(std::move(array[stack_size]));
+	array[stack_size].~Type();
+	DS_STATS(statistics.pops++;)
+
+	return temp;
+}
+
+template <typename Type, int INLINE_CAPACITY>
+void Array_stack<Type, INLINE_CAPACITY>::reserve(int n) {
+	if (n > array_capacity)
+		resize(n);
+}
+
+template <typename Type, int INLINE_CAPACITY>
+void Array_stack<Type, INLINE_CAPACITY>::clear() {
+	for (int i = 0; i < stack_size; ++i) {
+		array[i].~Type();
+	}
+	stack_size = 0;
+}
+
+// Prints the stack from the top down
+template <typename T, int N>
+std::ostream &operator<<(std::ostream &out, Array_stack<T, N> const &stack) {
+	out << "->[ ";
+
+	for (int i = stack.stack_size - 1; i >= 0; --i) {
+		out << stack.array[i] << " ";
+	}
+
+	out << "]";
+
+	return out;
+}
+
+#endif
@@ -0,0 +1,335 @@
+/*
+* Elimination_stack
+*
+* This class implements a lock-free stack with elimination backoff, after
+* Hendler, Shavit and Yerushalmi. It is a Treiber_stack whose threads, when
+* they lose the compare-and-swap on the top, back off to an elimination array
+* instead of retrying straight away.
+*
+* A push and a pop that meet in the elimination array cancel out: the pushing
+* thread offers its node in a random slot and waits briefly; a popping thread
+* that finds an offer claims the node by replacing it with a TAKEN marker, and
+* neither thread touches the top of the stack. Under heavy contention most
+* operations complete this way, so throughput keeps growing with the number of
+* threads instead of collapsing on the single top pointer. An offer that is
+* not taken in time is withdrawn and the push goes back to the stack.
+*
+* ---------------------------------------------------------
+*                           Member Variables:
+*
+*  Tagged_node_stack stack            The elements, top first (see Treiber_stack.h)
+*  Tagged_node_stack free_nodes       Popped nodes waiting to be reused
+*  std::atomic<int>  stack_size       The number of elements on the stack
+*
+*  Elimination_slot *slots            The elimination array, one slot per cache line
+*  int slot_count                     The number of slots
+*
+* ---------------------------------------------------------
+*                   Member Functions:
+*
+* Elimination_stack(int threads = hardware_concurrency)
+*   Creates an elimination array with one slot for every two threads.
+*
+* void push(Type const &);
+* void push(Type &&);
+* void emplace(Args &&...);
+*   Adds an element to the top of the stack.
+*
+* bool try_pop(Type &);
+*   Moves the top of the stack into the argument. Returns false if the stack is empty.
+*
+* Type pop();
+*   Removes the top of the stack and returns it. Throws an underflow if the stack is empty.
+*
+* int size() const;
+* bool empty() const;
+*   Approximate while other threads are active.
+*
+* ---------------------------------------------------------
+*                   Instrumentation (DS_ENABLE_STATS, see Ds_stats.h):
+*
+* Elimination_stack_stats stats() const
+*   As Treiber_stack_stats, plus the pushes and pops that met in the elimination
+*   array, and the offers that were withdrawn because no pop came in time. Few
+*   eliminations against many withdrawn offers mean the array has too many slots
+*   for the pushes and pops to find each other.
+*/
+
+#ifndef ELIMINATION_STACK_H
+#define ELIMINATION_STACK_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <thread>
+#include <utility>
+#include "ece250.h"
+#include "Exception.h"
+#include "Cache_aligned.h"
+#include "Treiber_stack.h"
+#include "Thread_random.h"
+#include "Ds_stats.h"
+
+#ifdef DS_ENABLE_STATS
+// A snapshot of the counters of an Elimination_stack (see Ds_stats.h)
+struct Elimination_stack_stats {
+	int size;
+	Ds_counter pushes;
+	Ds_counter pops;
+	Ds_counter empty_pops;			// Pops that found the stack empty
+	Ds_counter node_allocations;	// Pushes that found no free node to reuse
+	long long cas_retries;			// Failed compare-and-swaps on the top of the stack
+	Ds_counter eliminations;		// Push and pop pairs that met in the elimination array
+	Ds_counter withdrawn_offers;	// Offers no pop took before the push gave up waiting
+
+	Elimination_stack_stats() :
+	size(0), cas_retries(0) {
+		// Empty constructor
+	}
+};
+#endif
+
+template <typename Type>
+struct alignas(64) Elimination_slot : Cache_aligned {
+	std::atomic<Treiber_stack_node<Type> *> offer;
+};
+
+template <typename Type>
+class Elimination_stack : public Cache_aligned {
+private:
+	typedef Treiber_stack_node<Type> node;
+
+	// The number of times a pushing thread checks its slot before withdrawing the offer
+	static int const ELIMINATION_SPINS = 128;
+
+	alignas(64) Tagged_node_stack<node> stack;
+	alignas(64) Tagged_node_stack<node> free_nodes;
+	alignas(64) std::atomic<int> stack_size;
+
+	Elimination_slot<Type> *slots;
+	int slot_count;
+#ifdef DS_ENABLE_STATS
+	alignas(64) Elimination_stack_stats statistics;
+#endif
+
+	// Do not implement these functions!
+	// The stack is shared between threads and can be neither copied nor assigned
+	Elimination_stack(Elimination_stack const &);
+	Elimination_stack &operator=(Elimination_stack const &);
+
+	static node *taken();
+	Elimination_slot<Type> &random_slot();
+	bool exchange_push(node *);
+	node *exchange_pop();
+	void push_node(node *);
+	node *pop_node();
+
+public:
+	Elimination_stack(int = std::thread::hardware_concurrency());
+	~Elimination_stack();
+
+	int size() const;
+	bool empty() const;
+#ifdef DS_ENABLE_STATS
+	Elimination_stack_stats stats() const;
+#endif
+
+	void push(Type const &);
+	void push(Type &&);
+	template <typename... Args>
+	void emplace(Args &&...);
+	bool try_pop(Type &);
+	Type pop();
+};
+
+template <typename Type>
+Elimination_stack<Type>::Elimination_stack(int threads) :
+stack_size(0),
+slots(nullptr),
+slot_count(std::max(threads / 2, 1)) {
+	slots = new Elimination_slot<Type>[slot_count];
+
+	for (int i = 0; i < slot_count; ++i) {
+		slots[i].offer.store(nullptr, std::memory_order_relaxed);
+	}
+}
+
+// Destructor: destroys the elements still on the stack, then frees every node
+template <typename Type>
+Elimination_stack<Type>::~Elimination_stack() {
+	while (node *ptr = stack.pop()) {
+		ptr->element()->~Type();
+		delete ptr;
+	}
+
+	while (node *ptr = free_nodes.pop()) {
+		delete ptr;
+	}
+
+	delete[] slots;
+}
+
+// The marker a popping thread leaves in a slot whose offer it has claimed
+template <typename Type>
+typename Elimination_stack<Type>::node *Elimination_stack<Type>::taken() {
+	return reinterpret_cast<node *>(static_cast<std::uintptr_t>(1));
+}
+
+// Returns a random slot
+template <typename Type>
+Elimination_slot<Type> &Elimination_stack<Type>::random_slot() {
+	return slots[thread_random() % static_cast<unsigned>(slot_count)];
+}
+
+// Offers the node to a popping thread; returns true if one took it
+template <typename Type>
+bool Elimination_stack<Type>::exchange_push(node *ptr) {
+	Elimination_slot<Type> &slot = random_slot();
+
+	// Another push is already waiting in this slot
+	node *expected = nullptr;
+	if (!slot.offer.compare_exchange_strong(expected, ptr, std::memory_order_release, std::memory_order_relaxed))
+		return false;
+
+	for (int i = 0; i < ELIMINATION_SPINS; ++i) {
+		if (slot.offer.load(std::memory_order_relaxed) == taken())
+			break;
+	}
+
+	// Withdraw the offer; if that fails a popping thread has taken the node
+	expected = ptr;
+	if (slot.offer.compare_exchange_strong(expected, nullptr, std::memory_order_relaxed)) {
+		DS_STATS(statistics.withdrawn_offers.add();)
+		return false;
+	}
+
+	slot.offer.store(nullptr, std::memory_order_relaxed);
+	DS_STATS(statistics.eliminations.add();)
+	return true;
+}
+
+// Claims a node offered by a pushing thread, if there is one in a random slot
+template <typename Type>
+typename Elimination_stack<Type>::node *Elimination_stack<Type>::exchange_pop() {
+	Elimination_slot<Type> &slot = random_slot();
+
+	node *ptr = slot.offer.load(std::memory_order_relaxed);
+	if (ptr == nullptr || ptr == taken())
+		return nullptr;
+
+	if (!slot.offer.compare_exchange_strong(ptr, taken(), std::memory_order_acquire, std::memory_order_relaxed))
+		return nullptr;
+
+	return ptr;
+}
+
+template <typename Type>
+void Elimination_stack<Type>::push_node(node *ptr) {
+	while (!stack.try_push(ptr) && !exchange_push(ptr)) {
+		// Lost the race on the top and nobody took the offer: try again
+	}
+}
+
+// Returns nullptr if the stack is empty
+template <typename Type>
+typename Elimination_stack<Type>::node *Elimination_stack<Type>::pop_node() {
+	while (true) {
+		node *ptr;
+		if (stack.try_pop(ptr))
+			return ptr;
+
+		ptr = exchange_pop();
+		if (ptr != nullptr)
+			return ptr;
+	}
+}
+
+template <typename Type>
+int Elimination_stack<Type>::size() const {
+	int n = stack_size.load(std::memory_order_relaxed);
+	return (n > 0) ? n : 0;
+}
+
+template <typename Type>
+bool Elimination_stack<Type>::empty() const {
+	return stack.peek() == nullptr;
+}
+
+#ifdef DS_ENABLE_STATS
+// Returns the event counters together with the current size
+template <typename Type>
+Elimination_stack_stats Elimination_stack<Type>::stats() const {
+	Elimination_stack_stats snapshot = statistics;
+	snapshot.size = size();
+	snapshot.cas_retries = stack.cas_failures();
+	return snapshot;
+}
+#endif
+
+template <typename Type>
+void Elimination_stack<Type>::push(Type const &obj) {
+	emplace(obj);
+}
+
+template <typename Type>
+void Elimination_stack<Type>::push(Type &&obj) {
+	emplace(std::move(obj));
+}
+
+template <typename Type>
+template <typename... Args>
+void Elimination_stack<Type>::emplace(Args &&... args) {
+	// Reuse a free node if there is one
+	node *ptr = free_nodes.pop();
+	if (ptr == nullptr) {
+		ptr = new node;
+		DS_STATS(statistics.node_allocations.add();)
+	}
+
+	try {
+		new (ptr->element()) Type(std::forward<Args>(args)...);
+	}
+	catch (...) {
+		free_nodes.push(ptr);
+		throw;
+	}
+
+	stack_size.fetch_add(1, std::memory_order_relaxed);
+	push_node(ptr);
+	DS_STATS(statistics.pushes.add();)
+}
+
+template <typename Type>
+bool Elimination_stack<Type>::try_pop(Type &obj) {
+	node *ptr = pop_node();
+	if (ptr == nullptr) {
+		DS_STATS(statistics.empty_pops.add();)
+		return false;
+	}
+
+	stack_size.fetch_sub(1, std::memory_order_relaxed);
+	DS_STATS(statistics.pops.add();)
+	obj = std::move(*ptr->element());
+	ptr->element()->~Type();
+	free_nodes.push(ptr);
+	return true;
+}
+
+template <typename Type>
+Type Elimination_stack<Type>::pop() {
+	node *ptr = pop_node();
+	if (ptr == nullptr) { // Throw an underflow if the stack is empty
+		DS_STATS(statistics.empty_pops.add();)
+		throw underflow();
+	}
+
+	stack_size.fetch_sub(1, std::memory_order_relaxed);
+	DS_STATS(statistics.pops.add();)
+	Type temp(std::move(*ptr->element()));
+	ptr->element()->~Type();
+	free_nodes.push(ptr);
+	return temp;
+}
+
+#endif
@@ -1,157 +1,275 @@
 #ifndef LINKED_STACK_H
 #define LINKED_STACK_H
 
-#ifndef nullptr
-#define nullptr 0
-#endif
-
 #include "ece250.h"
 #include "Double_sentinel_list.h"
 #include "Exception.h"
+#include "Ds_stats.h"
+#include <algorithm>
 #include <iostream>
+#include <utility>
+
+#ifdef DS_ENABLE_STATS
+// A snapshot of the counters of a Linked_stack (see Ds_stats.h): a stack whose
+// top keeps crossing a chunk boundary should show spare_reuses, not allocations
+struct Linked_stack_stats {
+	int size;
+	int chunks;
+	long long pushes;
+	long long pops;
+	long long chunk_allocations;	// Chunks allocated with new[]
+	long long spare_reuses;			// Chunks taken from the spare instead
+	long long chunk_frees;			// Emptied chunks freed because there already was a spare
+
+	Linked_stack_stats() :
+	size(0), chunks(0), pushes(0), pops(0), chunk_allocations(0), spare_reuses(0), chunk_frees(0) {
+		// Empty constructor
+	}
+};
+#endif
 
+// The default chunk fills 512 bytes (eight cache lines), but holds no fewer than eight elements
 template <typename Type>
+struct Linked_stack_default_capacity {
+	static int const value = (sizeof(Type) <= 64) ? static_cast<int>(512 / sizeof(Type)) : 8;
+};
+
+template <typename Type, int ARRAY_CAPACITY = Linked_stack_default_capacity<Type>::value>
 class Linked_stack {
 private:
-	static int const ARRAY_CAPACITY = 8;
+	static_assert(ARRAY_CAPACITY >= 1, "a chunk must hold at least one element");
 
 	Double_sentinel_list<Type *> list;
 	int itop;
 	int stack_size;
 
+	// The most recently emptied chunk, kept so that pushing and popping
+	// across a chunk boundary does not allocate and free a chunk every time
+	Type *spare_chunk;
+#ifdef DS_ENABLE_STATS
+	Linked_stack_stats statistics;
+#endif
+
+	Type *take_chunk();
+	void release_chunk(Type *);
+	Type &next_slot();
+
 public:
 	Linked_stack();
 	Linked_stack(Linked_stack const &);
+	Linked_stack(Linked_stack &&);
 	~Linked_stack();
 
 	bool empty() const;
 	int size() const;
 	int list_size() const;
+#ifdef DS_ENABLE_STATS
+	Linked_stack_stats stats() const;
+#endif
 
-	Type top() const;
+	Type const &top() const;
 
 	void swap(Linked_stack &);
 	Linked_stack &operator=(Linked_stack);
 	void push(Type const &obj);
+	void push(Type &&obj);
+	template <typename... Args>
+	void emplace(Args &&...);
 	Type pop();
 
 	// Friends
 
-	template <typename T>
-	friend std::ostream &operator<<(std::ostream &, Linked_stack<T> const &);
+	template <typename T, int N>
+	friend std::ostream &operator<<(std::ostream &, Linked_stack<T, N> const &);
 };
 
-template <typename Type>
-Linked_stack<Type>::Linked_stack() :
-stack_size(0){
-	itop = 7;
+template <typename Type, int ARRAY_CAPACITY>
+Linked_stack<Type, ARRAY_CAPACITY>::Linked_stack() :
+stack_size(0),
+spare_chunk(nullptr) {
+	itop = ARRAY_CAPACITY - 1;
 }
 
 // Copy Constructor: Creates an identical copy of the pre-existing stack
-template <typename Type>
-Linked_stack<Type>::Linked_stack(Linked_stack const &stack) :
-itop(7), 			// Set initial value for itop
-stack_size(0) { 	// Set initial value for stack size
-	
-	// Iterate from the back of the list, pushing new items over from the old stack to the new stack
-	for (Double_node<Type *> * temp = stack.list.tail()->previous(); temp->previous() != nullptr; temp = temp->previous()) {
-		// For each array, copy each individual element over
-		for (int i = 0; i < 8; i++) { 
-			push(temp->retrieve()[i]);
-		}
+template <typename Type, int ARRAY_CAPACITY>
+Linked_stack<Type, ARRAY_CAPACITY>::Linked_stack(Linked_stack const &stack) :
+itop(ARRAY_CAPACITY - 1), 	// Set initial value for itop
+stack_size(0), 				// Set initial value for stack size
+spare_chunk(nullptr) {
+	// Iterate from the front of the list, cloning each array in one bulk copy.
+	// Only the top array is partially filled: copy just its first itop + 1 slots
+	int count = stack.itop + 1;
+
+	for (Double_node<Type *> * temp = stack.list.head()->next(); temp->next() != nullptr; temp = temp->next()) {
+		Type *chunk = new Type[ARRAY_CAPACITY];
+		list.push_back(chunk);
+		std::copy(temp->retrieve(), temp->retrieve() + count, chunk);
+		count = ARRAY_CAPACITY;
 	}
 	itop = stack.itop; 				// Set final value for itop
 	stack_size = stack.stack_size; 	// Set final value for stack
 }
 
+// Move Constructor: Takes the list of arrays from the other stack in O(1), leaving it empty
+template <typename Type, int ARRAY_CAPACITY>
+Linked_stack<Type, ARRAY_CAPACITY>::Linked_stack(Linked_stack &&stack) :
+itop(ARRAY_CAPACITY - 1),
+stack_size(0),
+spare_chunk(nullptr) {
+	swap(stack);
+}
+
 // Destructor: Deallocates the linked stack from memory
-template <typename Type>
-Linked_stack<Type>::~Linked_stack() {
+template <typename Type, int ARRAY_CAPACITY>
+Linked_stack<Type, ARRAY_CAPACITY>::~Linked_stack() {
 	Double_node < Type*> * temp = list.head()->next();
 	// Iterates through the entire list deleting each array
 	while (temp->next() != nullptr){
 		delete [] temp->retrieve();
 		temp = temp->next();
 	}
+	delete [] spare_chunk;
 	// Since the destructor deletes this instance of the class,
 	// the list is autmatically deallocated from memory
 }
 
 // empty() function: Returns true if the stack is empty, false otherwise
-template <typename Type>
-bool Linked_stack<Type>::empty() const {
+template <typename Type, int ARRAY_CAPACITY>
+bool Linked_stack<Type, ARRAY_CAPACITY>::empty() const {
 	return (stack_size == 0);
 }
 
 // Returns the current number of elements on the stack
-template <typename Type>
-int Linked_stack<Type>::size() const {
+template <typename Type, int ARRAY_CAPACITY>
+int Linked_stack<Type, ARRAY_CAPACITY>::size() const {
 	return stack_size;
 }
 
 // Returns the size of the list
-template <typename Type>
-int Linked_stack<Type>::list_size() const {
+template <typename Type, int ARRAY_CAPACITY>
+int Linked_stack<Type, ARRAY_CAPACITY>::list_size() const {
 	return list.size();
 }
 
+#ifdef DS_ENABLE_STATS
+// Returns the event counters together with the current size and chunks
+template <typename Type, int ARRAY_CAPACITY>
+Linked_stack_stats Linked_stack<Type, ARRAY_CAPACITY>::stats() const {
+	Linked_stack_stats snapshot = statistics;
+	snapshot.size = stack_size;
+	snapshot.chunks = list.size();
+	return snapshot;
+}
+#endif
+
 // Returns the element at the top of the stack
-template <typename Type>
-Type Linked_stack<Type>::top() const {
+template <typename Type, int ARRAY_CAPACITY>
+Type const &Linked_stack<Type, ARRAY_CAPACITY>::top() const {
 	if (empty()) // if the list is empty, throws an underflow error
 		throw underflow();
 	return list.head()->next()->retrieve()[itop];
 }
 
-template <typename Type>
-void Linked_stack<Type>::swap(Linked_stack<Type> &stack) {
-	std::swap(list, stack.list);
+template <typename Type, int ARRAY_CAPACITY>
+void Linked_stack<Type, ARRAY_CAPACITY>::swap(Linked_stack<Type, ARRAY_CAPACITY> &stack) {
+	list.swap(stack.list);	// Relinks the chunks rather than copying them
 	std::swap(stack_size, stack.stack_size);
 	std::swap(itop, stack.itop);
+	std::swap(spare_chunk, stack.spare_chunk);
+	DS_STATS(std::swap(statistics, stack.statistics);)
 }
 
-template <typename Type>
-Linked_stack<Type> &Linked_stack<Type>::operator=(Linked_stack<Type> rhs) {
+template <typename Type, int ARRAY_CAPACITY>
+Linked_stack<Type, ARRAY_CAPACITY> &Linked_stack<Type, ARRAY_CAPACITY>::operator=(Linked_stack<Type, ARRAY_CAPACITY> rhs) {
 	swap(rhs);
 
 	return *this;
 }
 
-// Pushes a new element to the top of the stack
-template <typename Type>
-void Linked_stack<Type>::push(Type const &obj) {
-	// If the current array is full, push a new array to the front, then add the object to that array
-	if (itop == 7){
-		list.push_front(new Type[8]);
-		list.front()[0] = obj;
+// Returns an empty chunk, reusing the spare chunk if there is one
+template <typename Type, int ARRAY_CAPACITY>
+Type *Linked_stack<Type, ARRAY_CAPACITY>::take_chunk() {
+	Type *chunk = spare_chunk;
+	if (chunk == nullptr) {
+		DS_STATS(statistics.chunk_allocations++;)
+		return new Type[ARRAY_CAPACITY];
+	}
+	spare_chunk = nullptr;
+	DS_STATS(statistics.spare_reuses++;)
+	return chunk;
+}
+
+// Keeps an emptied chunk as the spare, or deallocates it if there already is one
+template <typename Type, int ARRAY_CAPACITY>
+void Linked_stack<Type, ARRAY_CAPACITY>::release_chunk(Type *chunk) {
+	if (spare_chunk == nullptr)
+		spare_chunk = chunk;
+	else {
+		delete [] chunk;
+		DS_STATS(statistics.chunk_frees++;)
+	}
+}
+
+// Makes room for a new element and returns the slot it is to be assigned to
+template <typename Type, int ARRAY_CAPACITY>
+Type &Linked_stack<Type, ARRAY_CAPACITY>::next_slot() {
+	// If the current array is full, push a new array to the front, then use its first slot
+	if (itop == ARRAY_CAPACITY - 1){
+		list.push_front(take_chunk());
 		itop = 0; // Reset itop
 	}
-	// If there is room left in the current array, assign it to the next index of itop
+	// If there is room left in the current array, use the next index of itop
 	else{
 		itop++;
-		list.head()->next()->retrieve()[itop] = obj;
 	}
+	return list.front()[itop];
+}
+
+// Pushes a new element to the top of the stack
+template <typename Type, int ARRAY_CAPACITY>
+void Linked_stack<Type, ARRAY_CAPACITY>::push(Type const &obj) {
+	next_slot() = obj;
 	stack_size++;
+	DS_STATS(statistics.pushes++;)
 }
 
-template <typename Type>
-Type Linked_stack<Type>::pop() {
+template <typename Type, int ARRAY_CAPACITY>
+void Linked_stack<Type, ARRAY_CAPACITY>::push(Type &&obj) {
+	next_slot() = std::move(obj);
+	stack_size++;
+	DS_STATS(statistics.pushes++;)
+}
+
+// Pushes an element constructed from the arguments. The slots of a chunk are
+// already constructed, so the element is built first and then moved into its slot
+template <typename Type, int ARRAY_CAPACITY>
+template <typename... Args>
+void Linked_stack<Type, ARRAY_CAPACITY>::emplace(Args &&... args) {
+	Type temp(std::forward<Args>(args)...);
+	next_slot() = std::move(temp);
+	stack_size++;
+	DS_STATS(statistics.pushes++;)
+}
+
+template <typename Type, int ARRAY_CAPACITY>
+Type Linked_stack<Type, ARRAY_CAPACITY>::pop() {
 	if (empty()) // Throw an underflow if the stack is empty
 		throw underflow();
-	// Retrieve the element to be popped
-	Type temp = list.head()->next()->retrieve()[itop];
+	// Move the element to be popped out of its slot
+	Type temp(std::move(list.front()[itop]));
 	// If there is only one element left in the current array,
-	// delete the element, then deallocate that array from memory
+	// delete the element, then keep that array as the spare (or deallocate it)
 	if (itop == 0){
-		delete [] list.head()->next()->retrieve();
+		release_chunk(list.head()->next()->retrieve());
 		list.pop_front();
-		itop = 7;	
+		itop = ARRAY_CAPACITY - 1;
 	}
 	// If there is more than one element left in the current array,
 	// Simply decrement itop
 	else
 		itop--;
 	stack_size--; // Decrement size of the stack
+	DS_STATS(statistics.pops++;)
 
 	return temp; // Return the popped element
 }
@@ -159,8 +277,8 @@ Type Linked_stack<Type>::pop() {
 // You will be required to modify this function in order to accomodate
 // your implementation of a singly linked list in Project 1.
 
-template <typename T>
-std::ostream &operator<<(std::ostream &out, Linked_stack<T> const &stack) {
+template <typename T, int N>
+std::ostream &operator<<(std::ostream &out, Linked_stack<T, N> const &stack) {
 	if (stack.list.size() == 0) {
 		out << "->0";
 	}
@@ -185,7 +303,7 @@ std::ostream &operator<<(std::ostream &out, Linked_stack<T> const &stack) {
 				}
 			}
 			else {
-				for (int i = 0; i <= Linked_stack<T>::ARRAY_CAPACITY - 1; ++i) {
+				for (int i = 0; i <= N - 1; ++i) {
 					out << ptr->retrieve()[i] << " ";
 				}
 			}
@@ -198,5 +316,5 @@ std::ostream &operator<<(std::ostream &out, Linked_stack<T> const &stack) {
 
 	return out;
 }
-`
+
 #endif
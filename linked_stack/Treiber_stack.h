@@ -0,0 +1,329 @@
+/*
+* Treiber_stack
+*
+* This class implements an unbounded, lock-free stack after R. K. Treiber,
+* for free lists and work pools shared between threads.
+*
+* The stack is a singly linked list of nodes whose top is swung with a single
+* compare-and-swap. To defeat the ABA problem the top pointer carries a 16-bit
+* tag in its upper bits (user-space addresses on x86-64 and AArch64 fit in the
+* low 48), and the tag changes on every update, so a compare-and-swap against
+* a top that has been popped and pushed again in the meantime fails.
+*
+* Nodes are never returned to the allocator while the stack exists: a popped
+* node goes onto a second tagged stack of free nodes and is reused by a later
+* push. A thread that reads the next pointer of a node that another thread has
+* just popped therefore always reads valid memory, and steady-state pushes and
+* pops do not allocate.
+*
+* ---------------------------------------------------------
+*                           Member Variables:
+*
+*  Tagged_node_stack stack            The elements, top first
+*  Tagged_node_stack free_nodes       Popped nodes waiting to be reused
+*  std::atomic<int>  stack_size       The number of elements on the stack
+*
+* ---------------------------------------------------------
+*                   Member Functions:
+*
+* void push(Type const &);
+* void push(Type &&);
+* void emplace(Args &&...);
+*   Adds an element to the top of the stack.
+*
+* bool try_pop(Type &);
+*   Moves the top of the stack into the argument. Returns false if the stack is empty.
+*
+* Type pop();
+*   Removes the top of the stack and returns it. Throws an underflow if the stack is empty.
+*
+* int size() const;
+* bool empty() const;
+*   Approximate while other threads are active.
+*
+* ---------------------------------------------------------
+*                   Instrumentation (DS_ENABLE_STATS, see Ds_stats.h):
+*
+* Treiber_stack_stats stats() const
+*   Returns a snapshot of the pushes, the pops, the pops that found the stack empty,
+*   the nodes allocated rather than reused, and the compare-and-swaps on the top that
+*   failed and had to be retried. Retries per operation measure the contention on
+*   the top; Elimination_stack is meant for when they climb with the thread count.
+*/
+
+#ifndef TREIBER_STACK_H
+#define TREIBER_STACK_H
+
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "ece250.h"
+#include "Exception.h"
+#include "Cache_aligned.h"
+#include "Ds_stats.h"
+
+#ifdef DS_ENABLE_STATS
+// A snapshot of the counters of a Treiber_stack (see Ds_stats.h)
+struct Treiber_stack_stats {
+	int size;
+	Ds_counter pushes;
+	Ds_counter pops;
+	Ds_counter empty_pops;			// Pops that found the stack empty
+	Ds_counter node_allocations;	// Pushes that found no free node to reuse
+	long long cas_retries;			// Failed compare-and-swaps on the top of the stack
+
+	Treiber_stack_stats() :
+	size(0), cas_retries(0) {
+		// Empty constructor
+	}
+};
+#endif
+
+template <typename Type>
+struct Treiber_stack_node {
+	std::atomic<Treiber_stack_node *> next_node;
+	typename std::aligned_storage<sizeof(Type), alignof(Type)>::type storage;
+
+	Type *element() {
+		return reinterpret_cast<Type *>(&storage);
+	}
+};
+
+// A lock-free stack of nodes with a tagged top pointer. Node must have a
+// std::atomic<Node *> next_node member; the nodes themselves are owned by the caller.
+template <typename Node>
+class Tagged_node_stack {
+private:
+	static_assert(sizeof(void *) == 8, "tagged pointers need 64-bit addresses");
+
+	static int const TAG_SHIFT = 48;
+	static std::uint64_t const ADDRESS_MASK = (std::uint64_t(1) << TAG_SHIFT) - 1;
+
+	std::atomic<std::uint64_t> top;
+#ifdef DS_ENABLE_STATS
+	Ds_counter failures;
+#endif
+
+	static Node *address(std::uint64_t word) {
+		return reinterpret_cast<Node *>(static_cast<std::uintptr_t>(word & ADDRESS_MASK));
+	}
+
+	// Packs the pointer with the tag one past the tag of the word it replaces
+	static std::uint64_t successor(std::uint64_t word, Node *ptr) {
+		return (reinterpret_cast<std::uintptr_t>(ptr) & ADDRESS_MASK) | ((word >> TAG_SHIFT) + 1) << TAG_SHIFT;
+	}
+
+public:
+	Tagged_node_stack() :
+	top(0) {
+		// Empty constructor
+	}
+
+	Node *peek() const {
+		return address(top.load(std::memory_order_acquire));
+	}
+
+#ifdef DS_ENABLE_STATS
+	// The number of compare-and-swaps on the top that have failed
+	long long cas_failures() const {
+		return failures.load();
+	}
+#endif
+
+	// Makes one attempt to push the node; returns false if another thread changed the top first
+	bool try_push(Node *ptr) {
+		std::uint64_t word = top.load(std::memory_order_relaxed);
+		ptr->next_node.store(address(word), std::memory_order_relaxed);
+		bool swapped = top.compare_exchange_strong(word, successor(word, ptr), std::memory_order_release, std::memory_order_relaxed);
+		DS_STATS(if (!swapped) failures.add();)
+		return swapped;
+	}
+
+	// Makes one attempt to pop a node into the argument (nullptr if the stack is empty);
+	// returns false if another thread changed the top first
+	bool try_pop(Node *&ptr) {
+		std::uint64_t word = top.load(std::memory_order_acquire);
+		ptr = address(word);
+		if (ptr == nullptr)
+			return true;
+
+		// The node may be popped and reused by another thread at any point from
+		// here on, in which case the tag will have moved on and the swap fails
+		Node *next = ptr->next_node.load(std::memory_order_relaxed);
+		bool swapped = top.compare_exchange_strong(word, successor(word, next), std::memory_order_acquire, std::memory_order_relaxed);
+		DS_STATS(if (!swapped) failures.add();)
+		return swapped;
+	}
+
+	void push(Node *ptr) {
+		std::uint64_t word = top.load(std::memory_order_relaxed);
+
+		while (true) {
+			ptr->next_node.store(address(word), std::memory_order_relaxed);
+			if (top.compare_exchange_weak(word, successor(word, ptr), std::memory_order_release, std::memory_order_relaxed))
+				return;
+			DS_STATS(failures.add();)
+		}
+	}
+
+	// Returns nullptr if the stack is empty
+	Node *pop() {
+		std::uint64_t word = top.load(std::memory_order_acquire);
+
+		while (true) {
+			Node *ptr = address(word);
+			if (ptr == nullptr)
+				return nullptr;
+
+			Node *next = ptr->next_node.load(std::memory_order_relaxed);
+			if (top.compare_exchange_weak(word, successor(word, next), std::memory_order_acquire, std::memory_order_acquire))
+				return ptr;
+			DS_STATS(failures.add();)
+		}
+	}
+};
+
+template <typename Type>
+class Treiber_stack : public Cache_aligned {
+private:
+	typedef Treiber_stack_node<Type> node;
+
+	alignas(64) Tagged_node_stack<node> stack;
+	alignas(64) Tagged_node_stack<node> free_nodes;
+	alignas(64) std::atomic<int> stack_size;
+#ifdef DS_ENABLE_STATS
+	alignas(64) Treiber_stack_stats statistics;
+#endif
+
+	// Do not implement these functions!
+	// The stack is shared between threads and can be neither copied nor assigned
+	Treiber_stack(Treiber_stack const &);
+	Treiber_stack &operator=(Treiber_stack const &);
+
+public:
+	Treiber_stack();
+	~Treiber_stack();
+
+	int size() const;
+	bool empty() const;
+#ifdef DS_ENABLE_STATS
+	Treiber_stack_stats stats() const;
+#endif
+
+	void push(Type const &);
+	void push(Type &&);
+	template <typename... Args>
+	void emplace(Args &&...);
+	bool try_pop(Type &);
+	Type pop();
+};
+
+template <typename Type>
+Treiber_stack<Type>::Treiber_stack() :
+stack_size(0) {
+	// Empty constructor
+}
+
+// Destructor: destroys the elements still on the stack, then frees every node
+template <typename Type>
+Treiber_stack<Type>::~Treiber_stack() {
+	while (node *ptr = stack.pop()) {
+		ptr->element()->~Type();
+		delete ptr;
+	}
+
+	while (node *ptr = free_nodes.pop()) {
+		delete ptr;
+	}
+}
+
+template <typename Type>
+int Treiber_stack<Type>::size() const {
+	int n = stack_size.load(std::memory_order_relaxed);
+	return (n > 0) ? n : 0;
+}
+
+template <typename Type>
+bool Treiber_stack<Type>::empty() const {
+	return stack.peek() == nullptr;
+}
+
+#ifdef DS_ENABLE_STATS
+// Returns the event counters together with the current size
+template <typename Type>
+Treiber_stack_stats Treiber_stack<Type>::stats() const {
+	Treiber_stack_stats snapshot = statistics;
+	snapshot.size = size();
+	snapshot.cas_retries = stack.cas_failures();
+	return snapshot;
+}
+#endif
+
+template <typename Type>
+void Treiber_stack<Type>::push(Type const &obj) {
+	emplace(obj);
+}
+
+template <typename Type>
+void Treiber_stack<Type>::push(Type &&obj) {
+	emplace(std::move(obj));
+}
+
+template <typename Type>
+template <typename... Args>
+void Treiber_stack<Type>::emplace(Args &&... args) {
+	// Reuse a free node if there is one
+	node *ptr = free_nodes.pop();
+	if (ptr == nullptr) {
+		ptr = new node;
+		DS_STATS(statistics.node_allocations.add();)
+	}
+
+	try {
+		new (ptr->element()) Type(std::forward<Args>(args)...);
+	}
+	catch (...) {
+		free_nodes.push(ptr);
+		throw;
+	}
+
+	stack.push(ptr);
+	stack_size.fetch_add(1, std::memory_order_relaxed);
+	DS_STATS(statistics.pushes.add();)
+}
+
+template <typename Type>
+bool Treiber_stack<Type>::try_pop(Type &obj) {
+	node *ptr = stack.pop();
+	if (ptr == nullptr) {
+		DS_STATS(statistics.empty_pops.add();)
+		return false;
+	}
+
+	stack_size.fetch_sub(1, std::memory_order_relaxed);
+	DS_STATS(statistics.pops.add();)
+	obj = std::move(*ptr->element());
+	ptr->element()->~Type();
+	free_nodes.push(ptr);
+	return true;
+}
+
+template <typename Type>
+Type Treiber_stack<Type>::pop() {
+	node *ptr = stack.pop();
+	if (ptr == nullptr) { // Throw an underflow if the stack is empty
+		DS_STATS(statistics.empty_pops.add();)
+		throw underflow();
+	}
+
+	stack_size.fetch_sub(1, std::memory_order_relaxed);
+	DS_STATS(statistics.pops.add();)
+	Type temp(std::move(*ptr->element()));
+	ptr->element()->~Type();
+	free_nodes.push(ptr);
+	return temp;
+}
+
+#endif
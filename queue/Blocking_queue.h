@@ -0,0 +1,419 @@
+/*
+* Blocking_queue
+*
+* This class implements a bounded, blocking work queue built around
+* Dynamic_queue, for hand-offs between producer and consumer threads such as
+* logging and ingestion stages.
+*
+* Producers block (or time out) while the queue is full, which pushes back on
+* them when consumers fall behind. Consumers block while it is empty, and can
+* drain every queued element with a single lock acquisition.
+*
+* Wakeups are kept to a minimum: a producer only signals when its enqueue takes
+* the queue from empty to non-empty and a consumer is actually waiting, and a
+* consumer only signals when its dequeue takes the queue from full to not full
+* and a producer is waiting. A thread that is woken passes the signal on if
+* there is still work (or room) left for the next waiter. On Linux the waits
+* and signals are futex operations, so an uncontended enqueue or dequeue costs
+* one lock and unlock and no system call.
+*
+* ---------------------------------------------------------
+*                           Member Variables:
+*
+*  Dynamic_queue<Type> queue           The queued elements
+*  int                 queue_capacity  The most elements the queue may hold
+*  bool                closed          Set by close(): no further enqueues are accepted
+*  int                 waiting_producers, waiting_consumers
+*                                      The number of threads blocked on each condition
+*
+* ---------------------------------------------------------
+*                   Member Functions (Accessors):
+*
+* int size() const
+* bool empty() const
+* int capacity() const
+* bool is_closed() const
+*
+* ---------------------------------------------------------
+*                   Member Functions (Mutators):
+*
+* bool enqueue(Type const &);
+* bool enqueue(Type &&);
+*   Waits while the queue is full, then adds the element to the back.
+*   Returns false, without enqueueing, if the queue is or becomes closed.
+*
+* bool try_enqueue(Type const &);
+* bool enqueue_for(Type const &, duration);
+*   As enqueue, but give up immediately or after the timeout if the queue is full.
+*
+* int enqueue_range(Iterator, Iterator);
+*   Enqueues a forward range, as many elements per lock acquisition as there is room for.
+*   Returns the number of elements enqueued, which is less than the length of the
+*   range only if the queue was closed.
+*
+* Type dequeue();
+*   Waits while the queue is empty, then removes and returns its head.
+*   Throws an underflow if the queue is closed and empty.
+*
+* bool try_dequeue(Type &);
+* bool dequeue_for(Type &, duration);
+*   As dequeue, but give up immediately or after the timeout if the queue is empty.
+*
+* int dequeue_all(OutputIterator);
+*   Waits while the queue is empty, then moves every queued element to the output
+*   iterator under a single lock acquisition. Returns the number of elements moved,
+*   which is 0 only if the queue is closed and empty.
+*
+* void close();
+*   Rejects further enqueues and wakes every waiting thread. Elements already
+*   queued can still be dequeued.
+*
+* ---------------------------------------------------------
+*                   Instrumentation (DS_ENABLE_STATS, see Ds_stats.h):
+*
+* Blocking_queue_stats stats() const
+*   Takes the lock and returns a snapshot of how many times producers and consumers
+*   had to wait, how many waits timed out, and how many signals were sent, together
+*   with the stats of the underlying Dynamic_queue. Producer waits mean the consumers
+*   are the bottleneck; consumer waits, the producers.
+*/
+
+#ifndef BLOCKING_QUEUE_H
+#define BLOCKING_QUEUE_H
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <iterator>
+#include <mutex>
+#include <utility>
+#include "ece250.h"
+#include "Exception.h"
+#include "Dynamic_queue.h"
+#include "Ds_stats.h"
+
+#ifdef DS_ENABLE_STATS
+// A snapshot of the counters of a Blocking_queue (see Ds_stats.h)
+struct Blocking_queue_stats {
+	long long producer_waits;		// Enqueues that waited for room
+	long long consumer_waits;		// Dequeues that waited for an element
+	long long timeouts;				// Timed waits that gave up
+	long long rejected_enqueues;	// try_enqueue calls that found the queue full
+	long long signals;				// Notifications sent to waiting threads
+	Dynamic_queue_stats queue;
+
+	Blocking_queue_stats() :
+	producer_waits(0), consumer_waits(0), timeouts(0), rejected_enqueues(0), signals(0) {
+		// Empty constructor
+	}
+};
+#endif
+
+template <typename Type>
+class Blocking_queue {
+private:
+	Dynamic_queue<Type> queue;
+	int queue_capacity;
+	bool closed;
+	int waiting_producers;
+	int waiting_consumers;
+#ifdef DS_ENABLE_STATS
+	Blocking_queue_stats statistics;
+#endif
+
+	mutable std::mutex lock;
+	std::condition_variable not_full;
+	std::condition_variable not_empty;
+
+	// Do not implement these functions!
+	// The queue is shared between threads and can be neither copied nor assigned
+	Blocking_queue(Blocking_queue const &);
+	Blocking_queue &operator=(Blocking_queue const &);
+
+	bool wait_for_room(std::unique_lock<std::mutex> &);
+	bool wait_for_element(std::unique_lock<std::mutex> &);
+	template <typename Arg>
+	void push_locked(Arg &&);
+	void after_pop(bool);
+
+public:
+	Blocking_queue(int = 1024);
+
+	int size() const;
+	bool empty() const;
+	int capacity() const;
+	bool is_closed() const;
+#ifdef DS_ENABLE_STATS
+	Blocking_queue_stats stats() const;
+#endif
+
+	bool enqueue(Type const &);
+	bool enqueue(Type &&);
+	bool try_enqueue(Type const &);
+	template <typename Rep, typename Period>
+	bool enqueue_for(Type const &, std::chrono::duration<Rep, Period> const &);
+	template <typename Iterator>
+	int enqueue_range(Iterator, Iterator);
+
+	Type dequeue();
+	bool try_dequeue(Type &);
+	template <typename Rep, typename Period>
+	bool dequeue_for(Type &, std::chrono::duration<Rep, Period> const &);
+	template <typename OutputIterator>
+	int dequeue_all(OutputIterator);
+
+	void close();
+};
+
+template <typename Type>
+Blocking_queue<Type>::Blocking_queue(int n) :
+queue(std::min(std::max(n, 1), 1024), SHRINK_WITH_HYSTERESIS),
+queue_capacity(std::max(n, 1)),
+closed(false),
+waiting_producers(0),
+waiting_consumers(0) {
+}
+
+template <typename Type>
+int Blocking_queue<Type>::size() const {
+	std::lock_guard<std::mutex> guard(lock);
+	return queue.size();
+}
+
+template <typename Type>
+bool Blocking_queue<Type>::empty() const {
+	return size() == 0;
+}
+
+template <typename Type>
+int Blocking_queue<Type>::capacity() const {
+	return queue_capacity;
+}
+
+template <typename Type>
+bool Blocking_queue<Type>::is_closed() const {
+	std::lock_guard<std::mutex> guard(lock);
+	return closed;
+}
+
+#ifdef DS_ENABLE_STATS
+// Returns the wait and signal counters together with the stats of the queue itself
+template <typename Type>
+Blocking_queue_stats Blocking_queue<Type>::stats() const {
+	std::lock_guard<std::mutex> guard(lock);
+	Blocking_queue_stats snapshot = statistics;
+	snapshot.queue = queue.stats();
+	return snapshot;
+}
+#endif
+
+// Blocks until the queue has room or is closed; returns true if there is room
+template <typename Type>
+bool Blocking_queue<Type>::wait_for_room(std::unique_lock<std::mutex> &held) {
+	if (queue.size() >= queue_capacity && !closed) {
+		DS_STATS(statistics.producer_waits++;)
+		waiting_producers++;
+		not_full.wait(held, [this] { return queue.size() < queue_capacity || closed; });
+		waiting_producers--;
+	}
+	return !closed;
+}
+
+// Blocks until the queue has an element or is closed; returns true if there is an element
+template <typename Type>
+bool Blocking_queue<Type>::wait_for_element(std::unique_lock<std::mutex> &held) {
+	if (queue.empty() && !closed) {
+		DS_STATS(statistics.consumer_waits++;)
+		waiting_consumers++;
+		not_empty.wait(held, [this] { return !queue.empty() || closed; });
+		waiting_consumers--;
+	}
+	return !queue.empty();
+}
+
+// Enqueues with the lock held, signalling a consumer only on the empty to
+// non-empty transition, and passing the signal on to the next producer if
+// there is still room
+template <typename Type>
+template <typename Arg>
+void Blocking_queue<Type>::push_locked(Arg &&obj) {
+	bool was_empty = queue.empty();
+	queue.enqueue(std::forward<Arg>(obj));
+
+	if (was_empty && waiting_consumers > 0) {
+		not_empty.notify_one();
+		DS_STATS(statistics.signals++;)
+	}
+	if (queue.size() < queue_capacity && waiting_producers > 0) {
+		not_full.notify_one();
+		DS_STATS(statistics.signals++;)
+	}
+}
+
+// Called with the lock held after removing elements from a queue that was
+// previously full (or not): wakes a producer only on the full to not full
+// transition, and passes the signal on to the next consumer if elements remain
+template <typename Type>
+void Blocking_queue<Type>::after_pop(bool was_full) {
+	if (was_full && waiting_producers > 0) {
+		not_full.notify_one();
+		DS_STATS(statistics.signals++;)
+	}
+	if (!queue.empty() && waiting_consumers > 0) {
+		not_empty.notify_one();
+		DS_STATS(statistics.signals++;)
+	}
+}
+
+template <typename Type>
+bool Blocking_queue<Type>::enqueue(Type const &obj) {
+	std::unique_lock<std::mutex> held(lock);
+	if (!wait_for_room(held)) return false;
+	push_locked(obj);
+	return true;
+}
+
+template <typename Type>
+bool Blocking_queue<Type>::enqueue(Type &&obj) {
+	std::unique_lock<std::mutex> held(lock);
+	if (!wait_for_room(held)) return false;
+	push_locked(std::move(obj));
+	return true;
+}
+
+template <typename Type>
+bool Blocking_queue<Type>::try_enqueue(Type const &obj) {
+	std::lock_guard<std::mutex> guard(lock);
+	if (closed || queue.size() >= queue_capacity) {
+		DS_STATS(if (!closed) statistics.rejected_enqueues++;)
+		return false;
+	}
+	push_locked(obj);
+	return true;
+}
+
+template <typename Type>
+template <typename Rep, typename Period>
+bool Blocking_queue<Type>::enqueue_for(Type const &obj, std::chrono::duration<Rep, Period> const &timeout) {
+	std::unique_lock<std::mutex> held(lock);
+
+	if (queue.size() >= queue_capacity && !closed) {
+		DS_STATS(statistics.producer_waits++;)
+		waiting_producers++;
+		bool room = not_full.wait_for(held, timeout, [this] { return queue.size() < queue_capacity || closed; });
+		waiting_producers--;
+		if (!room) {
+			DS_STATS(statistics.timeouts++;)
+			return false;
+		}
+	}
+	if (closed) return false;
+
+	push_locked(obj);
+	return true;
+}
+
+template <typename Type>
+template <typename Iterator>
+int Blocking_queue<Type>::enqueue_range(Iterator first, Iterator last) {
+	int enqueued = 0;
+	std::unique_lock<std::mutex> held(lock);
+
+	while (first != last) {
+		if (!wait_for_room(held)) break;
+
+		// Copy in as much of the range as there is room for, in one batch
+		int room = queue_capacity - queue.size();
+		Iterator middle = first;
+		int n = 0;
+		while (middle != last && n < room) {
+			++middle;
+			++n;
+		}
+
+		bool was_empty = queue.empty();
+		queue.enqueue_range(first, middle);
+		first = middle;
+		enqueued += n;
+
+		if (was_empty && waiting_consumers > 0) {
+			not_empty.notify_one();
+			DS_STATS(statistics.signals++;)
+		}
+	}
+
+	if (queue.size() < queue_capacity && waiting_producers > 0) {
+		not_full.notify_one();
+		DS_STATS(statistics.signals++;)
+	}
+	return enqueued;
+}
+
+template <typename Type>
+Type Blocking_queue<Type>::dequeue() {
+	std::unique_lock<std::mutex> held(lock);
+
+	// If the queue is closed and drained, throw an underflow
+	if (!wait_for_element(held)) throw underflow();
+
+	bool was_full = queue.size() >= queue_capacity;
+	Type temp = queue.dequeue();
+	after_pop(was_full);
+	return temp;
+}
+
+template <typename Type>
+bool Blocking_queue<Type>::try_dequeue(Type &obj) {
+	std::lock_guard<std::mutex> guard(lock);
+	if (queue.empty()) return false;
+
+	bool was_full = queue.size() >= queue_capacity;
+	obj = queue.dequeue();
+	after_pop(was_full);
+	return true;
+}
+
+template <typename Type>
+template <typename Rep, typename Period>
+bool Blocking_queue<Type>::dequeue_for(Type &obj, std::chrono::duration<Rep, Period> const &timeout) {
+	std::unique_lock<std::mutex> held(lock);
+
+	if (queue.empty() && !closed) {
+		DS_STATS(statistics.consumer_waits++;)
+		waiting_consumers++;
+		not_empty.wait_for(held, timeout, [this] { return !queue.empty() || closed; });
+		waiting_consumers--;
+		DS_STATS(if (queue.empty() && !closed) statistics.timeouts++;)
+	}
+	if (queue.empty()) return false;
+
+	bool was_full = queue.size() >= queue_capacity;
+	obj = queue.dequeue();
+	after_pop(was_full);
+	return true;
+}
+
+template <typename Type>
+template <typename OutputIterator>
+int Blocking_queue<Type>::dequeue_all(OutputIterator out) {
+	std::unique_lock<std::mutex> held(lock);
+	if (!wait_for_element(held)) return 0;
+
+	// Drain the whole queue in one batch; every waiting producer now has room
+	int n = queue.dequeue_into(out, queue.size());
+	if (waiting_producers > 0) {
+		not_full.notify_all();
+		DS_STATS(statistics.signals++;)
+	}
+	return n;
+}
+
+template <typename Type>
+void Blocking_queue<Type>::close() {
+	std::lock_guard<std::mutex> guard(lock);
+	closed = true;
+	not_full.notify_all();
+	not_empty.notify_all();
+}
+
+#endif
@@ -1,39 +1,121 @@
 #ifndef DYNAMIC_QUEUE_H
 #define DYNAMIC_QUEUE_H
 
-#ifndef nullptr
-#define nullptr 0
-#endif
-
 #include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include "ece250.h"
 #include "Exception.h"
+#include "Simd_search.h"
+#include "Ds_stats.h"
+
+// When a Dynamic_queue gives back memory as it empties:
+//   SHRINK_IMMEDIATELY      halve the capacity as soon as a dequeue leaves it at most a quarter full
+//   SHRINK_WITH_HYSTERESIS  halve the capacity only after a number of consecutive dequeues
+//                           have all left it at most an eighth full
+//   NEVER_SHRINK            keep the capacity until shrink_to_fit() is called
+enum shrink_policy_t { SHRINK_IMMEDIATELY, SHRINK_WITH_HYSTERESIS, NEVER_SHRINK };
+
+#ifdef DS_ENABLE_STATS
+// A snapshot of the counters of a Dynamic_queue (see Ds_stats.h)
+struct Dynamic_queue_stats {
+	int size;
+	int capacity;
+	int peak_size;					// The most entries the queue has held at once
+	int allocations;				// Arrays allocated, including the first
+	int grows;						// Reallocations to a larger array
+	int shrinks;					// Reallocations to a smaller array
+	long long bytes_allocated;		// Total size of every array allocated
+	long long enqueues;
+	long long dequeues;				// Including entries discarded or dequeued in batches
+	Ds_latency_histogram enqueue_latency;	// Sampled; enqueue, emplace, one growth included
+	Ds_latency_histogram dequeue_latency;	// Sampled; dequeue, one shrink included
+
+	Dynamic_queue_stats() :
+	size(0), capacity(0), peak_size(0), allocations(0), grows(0), shrinks(0),
+	bytes_allocated(0), enqueues(0), dequeues(0) {
+		// Empty constructor
+	}
+};
+#endif
+
+// A run of entries that are contiguous in the array of a Dynamic_queue
+template <typename Type>
+struct Dynamic_queue_span {
+	Type const *data;
+	int size;
+};
 
 template <typename Type>
 class Dynamic_queue {
 private:
+	// The largest capacity: a power of two that still fits in an int
+	static int const MAX_CAPACITY = 1 << 30;
+
 	int initial_capacity;
 	int array_capacity;
-	Type *array;
+	int mask;				// array_capacity - 1; capacities are always powers of two
+	Type *array;			// Raw storage: only the slots holding entries are constructed
 	int ihead;
 	int itail;
 	int entry_count;
-	// other integer member variables, as necessary
+	shrink_policy_t shrink_policy;
+	int shrink_delay;		// Consecutive low-water dequeues required by SHRINK_WITH_HYSTERESIS
+	int low_water_count;	// Consecutive low-water dequeues observed so far
+	int allocation_count;	// Number of arrays allocated over the lifetime of the queue
+#ifdef DS_ENABLE_STATS
+	Dynamic_queue_stats statistics;
+#endif
+
+	static int power_of_two(int);
+	int grown_capacity() const;
+	Type *allocate(int);
+	static void relocate(Type *, Type *, int, std::true_type);
+	static void relocate(Type *, Type *, int, std::false_type);
+	void destroy_entries();
+	void resize(int);
+	bool should_shrink();
+	template <typename Iterator>
+	void enqueue_range(Iterator, Iterator, std::input_iterator_tag);
+	template <typename Iterator>
+	void enqueue_range(Iterator, Iterator, std::forward_iterator_tag);
 
 public:
-	Dynamic_queue(int = 10);
+	Dynamic_queue(int = 10, shrink_policy_t = SHRINK_IMMEDIATELY, int = 16);
 	Dynamic_queue(Dynamic_queue const &);
+	Dynamic_queue(Dynamic_queue &&) noexcept;
 	~Dynamic_queue();
 
-	Type head() const;
+	Type const &head() const;
 	int size() const;
 	bool empty() const;
 	int capacity() const;
+	int allocations() const;
+	std::pair<Dynamic_queue_span<Type>, Dynamic_queue_span<Type> > peek_span() const;
+	int count(Type const &) const;
+#ifdef DS_ENABLE_STATS
+	Dynamic_queue_stats stats() const;
+#endif
 
+	void set_shrink_policy(shrink_policy_t, int = 16);
+	void reserve(int);
+	void shrink_to_fit();
 	void swap(Dynamic_queue &);
 	Dynamic_queue &operator=(Dynamic_queue);
 	void enqueue(Type const &);
+	void enqueue(Type &&);
+	template <typename... Args>
+	void emplace(Args &&...);
+	template <typename Iterator>
+	void enqueue_range(Iterator, Iterator);
 	Type dequeue();
+	template <typename OutputIterator>
+	int dequeue_into(OutputIterator, int);
+	void discard(int);
 	void clear();
 
 	// Friends
@@ -43,36 +125,173 @@ public:
 };
 
 template <typename Type>
-Dynamic_queue<Type>::Dynamic_queue(int n) :
-initial_capacity(std::max(n, 1)),
+Dynamic_queue<Type>::Dynamic_queue(int n, shrink_policy_t policy, int delay) :
+initial_capacity(power_of_two(n)),
 array_capacity(initial_capacity),
-array(new Type[initial_capacity]),
+mask(array_capacity - 1),
+array(nullptr),
 ihead(0),
-itail(initial_capacity - 1),
-entry_count(0) {
+itail(mask),
+entry_count(0),
+shrink_policy(policy),
+shrink_delay(std::max(delay, 1)),
+low_water_count(0),
+allocation_count(0) {
+	array = allocate(array_capacity);
 }
 
 template <typename Type>
 Dynamic_queue<Type>::Dynamic_queue(Dynamic_queue const &queue) :
 initial_capacity(queue.initial_capacity),
 array_capacity(queue.array_capacity),
-array(new Type[array_capacity]),
+mask(queue.mask),
+array(nullptr),
 ihead(queue.ihead),
 itail(queue.itail),
-entry_count(queue.entry_count) {
+entry_count(queue.entry_count),
+shrink_policy(queue.shrink_policy),
+shrink_delay(queue.shrink_delay),
+low_water_count(0),
+allocation_count(0) {
+	if (array_capacity > 0)
+		array = allocate(array_capacity);
+
 	// The above initializations copy the values of the appropriate
 	// member variables and allocate memory for the data structure;
 	// however, you must still copy the stored objects.
-	for (int i = 0; i < array_capacity; ++i)
-		array[i] = queue.array[i];
+	// Only the occupied slots are constructed, at the same positions.
+	for (int i = 0; i < entry_count; ++i) {
+		int k = (ihead + i) & mask;
+		new (array + k) Type(queue.array[k]);
+	}
+}
+
+// Move Constructor: Takes the array of the other queue in O(1), leaving it
+// empty with no array at all; its next enqueue allocates one of the initial
+// capacity. Nothing is allocated, so the move cannot throw.
+template <typename Type>
+Dynamic_queue<Type>::Dynamic_queue(Dynamic_queue &&queue) noexcept :
+initial_capacity(queue.initial_capacity),
+array_capacity(0),
+mask(0),
+array(nullptr),
+ihead(0),
+itail(0),
+entry_count(0),
+shrink_policy(queue.shrink_policy),
+shrink_delay(queue.shrink_delay),
+low_water_count(0),
+allocation_count(0) {
+	swap(queue);
 }
 
 // Destructor: Deallocates memory for the queue and its contents
 template <typename Type>
 Dynamic_queue<Type>::~Dynamic_queue() {
-	// Iterates through the array
-	// Deallocates memory of each element in the array (deletes each element)
-	delete [] array;
+	// Destroys each element still in the queue, then
+	// deallocates the raw storage of the array
+	destroy_entries();
+	::operator delete(array);
+}
+
+// Returns the smallest power of two that is at least n (and at least 1).
+// Throws an overflow if that is larger than MAX_CAPACITY.
+template <typename Type>
+int Dynamic_queue<Type>::power_of_two(int n) {
+	if (n > MAX_CAPACITY)
+		throw overflow();
+
+	int capacity = 1;
+	while (capacity < n) capacity <<= 1;
+	return capacity;
+}
+
+// Returns the capacity to grow a full array to: the initial capacity for a
+// queue left without an array by a move, and double the capacity otherwise
+template <typename Type>
+int Dynamic_queue<Type>::grown_capacity() const {
+	if (array_capacity == 0)
+		return initial_capacity;
+
+	if (array_capacity >= MAX_CAPACITY)
+		throw overflow();
+
+	return array_capacity * 2;
+}
+
+// Allocates uninitialized storage for n elements; no constructors are run
+template <typename Type>
+Type *Dynamic_queue<Type>::allocate(int n) {
+	allocation_count++;
+	DS_STATS(statistics.bytes_allocated += static_cast<long long>(n) * sizeof(Type);)
+	return static_cast<Type *>(::operator new(n * sizeof(Type)));
+}
+
+// Moves n contiguous elements to uninitialized storage.
+// Trivially copyable types are copied as raw bytes...
+template <typename Type>
+void Dynamic_queue<Type>::relocate(Type *destination, Type *source, int n, std::true_type) {
+	if (n > 0) std::memcpy(static_cast<void *>(destination), static_cast<void const *>(source), n * sizeof(Type));
+}
+
+// ...while anything else is move constructed and the source destroyed
+template <typename Type>
+void Dynamic_queue<Type>::relocate(Type *destination, Type *source, int n, std::false_type) {
+	for (int i = 0; i < n; ++i) {
+		new (destination + i) Type(std::move(source[i]));
+		source[i].~Type();
+	}
+}
+
+// Destroys every element in the queue, leaving the storage in place
+template <typename Type>
+void Dynamic_queue<Type>::destroy_entries() {
+	for (int i = 0; i < entry_count; ++i) {
+		array[(ihead + i) & mask].~Type();
+	}
+}
+
+// Moves the entries into a new array of the given capacity, starting at index 0.
+// The entries occupy at most two contiguous runs of the old array:
+// from the head to the end of the array, and from the start of the array to the tail.
+template <typename Type>
+void Dynamic_queue<Type>::resize(int new_capacity) {
+	Type *temp_array = allocate(new_capacity);
+	DS_STATS(if (new_capacity > array_capacity) statistics.grows++; else statistics.shrinks++;)
+
+	int first_run = std::min(entry_count, array_capacity - ihead);
+	relocate(temp_array, array + ihead, first_run, std::is_trivially_copyable<Type>());
+	relocate(temp_array + first_run, array, entry_count - first_run, std::is_trivially_copyable<Type>());
+
+	::operator delete(array);	// Deallocate the old array from memory
+	array = temp_array;			// Assign the array to the newly created array
+	array_capacity = new_capacity;
+	mask = new_capacity - 1;
+	ihead = 0;
+	itail = (entry_count - 1) & mask;
+	low_water_count = 0;
+}
+
+// Called after each dequeue: decides, according to the shrink policy,
+// whether the array should now be halved
+template <typename Type>
+bool Dynamic_queue<Type>::should_shrink() {
+	if (array_capacity <= initial_capacity)
+		return false;
+
+	switch (shrink_policy) {
+	case SHRINK_IMMEDIATELY:
+		return entry_count <= array_capacity / 4;
+	case SHRINK_WITH_HYSTERESIS:
+		// Any dequeue above the low-water mark restarts the count
+		if (entry_count > array_capacity / 8) {
+			low_water_count = 0;
+			return false;
+		}
+		return ++low_water_count >= shrink_delay;
+	default:
+		return false;
+	}
 }
 
 // Returns the number of elements currently in the queue
@@ -94,9 +313,72 @@ bool Dynamic_queue<Type>::empty() const {
 	return entry_count == 0;
 }
 
+// Returns the number of arrays the queue has allocated, including its first
+template <typename Type>
+int Dynamic_queue<Type>::allocations() const {
+	return allocation_count;
+}
+
+// Returns the entries, in order, as at most two contiguous runs of the array:
+// the first from the head towards the end of the array, and the second, which
+// is empty unless the entries wrap around, from the start of the array.
+// The runs stay valid until the queue is next modified.
+template <typename Type>
+std::pair<Dynamic_queue_span<Type>, Dynamic_queue_span<Type> > Dynamic_queue<Type>::peek_span() const {
+	int first_run = std::min(entry_count, array_capacity - ihead);
+
+	Dynamic_queue_span<Type> first = { array + ihead, first_run };
+	Dynamic_queue_span<Type> second = { array, entry_count - first_run };
+	return std::make_pair(first, second);
+}
+
+// Returns the number of entries equal to the argument, scanning the
+// (at most two) contiguous runs of the array with the vectorized search
+template <typename Type>
+int Dynamic_queue<Type>::count(Type const &obj) const {
+	std::pair<Dynamic_queue_span<Type>, Dynamic_queue_span<Type> > runs = peek_span();
+	return simd_count(runs.first.data, runs.first.size, obj) + simd_count(runs.second.data, runs.second.size, obj);
+}
+
+#ifdef DS_ENABLE_STATS
+// Returns the event counters together with the current size and capacity
+template <typename Type>
+Dynamic_queue_stats Dynamic_queue<Type>::stats() const {
+	Dynamic_queue_stats snapshot = statistics;
+	snapshot.size = entry_count;
+	snapshot.capacity = array_capacity;
+	snapshot.allocations = allocation_count;
+	return snapshot;
+}
+#endif
+
+// Changes the shrink policy; the delay is only used by SHRINK_WITH_HYSTERESIS
+template <typename Type>
+void Dynamic_queue<Type>::set_shrink_policy(shrink_policy_t policy, int delay) {
+	shrink_policy = policy;
+	shrink_delay = std::max(delay, 1);
+	low_water_count = 0;
+}
+
+// Grows the array so that at least n entries fit without reallocating
+template <typename Type>
+void Dynamic_queue<Type>::reserve(int n) {
+	if (n > array_capacity)
+		resize(power_of_two(n));
+}
+
+// Shrinks the array to the smallest power of two that holds the entries,
+// but never below the initial capacity
+template <typename Type>
+void Dynamic_queue<Type>::shrink_to_fit() {
+	int target = std::max(initial_capacity, power_of_two(entry_count));
+	if (target < array_capacity)
+		resize(target);
+}
+
 // Returns the element at the top of the queue
 template <typename Type>
-Type Dynamic_queue<Type>::head() const {
+Type const &Dynamic_queue<Type>::head() const {
 	if (entry_count == 0) // Throws an underflow if the queue is empty
 		throw underflow();
 	return array[ihead];
@@ -106,10 +388,16 @@ template <typename Type>
 void Dynamic_queue<Type>::swap(Dynamic_queue<Type> &queue) {
 	std::swap(initial_capacity, queue.initial_capacity);
 	std::swap(array_capacity, queue.array_capacity);
+	std::swap(mask, queue.mask);
 	std::swap(array, queue.array);
 	std::swap(ihead, queue.ihead);
 	std::swap(itail, queue.itail);
 	std::swap(entry_count, queue.entry_count);
+	std::swap(shrink_policy, queue.shrink_policy);
+	std::swap(shrink_delay, queue.shrink_delay);
+	std::swap(low_water_count, queue.low_water_count);
+	std::swap(allocation_count, queue.allocation_count);
+	DS_STATS(std::swap(statistics, queue.statistics);)
 }
 
 template <typename Type>
@@ -122,92 +410,159 @@ Dynamic_queue<Type> &Dynamic_queue<Type>::operator=(Dynamic_queue<Type> rhs) {
 // Adds an element to the back of the queue
 template <typename Type>
 void Dynamic_queue<Type>::enqueue(Type const &obj) {
-	// If the array is full, double the array size and copy all elements over
-	if (entry_count == array_capacity){
-		Type *temp_array = new Type[array_capacity * 2];
-		// If the array is perfectly aligned, copy over.
-		if (ihead == 0){
-			for (int i = 0; i < array_capacity * 2; ++i)
-				temp_array[i] = array[i];
-		}
-		// If the array is not perfectly aligned, we have to reindex elements
-		// Since we know the array is full, and unaligned, itail < ihead.
-		else{
-			// Increment from the head to the end of the array.
-			for (int i = ihead + array_capacity; i < array_capacity * 2; ++i){
-				temp_array[i] = array[i - array_capacity];
-			}
-			// Increment from 0 to the tail. Leaving a gap in the middle.
-			for (int i = 0; i <= itail; ++i){
-				temp_array[i] = array[i];
-			}
-			ihead = ihead + array_capacity;
-		}
+	emplace(obj);
+}
 
-		delete[] array;			// Deallocate the old array from memory
-		array = temp_array;		// Assign the array to the newly created array
-		array_capacity *= 2;	// The array is now double it's old capacity
+template <typename Type>
+void Dynamic_queue<Type>::enqueue(Type &&obj) {
+	emplace(std::move(obj));
+}
+
+// Adds an element to the back of the queue, constructed in place from the arguments
+template <typename Type>
+template <typename... Args>
+void Dynamic_queue<Type>::emplace(Args &&... args) {
+	DS_STATS(Ds_latency_timer timer(statistics.enqueue_latency);)
+	// If the array is full, double the array size and move all elements over.
+	// The arguments may refer to an element of the queue itself, so construct the object first.
+	if (entry_count == array_capacity){
+		Type temp(std::forward<Args>(args)...);
+		resize(grown_capacity());
+		itail = (itail + 1) & mask;
+		new (array + itail) Type(std::move(temp));
+		entry_count++;
+		DS_STATS(statistics.enqueues++; statistics.peak_size = std::max(statistics.peak_size, entry_count);)
+		return;
 	}
-	if (itail != array_capacity - 1){
-		array[itail + 1] = obj;
-		itail++;
+	// The tail wraps around to the start of the array through the mask
+	int k = (itail + 1) & mask;
+	new (array + k) Type(std::forward<Args>(args)...);
+	itail = k;
+	entry_count++;
+	DS_STATS(statistics.enqueues++; statistics.peak_size = std::max(statistics.peak_size, entry_count);)
+}
+
+// Adds the elements of a range to the back of the queue
+template <typename Type>
+template <typename Iterator>
+void Dynamic_queue<Type>::enqueue_range(Iterator first, Iterator last) {
+	enqueue_range(first, last, typename std::iterator_traits<Iterator>::iterator_category());
+}
+
+// A single-pass range cannot be measured up front, so it is enqueued one element at a time
+template <typename Type>
+template <typename Iterator>
+void Dynamic_queue<Type>::enqueue_range(Iterator first, Iterator last, std::input_iterator_tag) {
+	for (; first != last; ++first)
+		enqueue(*first);
+}
+
+// Otherwise the array is grown at most once, and the elements are copied in
+// at most two contiguous runs: up to the end of the array, then from its start.
+// The range must not refer to entries of this queue.
+template <typename Type>
+template <typename Iterator>
+void Dynamic_queue<Type>::enqueue_range(Iterator first, Iterator last, std::forward_iterator_tag) {
+	int n = static_cast<int>(std::distance(first, last));
+	if (n <= 0)
+		return;
+
+	if (n > MAX_CAPACITY - entry_count)
+		throw overflow();
+
+	if (entry_count + n > array_capacity)
+		resize(power_of_two(entry_count + n));
+
+	int start = (itail + 1) & mask;
+	int first_run = std::min(n, array_capacity - start);
+
+	Iterator middle = first;
+	std::advance(middle, first_run);
+	std::uninitialized_copy(first, middle, array + start);
+	try {
+		std::uninitialized_copy(middle, last, array);
 	}
-	else{
-		array[0] = obj;
-		itail = 0;
+	catch (...) {
+		// Undo the first run so the queue is left unchanged
+		for (int i = 0; i < first_run; ++i)
+			array[start + i].~Type();
+		throw;
 	}
-	entry_count++;
+
+	itail = (itail + n) & mask;
+	entry_count += n;
+	DS_STATS(statistics.enqueues += n; statistics.peak_size = std::max(statistics.peak_size, entry_count);)
 }
 
 // Removes the element from the front of the queue
 template <typename Type>
 Type Dynamic_queue<Type>::dequeue() {
+	DS_STATS(Ds_latency_timer timer(statistics.dequeue_latency);)
 	if (empty()) // If the queue is empty, throw an underflow
 		throw underflow();
-	Type temp = array[ihead]; // Retrieve element at the head of the queue
-	
-	// If the head is not the last element in the array, increment
-	if (ihead != array_capacity - 1)
-		ihead++;
-	// If the head is the last element in the array, the head will be back at the beginning of the array
-	else
-		ihead = 0;
+	// Move the element out of the head of the queue, then destroy the slot
+	Type temp(std::move(array[ihead]));
+	array[ihead].~Type();
+
+	// The head wraps around to the start of the array through the mask
+	ihead = (ihead + 1) & mask;
 	// Since we are dequeueing, the total number of entires decreases by one
 	entry_count--;
-	// If the number of entries is less than or equal to 4, and array capacity > initial capacity
-	if (entry_count <= array_capacity / 4 && array_capacity > initial_capacity){
-		// Create a new array of half the size
-		Type *temp_array = new Type[array_capacity / 2];
-		int k = 0;
-		// Starting from the original head position, 
-		// iterate through the old array and copy elements over til
-		// the end of the array is reached
-		for (int i = ihead; i < array_capacity; ++i){
-			temp_array[k] = array[i];
-			k++;
-			}
-		if (itail < ihead){
-			for (int i = 0; i <= itail; ++i)
-			{
-				temp_array[k] = array[i];
-				k++;
-			}
-		}
-		itail = k;
-		array_capacity /= 2;
+	DS_STATS(statistics.dequeues++;)
+	// If the shrink policy says the array is now too empty,
+	// move the entries into an array of half the size
+	if (should_shrink()){
+		resize(array_capacity / 2);
 	}
 	return temp;
 }
 
+// Moves up to max elements from the front of the queue to the output iterator,
+// in at most two contiguous runs, and returns the number of elements moved.
+// The shrink policy is consulted once for the whole batch.
+template <typename Type>
+template <typename OutputIterator>
+int Dynamic_queue<Type>::dequeue_into(OutputIterator out, int max) {
+	int n = std::min(std::max(max, 0), entry_count);
+	if (n == 0)
+		return 0;
+
+	int first_run = std::min(n, array_capacity - ihead);
+	out = std::move(array + ihead, array + ihead + first_run, out);
+	std::move(array, array + (n - first_run), out);
+
+	discard(n);
+	return n;
+}
+
+// Removes up to n elements from the front of the queue without returning them,
+// for example after consuming them in place through peek_span()
+template <typename Type>
+void Dynamic_queue<Type>::discard(int n) {
+	n = std::min(std::max(n, 0), entry_count);
+	if (n == 0)
+		return;
+
+	for (int i = 0; i < n; ++i)
+		array[(ihead + i) & mask].~Type();
+
+	ihead = (ihead + n) & mask;
+	entry_count -= n;
+	DS_STATS(statistics.dequeues += n;)
+	if (should_shrink()){
+		resize(array_capacity / 2);
+	}
+}
+
 
+// Destroys the entries but keeps the array; use shrink_to_fit() to release it
 template <typename Type>
 void Dynamic_queue<Type>::clear() {
-	array_capacity = initial_capacity;
-	delete[] array;
-	array = new Type[array_capacity];
+	destroy_entries();
 	ihead = 0;
-	itail = 0;
+	itail = mask;
 	entry_count = 0;
+	low_water_count = 0;
 }
 
 template <typename Type>
@@ -0,0 +1,304 @@
+/*
+* Mpmc_queue
+*
+* This class implements a bounded, lock-free, multi-producer multi-consumer
+* queue after Dmitry Vyukov's bounded MPMC queue.
+*
+* Every slot of the ring carries a sequence number. A slot whose sequence
+* equals the producer position is free for the producer that claims that
+* position; a slot whose sequence is one past the consumer position holds an
+* element for the consumer that claims that position. Producers and consumers
+* each claim positions with one compare-and-swap on their own cache line,
+* then publish the slot with a release store of its new sequence number.
+*
+* ---------------------------------------------------------
+*                           Member Variables:
+*
+*  Mpmc_queue_cell *cells             The ring of slots, each with a sequence number and
+*                                     raw storage for one element
+*
+*  std::size_t mask                   The capacity less one (the capacity is a power of two)
+*
+*  std::atomic<std::size_t> enqueue_position
+*                                     The next position a producer will claim
+*
+*  std::atomic<std::size_t> dequeue_position
+*                                     The next position a consumer will claim
+*
+* ---------------------------------------------------------
+*                   Member Functions:
+*
+* bool try_enqueue(Type const &);
+* bool try_enqueue(Type &&);
+*   Returns false if the queue is full.
+*
+* void enqueue(Type const &);
+* void enqueue(Type &&);
+*   Waits, yielding the processor, until there is room.
+*
+* bool try_dequeue(Type &);
+*   Moves the head of the queue into the argument. Returns false if the queue is empty.
+*
+* Type dequeue();
+*   Waits, yielding the processor, until an element is available.
+*
+* int size() const;
+* bool empty() const;
+*   Approximate while other threads are active.
+*
+* int capacity() const;
+*   Returns the number of elements the queue can hold.
+*
+* ---------------------------------------------------------
+*                   Instrumentation (DS_ENABLE_STATS, see Ds_stats.h):
+*
+* Mpmc_queue_stats stats() const
+*   Returns a snapshot of the elements enqueued and dequeued, the attempts that found
+*   the queue full or empty, and the positions a producer or consumer lost to another
+*   and had to retry. Retries per operation measure the contention on each end.
+*/
+
+#ifndef MPMC_QUEUE_H
+#define MPMC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "ece250.h"
+#include "Exception.h"
+#include "Cache_aligned.h"
+#include "Ds_stats.h"
+
+#ifdef DS_ENABLE_STATS
+// A snapshot of the counters of an Mpmc_queue (see Ds_stats.h)
+struct Mpmc_queue_stats {
+	int size;
+	int capacity;
+	Ds_counter enqueues;
+	Ds_counter full_attempts;		// Enqueue attempts that found the queue full
+	Ds_counter enqueue_retries;		// Positions another producer claimed first
+	Ds_counter dequeues;
+	Ds_counter empty_attempts;		// Dequeue attempts that found the queue empty
+	Ds_counter dequeue_retries;		// Positions another consumer claimed first
+
+	Mpmc_queue_stats() :
+	size(0), capacity(0) {
+		// Empty constructor
+	}
+};
+#endif
+
+template <typename Type>
+struct Mpmc_queue_cell {
+	std::atomic<std::size_t> sequence;
+	typename std::aligned_storage<sizeof(Type), alignof(Type)>::type storage;
+
+	Type *element() {
+		return reinterpret_cast<Type *>(&storage);
+	}
+};
+
+template <typename Type>
+class Mpmc_queue : public Cache_aligned {
+private:
+	// Member variables
+	Mpmc_queue_cell<Type> *cells;
+	std::size_t mask;
+
+	alignas(64) std::atomic<std::size_t> enqueue_position;
+	alignas(64) std::atomic<std::size_t> dequeue_position;
+#ifdef DS_ENABLE_STATS
+	alignas(64) Mpmc_queue_stats statistics;
+#endif
+
+	// Do not implement these functions!
+	// The queue is shared between threads and can be neither copied nor assigned
+	Mpmc_queue(Mpmc_queue const &);
+	Mpmc_queue &operator=(Mpmc_queue const &);
+
+	template <typename Arg>
+	bool push_value(Arg &&);
+
+public:
+	Mpmc_queue(int = 1024);
+	~Mpmc_queue();
+
+	int size() const;
+	bool empty() const;
+	int capacity() const;
+#ifdef DS_ENABLE_STATS
+	Mpmc_queue_stats stats() const;
+#endif
+
+	bool try_enqueue(Type const &);
+	bool try_enqueue(Type &&);
+	void enqueue(Type const &);
+	void enqueue(Type &&);
+	bool try_dequeue(Type &);
+	Type dequeue();
+};
+
+// Creates a queue with room for at least n elements, rounded up to a power of two
+template <typename Type>
+Mpmc_queue<Type>::Mpmc_queue(int n) :
+cells(nullptr),
+mask(0),
+enqueue_position(0),
+dequeue_position(0) {
+	std::size_t cap = 2;
+	while (cap < static_cast<std::size_t>(n)) cap <<= 1;
+
+	mask = cap - 1;
+	cells = new Mpmc_queue_cell<Type>[cap];
+
+	// Slot i is initially free for the producer that claims position i
+	for (std::size_t i = 0; i < cap; ++i) {
+		cells[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+// Destructor: destroys the elements still in the queue, then frees the ring
+template <typename Type>
+Mpmc_queue<Type>::~Mpmc_queue() {
+	std::size_t head = dequeue_position.load(std::memory_order_relaxed);
+	std::size_t tail = enqueue_position.load(std::memory_order_relaxed);
+
+	for (std::size_t i = head; i != tail; ++i) {
+		cells[i & mask].element()->~Type();
+	}
+	delete[] cells;
+}
+
+template <typename Type>
+int Mpmc_queue<Type>::size() const {
+	std::size_t tail = enqueue_position.load(std::memory_order_acquire);
+	std::size_t head = dequeue_position.load(std::memory_order_acquire);
+	return (tail > head) ? static_cast<int>(tail - head) : 0;
+}
+
+template <typename Type>
+bool Mpmc_queue<Type>::empty() const {
+	return size() == 0;
+}
+
+template <typename Type>
+int Mpmc_queue<Type>::capacity() const {
+	return static_cast<int>(mask + 1);
+}
+
+#ifdef DS_ENABLE_STATS
+// Returns the event counters together with the current size and capacity
+template <typename Type>
+Mpmc_queue_stats Mpmc_queue<Type>::stats() const {
+	Mpmc_queue_stats snapshot = statistics;
+	snapshot.size = size();
+	snapshot.capacity = capacity();
+	return snapshot;
+}
+#endif
+
+template <typename Type>
+bool Mpmc_queue<Type>::try_enqueue(Type const &obj) {
+	return push_value(obj);
+}
+
+template <typename Type>
+bool Mpmc_queue<Type>::try_enqueue(Type &&obj) {
+	return push_value(std::move(obj));
+}
+
+template <typename Type>
+template <typename Arg>
+bool Mpmc_queue<Type>::push_value(Arg &&obj) {
+	Mpmc_queue_cell<Type> *cell;
+	std::size_t position = enqueue_position.load(std::memory_order_relaxed);
+
+	while (true) {
+		cell = cells + (position & mask);
+		std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+		std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+		// The slot is free for this position: try to claim the position
+		if (difference == 0) {
+			if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+		}
+		// The slot still holds the element from one lap ago: the queue is full
+		else if (difference < 0) {
+			DS_STATS(statistics.full_attempts.add();)
+			return false;
+		}
+		// Another producer claimed this position first
+		else {
+			position = enqueue_position.load(std::memory_order_relaxed);
+		}
+		DS_STATS(statistics.enqueue_retries.add();)
+	}
+
+	new (cell->element()) Type(std::forward<Arg>(obj));
+
+	// Hand the slot to the consumer that will claim this position
+	cell->sequence.store(position + 1, std::memory_order_release);
+	DS_STATS(statistics.enqueues.add();)
+	return true;
+}
+
+template <typename Type>
+void Mpmc_queue<Type>::enqueue(Type const &obj) {
+	while (!push_value(obj)) std::this_thread::yield();
+}
+
+template <typename Type>
+void Mpmc_queue<Type>::enqueue(Type &&obj) {
+	while (!push_value(std::move(obj))) std::this_thread::yield();
+}
+
+template <typename Type>
+bool Mpmc_queue<Type>::try_dequeue(Type &obj) {
+	Mpmc_queue_cell<Type> *cell;
+	std::size_t position = dequeue_position.load(std::memory_order_relaxed);
+
+	while (true) {
+		cell = cells + (position & mask);
+		std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+		std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position + 1);
+
+		// The slot holds the element for this position: try to claim the position
+		if (difference == 0) {
+			if (dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+		}
+		// No producer has filled this slot yet: the queue is empty
+		else if (difference < 0) {
+			DS_STATS(statistics.empty_attempts.add();)
+			return false;
+		}
+		// Another consumer claimed this position first
+		else {
+			position = dequeue_position.load(std::memory_order_relaxed);
+		}
+		DS_STATS(statistics.dequeue_retries.add();)
+	}
+
+	Type *slot = cell->element();
+	obj = std::move(*slot);
+	slot->~Type();
+
+	// Free the slot for the producer one lap ahead
+	cell->sequence.store(position + mask + 1, std::memory_order_release);
+	DS_STATS(statistics.dequeues.add();)
+	return true;
+}
+
+template <typename Type>
+Type Mpmc_queue<Type>::dequeue() {
+	Type returnval;
+
+	// Wait until an element can be claimed
+	while (!try_dequeue(returnval)) std::this_thread::yield();
+
+	return returnval;
+}
+
+#endif
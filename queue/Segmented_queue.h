@@ -0,0 +1,431 @@
+/*
+* Segmented_queue
+*
+* This class implements an unbounded queue stored as a singly linked list of
+* fixed-size chunks, in the way Linked_stack stores its elements in arrays of
+* eight. Unlike Dynamic_queue it never reallocates or copies its contents:
+* enqueue constructs into the tail chunk and links a new chunk when that one
+* is full, and dequeue unlinks the head chunk once it has been drained. Both
+* are O(1) in the worst case.
+*
+* Drained chunks are kept on a free list and reused by later enqueues, so a
+* queue that repeatedly fills and drains stops allocating after the first
+* burst. At most spare_limit chunks are kept; shrink_to_fit() frees them all.
+*
+* ---------------------------------------------------------
+*                           Member Variables:
+*
+*  Segmented_queue_chunk *head_chunk  The chunk holding the head of the queue
+*  Segmented_queue_chunk *tail_chunk  The chunk holding the tail of the queue
+*                                     Both are nullptr until the first enqueue.
+*
+*  int ihead                          Index of the head within head_chunk
+*  int itail                          Index one past the tail within tail_chunk
+*
+*  int queue_size                     The number of elements in the queue
+*
+*  Segmented_queue_chunk *free_chunks Drained chunks waiting to be reused
+*  int free_count                     The number of chunks on the free list
+*  int spare_limit                    The most chunks the free list may hold
+*
+*  CHUNK_CAPACITY (template)          Elements per chunk. The default fills about 4 KiB,
+*                                     and every chunk starts on a cache line boundary.
+*
+* ---------------------------------------------------------
+*                   Member Functions (Accessors):
+*
+* Type const &head() const
+*   Returns the element at the head of the queue. Throws an underflow if the queue is empty.
+*
+* int size() const
+* bool empty() const
+*
+* int chunks() const
+*   Returns the number of chunks linked into the queue, not counting the free list.
+*
+* ---------------------------------------------------------
+*                   Member Functions (Mutators):
+*
+* void enqueue(Type const &);
+* void enqueue(Type &&);
+*   Adds an element to the back of the queue.
+*
+* Type dequeue();
+*   Removes the element at the head of the queue and returns it.
+*   Throws an underflow if the queue is empty.
+*
+* void clear();
+*   Destroys every element, keeping the chunks for reuse up to the spare limit.
+*
+* void shrink_to_fit();
+*   Frees every chunk on the free list.
+*
+* ---------------------------------------------------------
+*                   Instrumentation (DS_ENABLE_STATS, see Ds_stats.h):
+*
+* Segmented_queue_stats stats() const
+*   Returns a snapshot of the chunk traffic: how many chunks were allocated, how many
+*   were taken back off the free list, and how many were freed because the free list
+*   was at its spare limit, together with sampled enqueue and dequeue latencies.
+*/
+
+#ifndef SEGMENTED_QUEUE_H
+#define SEGMENTED_QUEUE_H
+
+#include <algorithm>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "ece250.h"
+#include "Exception.h"
+#include "Cache_aligned.h"
+#include "Ds_stats.h"
+
+#ifdef DS_ENABLE_STATS
+// A snapshot of the counters of a Segmented_queue (see Ds_stats.h)
+struct Segmented_queue_stats {
+	int size;
+	int chunks;						// Chunks linked into the queue
+	int spare_chunks;				// Chunks on the free list
+	int peak_size;
+	long long chunk_allocations;	// Chunks allocated with new
+	long long chunk_reuses;			// Chunks taken back off the free list
+	long long chunk_recycles;		// Drained chunks put on the free list
+	long long chunk_frees;			// Chunks freed, at the spare limit or by shrink_to_fit()
+	long long enqueues;
+	long long dequeues;
+	Ds_latency_histogram enqueue_latency;	// Sampled; one chunk allocation included
+	Ds_latency_histogram dequeue_latency;	// Sampled; one chunk recycle included
+
+	Segmented_queue_stats() :
+	size(0), chunks(0), spare_chunks(0), peak_size(0), chunk_allocations(0), chunk_reuses(0),
+	chunk_recycles(0), chunk_frees(0), enqueues(0), dequeues(0) {
+		// Empty constructor
+	}
+};
+#endif
+
+template <typename Type>
+struct Segmented_queue_default_capacity {
+	static int const value = (sizeof(Type) < (4096 - 64) / 2) ? static_cast<int>((4096 - 64) / sizeof(Type)) : 2;
+};
+
+template <typename Type, int N>
+struct alignas(64) Segmented_queue_chunk : Cache_aligned {
+	Segmented_queue_chunk *next_chunk;
+	typename std::aligned_storage<sizeof(Type), alignof(Type)>::type slots[N];
+
+	Type *slot(int i) {
+		return reinterpret_cast<Type *>(slots + i);
+	}
+
+	Type const *slot(int i) const {
+		return reinterpret_cast<Type const *>(slots + i);
+	}
+};
+
+template <typename Type, int CHUNK_CAPACITY = Segmented_queue_default_capacity<Type>::value>
+class Segmented_queue {
+private:
+	static_assert(CHUNK_CAPACITY >= 1, "a chunk must hold at least one element");
+
+	typedef Segmented_queue_chunk<Type, CHUNK_CAPACITY> chunk;
+
+	chunk *head_chunk;
+	chunk *tail_chunk;
+	int ihead;
+	int itail;
+	int queue_size;
+	int chunk_count;
+	chunk *free_chunks;
+	int free_count;
+	int spare_limit;
+#ifdef DS_ENABLE_STATS
+	Segmented_queue_stats statistics;
+#endif
+
+	chunk *take_chunk();
+	void recycle_chunk(chunk *);
+	template <typename Arg>
+	void push_value(Arg &&);
+
+public:
+	Segmented_queue(int = 16);
+	Segmented_queue(Segmented_queue const &);
+	~Segmented_queue();
+
+	Type const &head() const;
+	int size() const;
+	bool empty() const;
+	int chunks() const;
+#ifdef DS_ENABLE_STATS
+	Segmented_queue_stats stats() const;
+#endif
+
+	void swap(Segmented_queue &);
+	Segmented_queue &operator=(Segmented_queue);
+	void enqueue(Type const &);
+	void enqueue(Type &&);
+	Type dequeue();
+	void clear();
+	void shrink_to_fit();
+
+	// Friends
+
+	template <typename T, int M>
+	friend std::ostream &operator<<(std::ostream &, Segmented_queue<T, M> const &);
+};
+
+template <typename Type, int CHUNK_CAPACITY>
+Segmented_queue<Type, CHUNK_CAPACITY>::Segmented_queue(int spares) :
+head_chunk(nullptr),
+tail_chunk(nullptr),
+ihead(0),
+itail(0),
+queue_size(0),
+chunk_count(0),
+free_chunks(nullptr),
+free_count(0),
+spare_limit(std::max(spares, 0)) {
+}
+
+// Copy Constructor: enqueues a copy of each element, in order
+template <typename Type, int CHUNK_CAPACITY>
+Segmented_queue<Type, CHUNK_CAPACITY>::Segmented_queue(Segmented_queue const &queue) :
+head_chunk(nullptr),
+tail_chunk(nullptr),
+ihead(0),
+itail(0),
+queue_size(0),
+chunk_count(0),
+free_chunks(nullptr),
+free_count(0),
+spare_limit(queue.spare_limit) {
+	int index = queue.ihead;
+	for (chunk *c = queue.head_chunk; c != nullptr; c = c->next_chunk) {
+		int last = (c == queue.tail_chunk) ? queue.itail : CHUNK_CAPACITY;
+		for (; index < last; ++index) {
+			enqueue(*c->slot(index));
+		}
+		index = 0;
+	}
+}
+
+// Destructor: destroys the elements, then frees the chunks and the free list
+template <typename Type, int CHUNK_CAPACITY>
+Segmented_queue<Type, CHUNK_CAPACITY>::~Segmented_queue() {
+	clear();
+	recycle_chunk(head_chunk);
+	head_chunk = tail_chunk = nullptr;
+	spare_limit = 0;
+	shrink_to_fit();
+}
+
+// Returns a chunk to fill, reusing one from the free list if there is one
+template <typename Type, int CHUNK_CAPACITY>
+typename Segmented_queue<Type, CHUNK_CAPACITY>::chunk *Segmented_queue<Type, CHUNK_CAPACITY>::take_chunk() {
+	chunk *c = free_chunks;
+	if (c != nullptr) {
+		free_chunks = c->next_chunk;
+		free_count--;
+		DS_STATS(statistics.chunk_reuses++;)
+	}
+	else {
+		c = new chunk;
+		DS_STATS(statistics.chunk_allocations++;)
+	}
+	c->next_chunk = nullptr;
+	chunk_count++;
+	return c;
+}
+
+// Puts a drained chunk on the free list, or frees it if the list is full
+template <typename Type, int CHUNK_CAPACITY>
+void Segmented_queue<Type, CHUNK_CAPACITY>::recycle_chunk(chunk *c) {
+	if (c == nullptr)
+		return;
+
+	chunk_count--;
+	if (free_count < spare_limit) {
+		c->next_chunk = free_chunks;
+		free_chunks = c;
+		free_count++;
+		DS_STATS(statistics.chunk_recycles++;)
+	}
+	else {
+		delete c;
+		DS_STATS(statistics.chunk_frees++;)
+	}
+}
+
+template <typename Type, int CHUNK_CAPACITY>
+Type const &Segmented_queue<Type, CHUNK_CAPACITY>::head() const {
+	if (empty()) // Throws an underflow if the queue is empty
+		throw underflow();
+	return *head_chunk->slot(ihead);
+}
+
+template <typename Type, int CHUNK_CAPACITY>
+int Segmented_queue<Type, CHUNK_CAPACITY>::size() const {
+	return queue_size;
+}
+
+template <typename Type, int CHUNK_CAPACITY>
+bool Segmented_queue<Type, CHUNK_CAPACITY>::empty() const {
+	return queue_size == 0;
+}
+
+template <typename Type, int CHUNK_CAPACITY>
+int Segmented_queue<Type, CHUNK_CAPACITY>::chunks() const {
+	return chunk_count;
+}
+
+#ifdef DS_ENABLE_STATS
+// Returns the event counters together with the current size and chunks
+template <typename Type, int CHUNK_CAPACITY>
+Segmented_queue_stats Segmented_queue<Type, CHUNK_CAPACITY>::stats() const {
+	Segmented_queue_stats snapshot = statistics;
+	snapshot.size = queue_size;
+	snapshot.chunks = chunk_count;
+	snapshot.spare_chunks = free_count;
+	return snapshot;
+}
+#endif
+
+template <typename Type, int CHUNK_CAPACITY>
+void Segmented_queue<Type, CHUNK_CAPACITY>::swap(Segmented_queue<Type, CHUNK_CAPACITY> &queue) {
+	std::swap(head_chunk, queue.head_chunk);
+	std::swap(tail_chunk, queue.tail_chunk);
+	std::swap(ihead, queue.ihead);
+	std::swap(itail, queue.itail);
+	std::swap(queue_size, queue.queue_size);
+	std::swap(chunk_count, queue.chunk_count);
+	std::swap(free_chunks, queue.free_chunks);
+	std::swap(free_count, queue.free_count);
+	std::swap(spare_limit, queue.spare_limit);
+	DS_STATS(std::swap(statistics, queue.statistics);)
+}
+
+template <typename Type, int CHUNK_CAPACITY>
+Segmented_queue<Type, CHUNK_CAPACITY> &Segmented_queue<Type, CHUNK_CAPACITY>::operator=(Segmented_queue<Type, CHUNK_CAPACITY> rhs) {
+	swap(rhs);
+
+	return *this;
+}
+
+// Adds an element to the back of the queue
+template <typename Type, int CHUNK_CAPACITY>
+void Segmented_queue<Type, CHUNK_CAPACITY>::enqueue(Type const &obj) {
+	push_value(obj);
+}
+
+template <typename Type, int CHUNK_CAPACITY>
+void Segmented_queue<Type, CHUNK_CAPACITY>::enqueue(Type &&obj) {
+	push_value(std::move(obj));
+}
+
+template <typename Type, int CHUNK_CAPACITY>
+template <typename Arg>
+void Segmented_queue<Type, CHUNK_CAPACITY>::push_value(Arg &&obj) {
+	DS_STATS(Ds_latency_timer timer(statistics.enqueue_latency);)
+
+	// The very first chunk serves as both head and tail
+	if (tail_chunk == nullptr) {
+		head_chunk = tail_chunk = take_chunk();
+		ihead = itail = 0;
+	}
+	// If the tail chunk is full, link a new one after it
+	else if (itail == CHUNK_CAPACITY) {
+		chunk *c = take_chunk();
+		tail_chunk->next_chunk = c;
+		tail_chunk = c;
+		itail = 0;
+	}
+
+	new (tail_chunk->slot(itail)) Type(std::forward<Arg>(obj));
+	itail++;
+	queue_size++;
+	DS_STATS(statistics.enqueues++; statistics.peak_size = std::max(statistics.peak_size, queue_size);)
+}
+
+// Removes the element from the front of the queue
+template <typename Type, int CHUNK_CAPACITY>
+Type Segmented_queue<Type, CHUNK_CAPACITY>::dequeue() {
+	if (empty()) // If the queue is empty, throw an underflow
+		throw underflow();
+
+	DS_STATS(Ds_latency_timer timer(statistics.dequeue_latency);)
+	Type *slot = head_chunk->slot(ihead);
+	Type temp(std::move(*slot));
+	slot->~Type();
+	ihead++;
+	queue_size--;
+	DS_STATS(statistics.dequeues++;)
+
+	// If the queue is now empty, start over at the front of the same chunk
+	if (queue_size == 0) {
+		ihead = itail = 0;
+	}
+	// If the head chunk has been drained, unlink it and move on to the next
+	else if (ihead == CHUNK_CAPACITY) {
+		chunk *c = head_chunk;
+		head_chunk = c->next_chunk;
+		recycle_chunk(c);
+		ihead = 0;
+	}
+
+	return temp;
+}
+
+// Destroys every element and recycles every chunk except the head chunk
+template <typename Type, int CHUNK_CAPACITY>
+void Segmented_queue<Type, CHUNK_CAPACITY>::clear() {
+	while (head_chunk != nullptr && head_chunk != tail_chunk) {
+		for (int i = ihead; i < CHUNK_CAPACITY; ++i) {
+			head_chunk->slot(i)->~Type();
+		}
+		chunk *c = head_chunk;
+		head_chunk = c->next_chunk;
+		recycle_chunk(c);
+		ihead = 0;
+	}
+
+	if (head_chunk != nullptr) {
+		for (int i = ihead; i < itail; ++i) {
+			head_chunk->slot(i)->~Type();
+		}
+	}
+
+	ihead = itail = 0;
+	queue_size = 0;
+}
+
+// Frees every chunk on the free list
+template <typename Type, int CHUNK_CAPACITY>
+void Segmented_queue<Type, CHUNK_CAPACITY>::shrink_to_fit() {
+	while (free_chunks != nullptr) {
+		chunk *c = free_chunks;
+		free_chunks = c->next_chunk;
+		delete c;
+		DS_STATS(statistics.chunk_frees++;)
+	}
+	free_count = 0;
+}
+
+template <typename T, int M>
+std::ostream &operator<<(std::ostream &out, Segmented_queue<T, M> const &queue) {
+	int index = queue.ihead;
+	for (typename Segmented_queue<T, M>::chunk *c = queue.head_chunk; c != nullptr; c = c->next_chunk) {
+		int last = (c == queue.tail_chunk) ? queue.itail : M;
+		out << "[ ";
+		for (; index < last; ++index) {
+			out << *c->slot(index) << " ";
+		}
+		out << "]";
+		index = 0;
+	}
+
+	return out;
+}
+
+#endif
@@ -0,0 +1,292 @@
+/*
+* Spsc_queue
+*
+* This class implements a bounded, lock-free, single-producer single-consumer
+* ring buffer for handing elements from one thread to another.
+*
+* Exactly one thread may enqueue and exactly one (other) thread may dequeue.
+* The producer owns the tail index and the consumer owns the head index; each
+* index sits on its own cache line next to the owner's cached copy of the other
+* index, so in the common case neither thread touches the other's cache line.
+* Publication uses release stores and acquire loads only.
+*
+* ---------------------------------------------------------
+*                           Member Variables:
+*
+*  Type        *array                 Raw storage for the ring; slots are only constructed
+*                                     while they hold an element
+*
+*  std::size_t mask                   The capacity less one. The capacity is a power of two,
+*                                     so an index is reduced to a slot with (index & mask)
+*
+*  std::atomic<std::size_t> ihead     Count of elements dequeued so far (written by the consumer)
+*  std::atomic<std::size_t> itail     Count of elements enqueued so far (written by the producer)
+*
+*  std::size_t cached_head            The producer's last view of ihead
+*  std::size_t cached_tail            The consumer's last view of itail
+*
+* ---------------------------------------------------------
+*                   Member Functions:
+*
+* bool try_enqueue(Type const &);
+* bool try_enqueue(Type &&);
+*   Producer only. Returns false if the ring is full.
+*
+* void enqueue(Type const &);
+* void enqueue(Type &&);
+*   Producer only. Waits, yielding the processor, until there is room.
+*
+* bool try_dequeue(Type &);
+*   Consumer only. Moves the head of the queue into the argument.
+*   Returns false if the ring is empty.
+*
+* Type dequeue();
+*   Consumer only. Waits, yielding the processor, until an element is available.
+*
+* int size() const;
+* bool empty() const;
+*   Approximate when called while the other thread is active.
+*
+* int capacity() const;
+*   Returns the number of elements the ring can hold.
+*
+* ---------------------------------------------------------
+*                   Instrumentation (DS_ENABLE_STATS, see Ds_stats.h):
+*
+* Spsc_queue_stats stats() const
+*   Returns a snapshot of the elements enqueued and dequeued, the attempts that found
+*   the ring full or empty, and how often each side had to reload the other's index
+*   because its cached copy ran out. Each side's counters sit on its own cache line.
+*   Reloads on most operations mean the ring is running nearly empty or nearly full,
+*   with the two threads trading cache lines.
+*/
+
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <thread>
+#include <utility>
+#include "ece250.h"
+#include "Exception.h"
+#include "Cache_aligned.h"
+#include "Ds_stats.h"
+
+#ifdef DS_ENABLE_STATS
+// A snapshot of the counters of an Spsc_queue (see Ds_stats.h)
+struct Spsc_queue_stats {
+	int size;
+	int capacity;
+	Ds_counter enqueues;
+	Ds_counter full_attempts;		// Enqueue attempts that found the ring full
+	Ds_counter head_reloads;		// Times the producer reloaded ihead
+	Ds_counter dequeues;
+	Ds_counter empty_attempts;		// Dequeue attempts that found the ring empty
+	Ds_counter tail_reloads;		// Times the consumer reloaded itail
+
+	Spsc_queue_stats() :
+	size(0), capacity(0) {
+		// Empty constructor
+	}
+};
+#endif
+
+template <typename Type>
+class Spsc_queue : public Cache_aligned {
+private:
+	// Member variables
+	Type *array;
+	std::size_t mask;
+
+	// Consumer side
+	alignas(64) std::atomic<std::size_t> ihead;
+	std::size_t cached_tail;
+#ifdef DS_ENABLE_STATS
+	Spsc_queue_stats consumer_statistics;
+#endif
+
+	// Producer side
+	alignas(64) std::atomic<std::size_t> itail;
+	std::size_t cached_head;
+#ifdef DS_ENABLE_STATS
+	Spsc_queue_stats producer_statistics;
+#endif
+
+	// Do not implement these functions!
+	// The queue is shared between two threads and can be neither copied nor assigned
+	Spsc_queue(Spsc_queue const &);
+	Spsc_queue &operator=(Spsc_queue const &);
+
+	template <typename Arg>
+	bool push_value(Arg &&);
+
+public:
+	Spsc_queue(int = 1024);
+	~Spsc_queue();
+
+	int size() const;
+	bool empty() const;
+	int capacity() const;
+#ifdef DS_ENABLE_STATS
+	Spsc_queue_stats stats() const;
+#endif
+
+	bool try_enqueue(Type const &);
+	bool try_enqueue(Type &&);
+	void enqueue(Type const &);
+	void enqueue(Type &&);
+	bool try_dequeue(Type &);
+	Type dequeue();
+};
+
+// Creates a ring with room for at least n elements, rounded up to a power of two
+template <typename Type>
+Spsc_queue<Type>::Spsc_queue(int n) :
+array(nullptr),
+mask(0),
+ihead(0),
+cached_tail(0),
+itail(0),
+cached_head(0) {
+	std::size_t cap = 1;
+	while (cap < static_cast<std::size_t>(n)) cap <<= 1;
+
+	mask = cap - 1;
+	array = static_cast<Type *>(::operator new(cap * sizeof(Type)));
+}
+
+// Destructor: destroys the elements still in the ring, then frees the storage
+template <typename Type>
+Spsc_queue<Type>::~Spsc_queue() {
+	std::size_t head = ihead.load(std::memory_order_relaxed);
+	std::size_t tail = itail.load(std::memory_order_relaxed);
+
+	for (std::size_t i = head; i != tail; ++i) {
+		array[i & mask].~Type();
+	}
+	::operator delete(array);
+}
+
+template <typename Type>
+int Spsc_queue<Type>::size() const {
+	std::size_t tail = itail.load(std::memory_order_acquire);
+	std::size_t head = ihead.load(std::memory_order_acquire);
+	return static_cast<int>(tail - head);
+}
+
+template <typename Type>
+bool Spsc_queue<Type>::empty() const {
+	return size() == 0;
+}
+
+template <typename Type>
+int Spsc_queue<Type>::capacity() const {
+	return static_cast<int>(mask + 1);
+}
+
+#ifdef DS_ENABLE_STATS
+// Returns the counters of both sides together with the current size and capacity
+template <typename Type>
+Spsc_queue_stats Spsc_queue<Type>::stats() const {
+	Spsc_queue_stats snapshot = producer_statistics;
+	snapshot.dequeues = consumer_statistics.dequeues;
+	snapshot.empty_attempts = consumer_statistics.empty_attempts;
+	snapshot.tail_reloads = consumer_statistics.tail_reloads;
+	snapshot.size = size();
+	snapshot.capacity = capacity();
+	return snapshot;
+}
+#endif
+
+template <typename Type>
+bool Spsc_queue<Type>::try_enqueue(Type const &obj) {
+	return push_value(obj);
+}
+
+template <typename Type>
+bool Spsc_queue<Type>::try_enqueue(Type &&obj) {
+	return push_value(std::move(obj));
+}
+
+template <typename Type>
+template <typename Arg>
+bool Spsc_queue<Type>::push_value(Arg &&obj) {
+	std::size_t tail = itail.load(std::memory_order_relaxed);
+
+	// Only reload the consumer's index when the cached copy says the ring is full
+	if (tail - cached_head > mask) {
+		cached_head = ihead.load(std::memory_order_acquire);
+		DS_STATS(producer_statistics.head_reloads.add();)
+		if (tail - cached_head > mask) {
+			DS_STATS(producer_statistics.full_attempts.add();)
+			return false;
+		}
+	}
+
+	new (array + (tail & mask)) Type(std::forward<Arg>(obj));
+
+	// Publish the element to the consumer
+	itail.store(tail + 1, std::memory_order_release);
+	DS_STATS(producer_statistics.enqueues.add();)
+	return true;
+}
+
+template <typename Type>
+void Spsc_queue<Type>::enqueue(Type const &obj) {
+	while (!push_value(obj)) std::this_thread::yield();
+}
+
+template <typename Type>
+void Spsc_queue<Type>::enqueue(Type &&obj) {
+	while (!push_value(std::move(obj))) std::this_thread::yield();
+}
+
+template <typename Type>
+bool Spsc_queue<Type>::try_dequeue(Type &obj) {
+	std::size_t head = ihead.load(std::memory_order_relaxed);
+
+	// Only reload the producer's index when the cached copy says the ring is empty
+	if (head == cached_tail) {
+		cached_tail = itail.load(std::memory_order_acquire);
+		DS_STATS(consumer_statistics.tail_reloads.add();)
+		if (head == cached_tail) {
+			DS_STATS(consumer_statistics.empty_attempts.add();)
+			return false;
+		}
+	}
+
+	Type *slot = array + (head & mask);
+	obj = std::move(*slot);
+	slot->~Type();
+
+	// Hand the slot back to the producer
+	ihead.store(head + 1, std::memory_order_release);
+	DS_STATS(consumer_statistics.dequeues.add();)
+	return true;
+}
+
+template <typename Type>
+Type Spsc_queue<Type>::dequeue() {
+	std::size_t head = ihead.load(std::memory_order_relaxed);
+
+	while (head == cached_tail) {
+		cached_tail = itail.load(std::memory_order_acquire);
+		DS_STATS(consumer_statistics.tail_reloads.add();)
+		if (head == cached_tail) {
+			DS_STATS(consumer_statistics.empty_attempts.add();)
+			std::this_thread::yield();
+		}
+	}
+
+	Type *slot = array + (head & mask);
+	Type returnval(std::move(*slot));
+	slot->~Type();
+
+	ihead.store(head + 1, std::memory_order_release);
+	DS_STATS(consumer_statistics.dequeues.add();)
+	return returnval;
+}
+
+#endif
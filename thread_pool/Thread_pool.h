@@ -0,0 +1,466 @@
+/*
+* Thread_pool
+*
+* This class implements a work-stealing thread pool: a fixed set of worker
+* threads that run tasks submitted from any thread.
+*
+* Each worker owns a Chase_lev_deque of tasks. A task submitted by a worker
+* (for example, one half of a divide-and-conquer step) goes onto the back of
+* that worker's own deque without taking a lock, and the worker runs its own
+* tasks newest first, while the data they touch is still in its cache. A
+* worker whose deque is empty steals the oldest task from the front of
+* another worker's deque, trying the others in turn from a random one, so
+* idle threads spread themselves over the busy ones.
+*
+* Tasks submitted from outside the pool go into a shared injection queue, a
+* Dynamic_queue behind a mutex. A worker that finds its own deque empty takes
+* up to INJECTION_BATCH of them under a single acquisition of the lock, runs
+* the first and pushes the rest onto its deque, where other workers can steal
+* them; a burst of external submissions therefore costs one lock round trip
+* per batch rather than per task.
+*
+* Workers with nothing to run sleep on a condition variable; submitting a task
+* only takes the lock to wake one when some worker is actually asleep.
+*
+* ---------------------------------------------------------
+*                           Member Variables:
+*
+*  Thread_pool_worker *workers        One deque and thread per worker, each on its own cache lines
+*  int worker_count                   The number of workers
+*
+*  Dynamic_queue<Thread_pool_task *> injected     Tasks submitted from outside the pool
+*  std::atomic<int> injected_count    The number of tasks in the injection queue
+*
+*  std::atomic<int> queued_tasks      Tasks waiting in a deque or the injection queue
+*  std::atomic<int> pending_tasks     Tasks submitted but not yet finished
+*  std::atomic<int> idle_workers      Workers asleep, or about to sleep, on work_available
+*  bool stopping                      Set by the destructor to end the workers
+*
+*  std::mutex lock                    Guards the injection queue and the condition variables
+*  std::condition_variable work_available, all_done
+*
+* ---------------------------------------------------------
+*                   Member Functions:
+*
+* Thread_pool(int threads = hardware_concurrency)
+*   Starts the workers.
+*
+* ~Thread_pool()
+*   Waits for every submitted task to finish, then stops the workers.
+*
+* std::future<R> submit(Function &&);
+*   Schedules a call of the function with no arguments. The future holds its
+*   result, or the exception it threw.
+*
+* void parallel_for(int first, int last, Function, int grain = 0);
+*   Calls the function with each index in [first, last), in chunks of grain
+*   indices (by default, about four chunks per worker), and returns when every
+*   call has finished. A worker that calls it runs chunks itself while it
+*   waits, so parallel loops may be nested. Rethrows the first exception a
+*   call threw.
+*
+* void wait();
+*   Blocks until every submitted task has finished. Must not be called from a task.
+*
+* int size() const;
+*   Returns the number of workers.
+*
+* ---------------------------------------------------------
+*                   Instrumentation (DS_ENABLE_STATS, see Ds_stats.h):
+*
+* Thread_pool_stats stats() const
+*   Returns a snapshot of the tasks submitted by workers and from outside the pool,
+*   and, summed over the workers, where they found their tasks (own deque, injection
+*   batches, steals), the searches that found nothing, and the times they went to
+*   sleep. Each worker counts on its own cache lines. Many steals relative to own
+*   tasks mean the work is not being split where it is submitted.
+*/
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "ece250.h"
+#include "Exception.h"
+#include "Cache_aligned.h"
+#include "Chase_lev_deque.h"
+#include "Dynamic_queue.h"
+#include "Thread_random.h"
+#include "Ds_stats.h"
+
+class Thread_pool;
+
+#ifdef DS_ENABLE_STATS
+// A snapshot of the counters of a Thread_pool (see Ds_stats.h)
+struct Thread_pool_stats {
+	int workers;
+	Ds_counter worker_submissions;		// Tasks pushed onto a worker's own deque
+	Ds_counter external_submissions;	// Tasks put in the injection queue
+	Ds_counter own_tasks;				// Tasks a worker popped from its own deque
+	Ds_counter injected_batches;		// Batches taken from the injection queue
+	Ds_counter steals;					// Tasks taken from another worker's deque
+	Ds_counter failed_searches;			// Searches for a task that found none
+	Ds_counter sleeps;					// Times a worker waited for work
+
+	Thread_pool_stats() :
+	workers(0) {
+		// Empty constructor
+	}
+};
+#endif
+
+struct Thread_pool_task {
+	std::function<void()> function;
+
+	explicit Thread_pool_task(std::function<void()> f) :
+	function(std::move(f)) {
+		// Empty constructor
+	}
+};
+
+// The pool a thread works for, if any, and its index among the workers
+struct Thread_pool_identity {
+	Thread_pool const *pool;
+	int index;
+};
+
+struct alignas(64) Thread_pool_worker : Cache_aligned {
+	Chase_lev_deque<Thread_pool_task *> tasks;
+	std::thread thread;
+#ifdef DS_ENABLE_STATS
+	Thread_pool_stats statistics;	// Only the worker's own thread updates these
+#endif
+};
+
+class Thread_pool {
+private:
+	// The most tasks a worker takes from the injection queue at a time
+	static int const INJECTION_BATCH = 32;
+
+	// The number of chunks parallel_for splits a range into per worker, by default
+	static int const CHUNKS_PER_WORKER = 4;
+
+	Thread_pool_worker *workers;
+	int worker_count;
+
+	Dynamic_queue<Thread_pool_task *> injected;
+	std::atomic<int> injected_count;
+
+	std::atomic<int> queued_tasks;
+	std::atomic<int> pending_tasks;
+	std::atomic<int> idle_workers;
+	bool stopping;
+
+	std::mutex lock;
+	std::condition_variable work_available;
+	std::condition_variable all_done;
+#ifdef DS_ENABLE_STATS
+	Thread_pool_stats statistics;
+#endif
+
+	// Do not implement these functions!
+	// The workers hold pointers to the pool, so it can be neither copied nor assigned
+	Thread_pool(Thread_pool const &);
+	Thread_pool &operator=(Thread_pool const &);
+
+	static Thread_pool_identity &identity();
+
+	int current_worker() const;
+
+	void schedule(Thread_pool_task *);
+	bool find_task(int, Thread_pool_task *&);
+	bool take_injected(int, Thread_pool_task *&);
+	void run(Thread_pool_task *);
+	void worker_loop(int);
+
+public:
+	Thread_pool(int = std::thread::hardware_concurrency());
+	~Thread_pool();
+
+	int size() const;
+#ifdef DS_ENABLE_STATS
+	Thread_pool_stats stats() const;
+#endif
+
+	template <typename Function>
+	std::future<typename std::result_of<Function()>::type> submit(Function &&);
+
+	template <typename Function>
+	void parallel_for(int, int, Function, int = 0);
+
+	void wait();
+};
+
+inline Thread_pool::Thread_pool(int threads) :
+workers(nullptr),
+worker_count(std::max(threads, 1)),
+injected(INJECTION_BATCH * 4),
+injected_count(0),
+queued_tasks(0),
+pending_tasks(0),
+idle_workers(0),
+stopping(false) {
+	workers = new Thread_pool_worker[worker_count];
+
+	for (int i = 0; i < worker_count; ++i) {
+		workers[i].thread = std::thread(&Thread_pool::worker_loop, this, i);
+	}
+}
+
+// Destructor: lets the submitted tasks finish, then wakes every worker to exit
+inline Thread_pool::~Thread_pool() {
+	wait();
+
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		stopping = true;
+	}
+	work_available.notify_all();
+
+	for (int i = 0; i < worker_count; ++i) {
+		workers[i].thread.join();
+	}
+
+	delete[] workers;
+}
+
+inline int Thread_pool::size() const {
+	return worker_count;
+}
+
+#ifdef DS_ENABLE_STATS
+// Returns the submission counters together with the sums of the workers' counters
+inline Thread_pool_stats Thread_pool::stats() const {
+	Thread_pool_stats snapshot = statistics;
+	snapshot.workers = worker_count;
+
+	for (int i = 0; i < worker_count; ++i) {
+		Thread_pool_stats const &worker = workers[i].statistics;
+		snapshot.own_tasks.add(worker.own_tasks);
+		snapshot.injected_batches.add(worker.injected_batches);
+		snapshot.steals.add(worker.steals);
+		snapshot.failed_searches.add(worker.failed_searches);
+		snapshot.sleeps.add(worker.sleeps);
+	}
+	return snapshot;
+}
+#endif
+
+// Returns the calling thread's identity, set by worker_loop for worker threads
+inline Thread_pool_identity &Thread_pool::identity() {
+	static thread_local Thread_pool_identity id = { nullptr, -1 };
+	return id;
+}
+
+// Returns the index of the calling thread among the workers, or -1 if it is not one of them
+inline int Thread_pool::current_worker() const {
+	Thread_pool_identity const &id = identity();
+	return (id.pool == this) ? id.index : -1;
+}
+
+// Queues a task: onto the calling worker's own deque, or the injection queue if
+// the caller is not a worker of this pool, then wakes a worker if any is asleep
+inline void Thread_pool::schedule(Thread_pool_task *task) {
+	pending_tasks.fetch_add(1);
+
+	int index = current_worker();
+	if (index >= 0) {
+		workers[index].tasks.push_back(task);
+		DS_STATS(statistics.worker_submissions.add();)
+	}
+	else {
+		std::lock_guard<std::mutex> guard(lock);
+		injected.enqueue(task);
+		injected_count.fetch_add(1);
+		DS_STATS(statistics.external_submissions.add();)
+	}
+
+	// A worker going to sleep counts itself idle before it checks queued_tasks,
+	// and this thread counts the task before it checks idle_workers, so one of
+	// the two always sees the other
+	queued_tasks.fetch_add(1);
+	if (idle_workers.load() > 0) {
+		std::lock_guard<std::mutex> guard(lock);
+		work_available.notify_one();
+	}
+}
+
+// Moves up to INJECTION_BATCH tasks from the injection queue: the first into
+// task, and the rest onto the back of the worker's deque
+inline bool Thread_pool::take_injected(int index, Thread_pool_task *&task) {
+	if (injected_count.load(std::memory_order_relaxed) == 0)
+		return false;
+
+	Thread_pool_task *batch[INJECTION_BATCH];
+	int n;
+
+	{
+		std::lock_guard<std::mutex> guard(lock);
+		n = injected.dequeue_into(batch, INJECTION_BATCH);
+		injected_count.fetch_sub(n);
+	}
+
+	if (n == 0)
+		return false;
+
+	for (int i = 1; i < n; ++i) {
+		workers[index].tasks.push_back(batch[i]);
+	}
+
+	DS_STATS(workers[index].statistics.injected_batches.add();)
+	task = batch[0];
+	return true;
+}
+
+// Finds a task for the worker: from its own deque, then the injection queue,
+// then by stealing from the other workers, starting with a random one
+inline bool Thread_pool::find_task(int index, Thread_pool_task *&task) {
+	bool found = workers[index].tasks.pop_back(task);
+	DS_STATS(if (found) workers[index].statistics.own_tasks.add();)
+
+	if (!found)
+		found = take_injected(index, task);
+
+	if (!found) {
+		int start = static_cast<int>(thread_random() % static_cast<unsigned>(worker_count));
+
+		for (int i = 0; i < worker_count && !found; ++i) {
+			int victim = (start + i) % worker_count;
+			if (victim != index)
+				found = workers[victim].tasks.pop_front(task);
+		}
+		DS_STATS(if (found) workers[index].statistics.steals.add(); else workers[index].statistics.failed_searches.add();)
+	}
+
+	if (found)
+		queued_tasks.fetch_sub(1);
+	return found;
+}
+
+// Runs a task and frees it; the last task to finish wakes the threads in wait()
+inline void Thread_pool::run(Thread_pool_task *task) {
+	task->function();
+	delete task;
+
+	if (pending_tasks.fetch_sub(1) == 1) {
+		std::lock_guard<std::mutex> guard(lock);
+		all_done.notify_all();
+	}
+}
+
+inline void Thread_pool::worker_loop(int index) {
+	identity().pool = this;
+	identity().index = index;
+
+	Thread_pool_task *task;
+
+	while (true) {
+		if (find_task(index, task)) {
+			run(task);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> guard(lock);
+		DS_STATS(workers[index].statistics.sleeps.add();)
+		idle_workers.fetch_add(1);
+		work_available.wait(guard, [this]() { return stopping || queued_tasks.load() > 0; });
+		idle_workers.fetch_sub(1);
+
+		if (stopping)
+			return;
+	}
+}
+
+template <typename Function>
+std::future<typename std::result_of<Function()>::type> Thread_pool::submit(Function &&f) {
+	typedef typename std::result_of<Function()>::type result_type;
+
+	// std::function must be copyable, so the packaged task is shared with it
+	std::shared_ptr<std::packaged_task<result_type()> > task = std::make_shared<std::packaged_task<result_type()> >(std::forward<Function>(f));
+	std::future<result_type> result = task->get_future();
+
+	schedule(new Thread_pool_task([task]() { (*task)(); }));
+	return result;
+}
+
+// The chunks of one parallel_for, which outlives them on the caller's stack
+struct Thread_pool_loop {
+	std::atomic<int> remaining;
+	std::exception_ptr error;
+	std::mutex lock;
+	std::condition_variable finished;
+};
+
+template <typename Function>
+void Thread_pool::parallel_for(int first, int last, Function f, int grain) {
+	if (first >= last)
+		return;
+
+	if (grain <= 0)
+		grain = std::max((last - first) / (worker_count * CHUNKS_PER_WORKER), 1);
+
+	int chunks = (last - first - 1) / grain + 1;
+
+	Thread_pool_loop loop;
+	loop.remaining.store(chunks);
+
+	for (int lo = first; lo < last; lo += std::min(grain, last - lo)) {
+		int hi = lo + std::min(grain, last - lo);
+
+		schedule(new Thread_pool_task([&loop, &f, lo, hi]() {
+			try {
+				for (int i = lo; i < hi; ++i) {
+					f(i);
+				}
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> guard(loop.lock);
+				if (!loop.error)
+					loop.error = std::current_exception();
+			}
+
+			std::lock_guard<std::mutex> guard(loop.lock);
+			if (loop.remaining.fetch_sub(1) == 1)
+				loop.finished.notify_all();
+		}));
+	}
+
+	int index = current_worker();
+
+	if (index >= 0) {
+		// A worker runs tasks, most likely its own chunks, until the loop is done
+		Thread_pool_task *task;
+
+		while (loop.remaining.load() > 0) {
+			if (find_task(index, task))
+				run(task);
+			else
+				std::this_thread::yield();
+		}
+	}
+
+	// Waiting on the lock also makes sure the last chunk has let go of it
+	std::unique_lock<std::mutex> guard(loop.lock);
+	loop.finished.wait(guard, [&loop]() { return loop.remaining.load() == 0; });
+
+	if (loop.error)
+		std::rethrow_exception(loop.error);
+}
+
+// Blocks until every submitted task, including those submitted by tasks, has finished
+inline void Thread_pool::wait() {
+	std::unique_lock<std::mutex> guard(lock);
+	all_done.wait(guard, [this]() { return pending_tasks.load() == 0; });
+}
+
+#endif
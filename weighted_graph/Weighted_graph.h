@@ -13,10 +13,6 @@
 #ifndef WEIGHTED_GRAPH_H
 #define WEIGHTED_GRAPH_H
 
-#ifndef nullptr
-#define nullptr 0
-#endif
-
 #include <iostream>
 #include <limits>
 #include <vector>
@@ -26,6 +22,7 @@
 #include "Disjoint_sets.h"
 #include "Binary_search_tree.h"
 #include "Binary_search_node.h"
+#include "Ds_stats.h"
 #include <stack>
 
 using namespace Data_structures;
@@ -77,6 +74,27 @@ v1(i),
 v2(j),
 weight(d) {}
 
+#ifdef DS_ENABLE_STATS
+// A snapshot of the counters of a Weighted_graph (see Ds_stats.h)
+struct Weighted_graph_stats {
+	int vertices;
+	int edges;
+	long long edge_insertions;
+	long long edge_erasures;
+	long long mst_runs;					// Calls of minimum_spanning_tree
+	long long mst_edges_tested;			// Edges tested, over every run
+	int last_mst_edges_tested;			// Edges tested by the most recent run
+	Ds_latency_histogram insert_edge_latency;	// Sampled
+	Ds_latency_histogram mst_latency;			// Every run is timed
+
+	Weighted_graph_stats() :
+	vertices(0), edges(0), edge_insertions(0), edge_erasures(0),
+	mst_runs(0), mst_edges_tested(0), last_mst_edges_tested(0), mst_latency(1) {
+		// Empty constructor
+	}
+};
+#endif
+
 class Weighted_graph {
 private:
 	static const double INF;
@@ -107,6 +125,10 @@ private:
 		*    A binary search tree of pointers to edges. Holds all of the edges within the graph.
 		*    Automatically sorting them due to the nature of a binary search tree.
 		*
+		*  Weighted_graph_stats statistics
+		*    The event counters, only with DS_ENABLE_STATS defined.
+		*    stats() returns a snapshot of them.
+		*
 
 	*--------------------------------------------------------*/
 
@@ -115,6 +137,9 @@ private:
 	int edge_counter;
 	Edge* **edges;
 	Binary_search_tree<Edge*> tree;
+#ifdef DS_ENABLE_STATS
+	Weighted_graph_stats statistics;
+#endif
 
 public:
 	Weighted_graph(int = 10);
@@ -122,6 +147,9 @@ public:
 
 	int degree(int) const;
 	int edge_count() const;
+#ifdef DS_ENABLE_STATS
+	Weighted_graph_stats stats() const;
+#endif
 
 	bool insert_edge(int, int, double);
 	bool erase_edge(int, int);
@@ -137,7 +165,8 @@ public:
 const double Weighted_graph::INF = std::numeric_limits<double>::infinity();
 
 
-Weighted_graph::Weighted_graph(int n) {
+Weighted_graph::Weighted_graph(int n) :
+edge_counter(0) {
 
 	edges = new Edge* *[n];
 	for (int i = 0; i < n; ++i){
@@ -193,6 +222,16 @@ int Weighted_graph::edge_count() const{
 	return edge_counter;
 }
 
+#ifdef DS_ENABLE_STATS
+// Returns the event counters together with the current size of the graph
+Weighted_graph_stats Weighted_graph::stats() const{
+	Weighted_graph_stats snapshot = statistics;
+	snapshot.vertices = N;
+	snapshot.edges = edge_counter;
+	return snapshot;
+}
+#endif
+
 		/*---------------------------------------------------------
 		*					Member Functions(Mutators) :
 		*
@@ -220,6 +259,7 @@ int Weighted_graph::edge_count() const{
 		*---------------------------------------------------------*/
 
 bool Weighted_graph::insert_edge(int i, int j, double d) {
+	DS_STATS(Ds_latency_timer timer(statistics.insert_edge_latency);)
 	// If the arguments are outside of their applicable ranges,
 	// throw illegal argument exceptipon
 	if (i < 0 || i > N - 1 || j < 0 || j > N - 1 || d < 0){
@@ -252,6 +292,7 @@ bool Weighted_graph::insert_edge(int i, int j, double d) {
 	tree.insert(e);
 
 	edge_counter++;
+	DS_STATS(statistics.edge_insertions++;)
 	return true;
 
 }
@@ -283,6 +324,7 @@ bool Weighted_graph::erase_edge(int i, int j){
 	edges[i][j] = nullptr;
 
 	edge_counter--;
+	DS_STATS(statistics.edge_erasures++;)
 	return true;
 
 }
@@ -311,6 +353,7 @@ void Weighted_graph::inorder(Binary_search_node<Edge*> *e) {
 // Recall: we stop at |V|-1 edges, or when none are left; whichever comes first.
 // If |V|-1, we have a minimum spanning tree. if N, we have a forest of minimum spanning trees
 std::pair<double, int> Weighted_graph::minimum_spanning_tree() {
+	DS_STATS(Ds_latency_timer timer(statistics.mst_latency);)
 	Disjoint_sets *set = new Disjoint_sets(N);
 	int edges_tested = 0;
 	Binary_search_node<Edge*> *e = tree.root();
@@ -340,6 +383,7 @@ std::pair<double, int> Weighted_graph::minimum_spanning_tree() {
 
 			// If there is only one disjoint set, we have a minimum spanning tree; we are done.
 			if (set->disjoint_sets() == 1){
+				DS_STATS(statistics.mst_runs++; statistics.mst_edges_tested += edges_tested; statistics.last_mst_edges_tested = edges_tested;)
 				double return_weight = set->get_weight();
 				delete set;
 				return(std::make_pair(return_weight, edges_tested));
@@ -349,6 +393,7 @@ std::pair<double, int> Weighted_graph::minimum_spanning_tree() {
 		}
 	}
 	
+	DS_STATS(statistics.mst_runs++; statistics.mst_edges_tested += edges_tested; statistics.last_mst_edges_tested = edges_tested;)
 	double return_weight = set->get_weight();
 	delete set;
 	return(std::make_pair(return_weight, edges_tested));